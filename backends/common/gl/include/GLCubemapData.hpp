@@ -1,12 +1,39 @@
 #pragma once
 
 #include "Utilities/MiscUtils.hpp"
+#include "Graphics/Textures/MipChain.hpp"
+#include "Graphics/Textures/CookedTexture.hpp"
 
 #include "GLHeaders.hpp"
 
+#include <vector>
+#include <memory>
+#include <atomic>
+
 namespace Cacao {
+	//A cubemap face waiting to be uploaded
+	struct CubemapFace {
+		glm::ivec2 size;
+		int channels;
+		bool srgb;
+
+		//Either a cooked texture (with its whole mip chain) or a decoded image (with a mip chain if one is wanted)
+		std::shared_ptr<CookedTexture> cooked;
+		std::shared_ptr<unsigned char> pixels;//RGB, freed with stbi_image_free
+		std::vector<MipLevel> mips;
+	};
+
 	//Struct for data required for an OpenGL (ES) cubemap
 	struct Cubemap::CubemapData {
 		GLuint gpuID;
+
+		//Whether to generate and use a mip chain
+		bool mipmapped;
+
+		//Faces loaded ahead of upload (empty once uploaded)
+		std::vector<CubemapFace> faces;
+
+		//Bytes of decoded faces held, and of the faces on the GPU (read from any thread)
+		std::atomic<std::size_t> cpuBytes {0}, gpuBytes {0};
 	};
 }
\ No newline at end of file
@@ -14,6 +14,5 @@ namespace Cacao {
 	};
 
 	UniformTypeCheckResponse CheckUniformType(spirv_cross::TypeID type);
-	void Handle64BitTypes(GLint uniformLocation, ShaderUploadItem& item, ShaderItemInfo& info, int dims);
 	void ConfigureSPIRV(spirv_cross::CompilerGLSL::Options* opts);
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "GLHeaders.hpp"
+#include "Graphics/Textures/Texture.hpp"
+#include "UI/UIView.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace Cacao {
+	//Struct for data required for an OpenGL (ES) material
+	struct Material::MaterialData {
+		//Guards the block, its version and the textures, as parameters can be set from any thread while frames are captured
+		std::mutex mtx;
+
+		//CPU copy of the ShaderData block and how many times it has been changed
+		std::vector<unsigned char> block;
+		uint64_t version;
+
+		std::vector<MaterialTexture> textures;
+
+		//GPU copy of the block (zero until first bound) and the version of the block it holds (render thread only)
+		GLuint ubo;
+		uint64_t uploadedVersion;
+	};
+}
@@ -4,9 +4,45 @@
 
 #include "Utilities/MiscUtils.hpp"
 
+#include <vector>
+#include <cstdint>
+#include <atomic>
+
 namespace Cacao {
+	//GPU layout of VertexFormat::Packed
+	struct PackedVertex {
+		glm::vec3 position;
+		uint32_t texCoords;//Two half floats
+		uint32_t normal;   //Signed normalized 10:10:10:2 (fourth component unused)
+		uint32_t tangent;  //Signed normalized 10:10:10:2 (fourth component is the bitangent sign)
+	};
+
+	//GPU layout of VertexFormat::Quantized
+	struct QuantizedVertex {
+		int16_t position[4];//Signed normalized, scaled to the mesh bounds (fourth component is padding)
+		uint32_t texCoords, normal, tangent;
+	};
+
 	//Struct for data required for an OpenGL (ES) mesh
 	struct Mesh::MeshData {
 		GLuint vao, vbo, ibo;
+
+		//Vertices packed for the GPU if the format isn't VertexFormat::Full (dropped once uploaded)
+		std::vector<unsigned char> packed;
+
+		//Size of the vertex buffer
+		std::size_t vertexBytes;
+
+		//Indices narrowed to 16 bits while compiling if every vertex can be indexed that way (dropped once uploaded)
+		std::vector<uint16_t> shortIndices;
+
+		//Type of the indices in the index buffer
+		GLenum indexType;
+
+		//Size of both buffers together, zero while not compiled (read from any thread)
+		std::atomic<std::size_t> gpuBytes {0};
+
+		//Byte offset into the instance buffer the instance attributes currently point at
+		std::size_t instanceOffset;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "GLHeaders.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+namespace Cacao {
+	//Where a member of the ShaderData block lives
+	struct BlockMember {
+		std::size_t offset, matrixStride;
+	};
+
+	//Layout of the ShaderData block, as laid out in the SPIR-V
+	struct ShaderBlockLayout {
+		std::map<std::string, BlockMember> members;
+		std::size_t size = 0;
+
+		//Names the block is declared with in the generated GLSL (HLSL push constants don't come out as "ShaderData", and stages may disagree)
+		std::vector<std::string> names;
+	};
+
+	//GLSL generated from a shader's SPIR-V, plus what was learned about the shader along the way
+	struct GeneratedShader {
+		std::string vertexCode, fragmentCode;
+		bool instanced = false;
+		ShaderBlockLayout block;
+	};
+
+	//The shader cache saves shader work to disk (in EngineConfig::shaderCacheDir) in two levels:
+	//Level one keeps the GLSL generated from SPIR-V so that SPIRV-Cross can be skipped
+	//Level two keeps linked program binaries so that compiling and linking can be skipped
+	//Entries are keyed by a hash of the SPIR-V and backend (and the driver, for level two), so old entries are never hit, just left behind
+	//Failing to read or write the cache is never an error, the work is just done again
+
+	//Get the cache key of a shader from its SPIR-V
+	uint64_t HashShaderSource(const std::vector<uint32_t>& vertex, const std::vector<uint32_t>& fragment);
+
+	//Look up generated GLSL in the cache, returning whether it was found
+	bool LoadCachedGLSL(uint64_t key, GeneratedShader& out);
+
+	//Save generated GLSL to the cache
+	void StoreCachedGLSL(uint64_t key, const GeneratedShader& shader);
+
+	//Create a program from a cached binary (render thread only)
+	//Returns zero if there isn't one or the driver rejects it
+	GLuint LoadCachedProgram(uint64_t key);
+
+	//Save a linked program's binary to the cache (render thread only)
+	//The program should have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+	void StoreCachedProgram(uint64_t key, GLuint program);
+}
@@ -3,13 +3,85 @@
 #include "GLHeaders.hpp"
 
 #include <string>
+#include <vector>
+#include <any>
+#include <typeinfo>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
 
 namespace Cacao {
+	//C++ type expected for a shader value and how to copy it into a uniform block
+	struct ParameterType {
+		const std::type_info* cppType;
+		const void* (*extract)(const std::any& value);//Get a pointer to the value in an any (nullptr if it holds another type)
+		std::size_t scalarSize;						  //Bytes per component of the C++ value
+		unsigned int rows, columns;
+	};
+
+	//A shader spec entry resolved against the shader
+	struct UniformSlot {
+		std::string name;
+		SpvType type;
+		int dims;
+
+		//Textures are bound to a fixed slot (-1 if not a texture)
+		int textureSlot;
+
+		//Everything else lives in the ShaderData uniform block
+		const ParameterType* paramType;
+		std::size_t offset, matrixStride;
+
+		//Why the entry can't be uploaded to (empty if it can)
+		std::string error;
+		unsigned int errorCode;
+	};
+
+	//Copy a value into its place in a uniform block
+	inline void WriteBlockValue(unsigned char* block, const UniformSlot& slot, const void* value) {
+		const ParameterType& pt = *slot.paramType;
+
+		//std140 booleans are four bytes
+		if(*pt.cppType == typeid(bool)) {
+			uint32_t b = *static_cast<const bool*>(value);
+			std::memcpy(block + slot.offset, &b, sizeof(b));
+			return;
+		}
+
+		//Columns are padded in the block but packed in the value
+		std::size_t columnSize = pt.rows * pt.scalarSize;
+		for(unsigned int col = 0; col < pt.columns; col++) {
+			std::memcpy(block + slot.offset + (col * slot.matrixStride), static_cast<const unsigned char*>(value) + (col * columnSize), columnSize);
+		}
+	}
+
 	//Struct for data required for an OpenGL (ES) shader
 	struct Shader::ShaderData {
 		GLuint gpuID, localsUBO;
 		std::string vertexCode, fragmentCode;
 
-		static GLuint uboIndexCounter;
+		//Shader cache key of the SPIR-V this was generated from
+		uint64_t cacheKey;
+
+		//Whether a compile has been started but not finished
+		std::atomic<bool> compiling {false};
+
+		//Whether the vertex shader takes its transform from the instance buffer
+		bool instanced;
+
+		//Whether the shader has a CacaoLocals block
+		bool hasLocals;
+
+		//Spec entries in spec order
+		std::vector<UniformSlot> uniforms;
+
+		//Size of the ShaderData block (zero if there isn't one) and the names it is declared with in the GLSL
+		std::size_t blockSize;
+		std::vector<std::string> blockNames;
+
+		//Values uploaded with UploadData, used when drawing without a material
+		std::vector<unsigned char> block;
+		GLuint blockUBO;
+		bool blockDirty;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "GLHeaders.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace Cacao {
+	//Bind and state change counts for one pass, to see how much work the state cache saves
+	struct RenderStats {
+		unsigned int draws, instances, programBinds, vertexArrayBinds, textureBinds, uniformBufferBinds, stateChanges, skippedBinds;
+		std::size_t triangles;
+	};
+
+	//Shadows the bits of OpenGL (ES) state the scene pass changes the most so that redundant calls can be skipped
+	//Outside of a pass every call goes straight to OpenGL (ES) and releases unbind immediately, as code outside the pass doesn't go through the cache
+	//Inside of a pass releases are lazy, so that binding the same thing again right after is free, and End unbinds whatever is left
+	class GLStateCache {
+	  public:
+		//Start a pass, forgetting whatever state we thought we knew
+		void Begin() {
+			active = true;
+			program = vertexArray = activeUnit = unknown;
+			textures2D.fill(unknown);
+			texturesCube.fill(unknown);
+			uniformBuffers.fill({unknown, 0, 0});
+			depthTest = blend = depthFunc = unknown;
+			stats = {};
+		}
+
+		//End a pass, leaving nothing bound like code outside the pass expects
+		void End() {
+			if(program != 0) glUseProgram(0);
+			if(vertexArray != 0) glBindVertexArray(0);
+			for(GLuint unit = 0; unit < maxUnits; unit++) {
+				if(textures2D[unit] != 0 && textures2D[unit] != unknown) {
+					glActiveTexture(GL_TEXTURE0 + unit);
+					glBindTexture(GL_TEXTURE_2D, 0);
+				}
+				if(texturesCube[unit] != 0 && texturesCube[unit] != unknown) {
+					glActiveTexture(GL_TEXTURE0 + unit);
+					glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+				}
+			}
+			active = false;
+		}
+
+		void UseProgram(GLuint id) {
+			if(active && program == id) {
+				stats.skippedBinds++;
+				return;
+			}
+			glUseProgram(id);
+			program = id;
+			stats.programBinds++;
+		}
+
+		void ReleaseProgram() {
+			if(!active) glUseProgram(0);
+		}
+
+		void BindVertexArray(GLuint id) {
+			if(active && vertexArray == id) {
+				stats.skippedBinds++;
+				return;
+			}
+			glBindVertexArray(id);
+			vertexArray = id;
+			stats.vertexArrayBinds++;
+		}
+
+		void ReleaseVertexArray() {
+			if(!active) glBindVertexArray(0);
+		}
+
+		void BindTexture(GLuint unit, GLenum target, GLuint id) {
+			GLuint* slot = TextureSlot(unit, target);
+			if(active && slot && *slot == id) {
+				stats.skippedBinds++;
+				return;
+			}
+			ActiveTexture(unit);
+			glBindTexture(target, id);
+			if(slot) *slot = id;
+			stats.textureBinds++;
+		}
+
+		void ReleaseTexture(GLuint unit, GLenum target) {
+			if(active) return;
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(target, 0);
+		}
+
+		void BindUniformBuffer(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+			UniformBufferRange* range = (index < maxUniformBindings ? &uniformBuffers[index] : nullptr);
+			if(active && range && range->buffer == buffer && range->offset == offset && range->size == size) {
+				stats.skippedBinds++;
+				return;
+			}
+			glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+			if(range) *range = {buffer, offset, size};
+			stats.uniformBufferBinds++;
+		}
+
+		void SetCapability(GLenum cap, bool enabled) {
+			GLuint* state = (cap == GL_DEPTH_TEST ? &depthTest : (cap == GL_BLEND ? &blend : nullptr));
+			if(active && state && *state == GLuint(enabled)) return;
+			if(enabled) {
+				glEnable(cap);
+			} else {
+				glDisable(cap);
+			}
+			if(state) *state = enabled;
+			stats.stateChanges++;
+		}
+
+		void DepthFunc(GLenum func) {
+			if(active && depthFunc == func) return;
+			glDepthFunc(func);
+			depthFunc = func;
+			stats.stateChanges++;
+		}
+
+		//Counters for the current (or last) pass
+		RenderStats stats = {};
+
+	  private:
+		static constexpr GLuint unknown = ~GLuint(0);
+		static constexpr GLuint maxUnits = 32;
+		static constexpr GLuint maxUniformBindings = 8;
+
+		struct UniformBufferRange {
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;
+		};
+
+		bool active = false;
+		GLuint program = unknown, vertexArray = unknown, activeUnit = unknown;
+		std::array<GLuint, maxUnits> textures2D, texturesCube;
+		std::array<UniformBufferRange, maxUniformBindings> uniformBuffers;
+		GLuint depthTest = unknown, blend = unknown, depthFunc = unknown;
+
+		void ActiveTexture(GLuint unit) {
+			if(active && activeUnit == unit) return;
+			glActiveTexture(GL_TEXTURE0 + unit);
+			activeUnit = unit;
+		}
+
+		//Units past the ones we track and other targets just aren't cached
+		GLuint* TextureSlot(GLuint unit, GLenum target) {
+			if(unit >= maxUnits) return nullptr;
+			if(target == GL_TEXTURE_2D) return &textures2D[unit];
+			if(target == GL_TEXTURE_CUBE_MAP) return &texturesCube[unit];
+			return nullptr;
+		}
+	};
+
+	//State cache for the render thread
+	inline GLStateCache glState;
+}
@@ -1,13 +1,36 @@
 #pragma once
 
 #include "Utilities/MiscUtils.hpp"
+#include "Graphics/Textures/CookedTexture.hpp"
 
 #include "GLHeaders.hpp"
+#include "GLTextureStreamer.hpp"
+
+#include <string>
+#include <memory>
+#include <future>
+#include <atomic>
 
 namespace Cacao {
 	//Struct for data required for an OpenGL (ES) 2D texture
 	struct Texture2D::Tex2DData {
 		GLuint gpuID;
 		GLenum format;
+
+		//Where the image came from, so it can be loaded again if the texture is recompiled
+		std::string filePath;
+
+		//Decoded image or mapped cooked texture (only one is set), only kept until it is on the GPU
+		std::shared_ptr<const unsigned char> pixels;
+		std::shared_ptr<CookedTexture> cooked;
+
+		//Bytes of the decoded image held, and of the levels allocated at compile time (read from any thread)
+		std::atomic<std::size_t> cpuBytes {0}, gpuBytes {0};
+
+		//Set while the image is streaming to the GPU, and fulfilled once it's all there
+		std::shared_ptr<std::promise<void>> upload;
+
+		//Streaming state for cooked textures too big to keep whole (created once and never replaced, so detail requests can reach it from any thread)
+		std::shared_ptr<StreamedTexture> stream;
 	};
 }
\ No newline at end of file
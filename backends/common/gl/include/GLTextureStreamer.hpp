@@ -0,0 +1,58 @@
+#pragma once
+
+#include "GLHeaders.hpp"
+#include "Graphics/Textures/CookedTexture.hpp"
+
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace Cacao {
+	//A texture whose most detailed mip levels are streamed in on demand
+	struct StreamedTexture {
+		GLuint texture;
+		GLenum format;
+		std::shared_ptr<CookedTexture> source;//Every level, kept mapped so any of them can be uploaded again
+
+		//Largest on-screen size (in pixels) reported since the streamer last looked (any thread)
+		std::atomic<float> demand {0.0f};
+
+		//Bytes of levels above the floor that are resident or being uploaded (read from any thread)
+		std::atomic<std::size_t> streamedBytes {0};
+
+		//Everything below is render thread only
+		int floorLevel;			 //Levels from here down are always resident
+		int residentLevel;		 //Most detailed level uploaded (the texture's GL_TEXTURE_BASE_LEVEL)
+		int pendingLevel = -1;	 //Level being uploaded, if any
+		int wantedLevel;		 //Most detailed level the last frame asked for
+		uint64_t lastUsed = 0;	 //Streamer frame it was last drawn in
+		bool registered = false;
+	};
+
+	//The texture streamer keeps only the low mip levels of cooked textures resident until they are drawn big enough to need more
+	//Each frame it compares how large each texture was drawn to the detail it has, and uploads one more level at a time (through the texture uploader) where it falls short
+	//Levels above the always-resident floor share EngineConfig::textureMemoryBudget, and when that runs out the top levels of the least recently drawn textures are dropped
+	//All of these are render thread only, except RequestStreamedDetail
+
+	//Pick the level a texture always keeps resident
+	int GetStreamingFloor(const CookedTexture& source);
+
+	//Start streaming a texture whose levels from its floor down are uploaded
+	void RegisterStreamedTexture(std::shared_ptr<StreamedTexture> texture);
+
+	//Stop streaming a texture (before deleting it), cancelling its uploads
+	void UnregisterStreamedTexture(const std::shared_ptr<StreamedTexture>& texture);
+
+	//Note how many pixels across a texture is drawn this frame
+	inline void RequestStreamedDetail(StreamedTexture& texture, float screenSize) {
+		float current = texture.demand.load(std::memory_order_relaxed);
+		while(screenSize > current && !texture.demand.compare_exchange_weak(current, screenSize, std::memory_order_relaxed)) {}
+	}
+
+	//Act on the demand reported for the frame about to be drawn (called once per frame, outside of the scene pass)
+	void PumpTextureStreaming();
+
+	//Forget every streamed texture
+	void ShutdownTextureStreaming();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "GLHeaders.hpp"
+
+#include "glm/vec2.hpp"
+
+#include <memory>
+#include <functional>
+#include <cstddef>
+
+namespace Cacao {
+	//One level (or cubemap face) of a texture to stream to the GPU
+	struct TextureUpload {
+		GLuint texture;
+		GLenum target;//What the texture binds to
+		GLenum image; //What to upload to (the same as target except for cubemap faces)
+		GLint level;
+		glm::ivec2 size;
+		GLenum format, type;
+		std::size_t pixelSize;//Bytes per pixel, with rows tightly packed
+		std::shared_ptr<const unsigned char> pixels;
+	};
+
+	//The texture uploader streams pixels to the GPU through a ring of pixel unpack buffers
+	//Each render loop it maps free buffers (up to EngineConfig::textureUploadBudget bytes), has the thread pool fill them,
+	//copies the filled ones into their textures, and fences the copies so buffers are only reused once the GPU is done with them
+	//Uploads bigger than the budget or a buffer are split by rows and spread across render loops
+	//All of these are render thread only
+
+	//Queue an upload, with a function to run (on the render thread, and which must not throw) once the GPU has all of it
+	//The uploader keeps its reference to the pixels until then, and the texture must already have storage for the level
+	void QueueTextureUpload(TextureUpload upload, std::function<void()> onDone);
+
+	//Drop queued and in-flight uploads to a texture, without running their completion functions
+	//Must be called before deleting a texture that may still be uploading
+	void CancelTextureUploads(GLuint texture);
+
+	//Move uploads along (called once per render loop)
+	void PumpTextureUploads();
+
+	//Finish every upload and free the ring
+	void ShutdownTextureUploads();
+}
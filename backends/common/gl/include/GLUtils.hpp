@@ -16,6 +16,19 @@ namespace Cacao {
 		return glJob.status->get_future().share();
 	}
 
+	//Check on render thread work that is waiting for the driver once per render loop, until the check returns true
+	//Only callable on the render thread, and checks must not throw
+	void AddGLPoll(std::function<bool()> poll);
+
+	//Whether the driver compiles and links shaders in the background, letting us check for completion without waiting
+	inline bool HasParallelShaderCompile() {
+#ifdef ES
+		return GLAD_GL_KHR_parallel_shader_compile;
+#else
+		return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+#endif
+	}
+
 	struct RawGLTexture {
 		GLuint texObj;
 		int* slot;
@@ -23,6 +36,15 @@ namespace Cacao {
 
 	inline GLuint globalsUBO = 37;
 
+	//Uniform buffer binding points for CacaoGlobals, CacaoLocals, and ShaderData
+	constexpr GLuint globalsBinding = 0, localsBinding = 1, shaderDataBinding = 2;
+
+	//Per-instance transforms for instanced draws, laid out as the frame's RenderObjects
+	inline GLuint instanceVBO = 0;
+
+	//First vertex attribute location of the per-instance transform (a mat4 takes up four)
+	constexpr GLuint instanceTransformLocation = 5;
+
 	inline GLenum GetTextureMemoryFormat(GLenum internalFormat) {
 		switch(internalFormat) {
 			case GL_RED: return GL_RED;
@@ -6,6 +6,10 @@
 #include "Core/Exception.hpp"
 #include "GLCubemapData.hpp"
 #include "GLUtils.hpp"
+#include "GLStateCache.hpp"
+#include "Utilities/ParallelFor.hpp"
+#include "Utilities/VFS.hpp"
+#include "Graphics/Textures/CookedTexture.hpp"
 
 #include "stb_image.h"
 
@@ -13,23 +17,86 @@
 
 #include <future>
 #include <filesystem>
+#include <climits>
 
 namespace Cacao {
-	Cubemap::Cubemap(std::vector<std::string> filePaths)
+	//Load every face of a cubemap (mapping cooked textures and decoding the rest), spread across the thread pool
+	static std::vector<CubemapFace> LoadFaces(const std::vector<std::string>& paths, bool mipmapped) {
+		std::vector<CubemapFace> faces(paths.size());
+		ParallelFor(
+			paths.size(), [&paths, &faces, mipmapped](std::size_t start, std::size_t end) {
+				//Flip each face (because OpenGL), setting it for this thread only as other threads may be decoding other images
+				stbi_set_flip_vertically_on_load_thread(true);
+
+				for(std::size_t i = start; i < end; i++) {
+					CubemapFace& face = faces[i];
+					face.cooked = CookedTexture::Find(paths[i]);
+					if(face.cooked) {
+						face.size = face.cooked->GetSize();
+						face.channels = face.cooked->GetChannels();
+						face.srgb = face.cooked->IsSRGB();
+						continue;
+					}
+
+					int numChannels;
+					face.channels = 3;
+					face.srgb = true;
+					std::shared_ptr<MappedFile> file = VFS::GetInstance()->Open(paths[i]);
+					CheckException(file->GetSize() <= INT_MAX, Exception::GetExceptionCodeFromMeaning("IO"), "Cubemap face image file is too large to load!")
+					face.pixels.reset(stbi_load_from_memory(file->GetData(), int(file->GetSize()), &face.size.x, &face.size.y, &numChannels, 3), stbi_image_free);
+					CheckException(face.pixels, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to open cubemap face image file!")
+					if(mipmapped) face.mips = GenerateMipChain(face.pixels.get(), face.size, 3, true);
+				}
+			},
+			1);
+
+		//Cubemaps are only complete if every face is the same square size and format
+		for(const CubemapFace& face : faces) {
+			CheckException(face.size.x == face.size.y && face.size == faces[0].size, Exception::GetExceptionCodeFromMeaning("IO"), "Cubemap faces must all be square and the same size!")
+			CheckException(face.channels >= 3 && face.channels == faces[0].channels && face.srgb == faces[0].srgb, Exception::GetExceptionCodeFromMeaning("IO"), "Cubemap faces must all be color images of the same format!")
+		}
+		return faces;
+	}
+
+	//Count the decoded pixels held by faces (cooked faces are only mapped)
+	static std::size_t GetDecodedBytes(const std::vector<CubemapFace>& faces) {
+		std::size_t bytes = 0;
+		for(const CubemapFace& face : faces) {
+			if(face.cooked) continue;
+			bytes += std::size_t(face.size.x) * face.size.y * face.channels;
+			for(const MipLevel& mip : face.mips) {
+				bytes += mip.data.size();
+			}
+		}
+		return bytes;
+	}
+
+	Cubemap::Cubemap(std::vector<std::string> filePaths, bool mipmaps)
 	  : Texture(false) {
 		//Create native data
 		nativeData.reset(new CubemapData());
+		nativeData->mipmapped = mipmaps;
 
 		for(std::string tex : filePaths) {
-			CheckException(std::filesystem::exists(tex), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot create cubemap from nonexistent file!");
+			CheckException(VFS::GetInstance()->Exists(tex), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot create cubemap from nonexistent file!");
 		}
 
 		textures = filePaths;
 		currentSlot = -1;
+
+		//Decode the faces now so that compiling only has to upload them
+		nativeData->faces = LoadFaces(textures, mipmaps);
+		nativeData->cpuBytes = GetDecodedBytes(nativeData->faces);
 	}
 
 	std::shared_future<void> Cubemap::Compile() {
 		if(std::this_thread::get_id() != Engine::GetInstance()->GetThreadID()) {
+			//Faces are dropped after uploading, so load them again here (and not on the main thread) if this cubemap was released
+			if(!compiled && nativeData->faces.empty()) {
+				nativeData->faces = LoadFaces(textures, nativeData->mipmapped);
+				nativeData->cpuBytes = GetDecodedBytes(nativeData->faces);
+			}
+
 			//Invoke OpenGL (ES) on the main thread
 			return InvokeGL([this]() {
 				this->Compile();
@@ -37,41 +104,54 @@ namespace Cacao {
 		}
 		CheckException(!compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot compile compiled cubemap!");
 
+		//Load the faces again if this cubemap was released and is being compiled straight from the main thread
+		if(nativeData->faces.empty()) {
+			nativeData->faces = LoadFaces(textures, nativeData->mipmapped);
+			nativeData->cpuBytes = GetDecodedBytes(nativeData->faces);
+		}
+
 		//Create texture object
 		glGenTextures(1, &(nativeData->gpuID));
 
 		//Bind texture object so we can work on it
 		glBindTexture(GL_TEXTURE_CUBE_MAP, nativeData->gpuID);
 
-		//Load image data into texture object
-		for(unsigned int i = 0; i < textures.size(); i++) {
-			//Define fields for image loading
-			int width, height, numChannels;
-
-			//Make sure textures are flipped
-			stbi_set_flip_vertically_on_load(true);
-
-			//Load texture data from file
-			unsigned char* data = stbi_load(textures[i].c_str(), &width, &height, &numChannels, 3);
-
-			//Make sure we have data
-			if(data) {
-				//Add image data to cubemap
-				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-
-				//Free data (we won't be needing it anymore)
-				stbi_image_free(data);
+		//Upload each face (and its mip chain)
+		//Rows of RGB data aren't always four-byte aligned
+		GLint originalUnpack;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &originalUnpack);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		std::size_t mipCount = 0, gpuBytes = 0;
+		for(unsigned int i = 0; i < nativeData->faces.size(); i++) {
+			const CubemapFace& face = nativeData->faces[i];
+			GLenum format = (face.channels == 4 ? (face.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8) : (face.srgb ? GL_SRGB8 : GL_RGB8));
+			GLenum memoryFormat = GetTextureMemoryFormat(format);
+			if(face.cooked) {
+				//Cooked faces already have their mip chain, so only the full-size level is skipped if mipmaps are off
+				const std::vector<CookedTexture::Level>& levels = face.cooked->GetLevels();
+				std::size_t levelCount = (nativeData->mipmapped ? levels.size() : 1);
+				for(unsigned int level = 0; level < levelCount; level++) {
+					glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, format, levels[level].size.x, levels[level].size.y, 0, memoryFormat, GL_UNSIGNED_BYTE, levels[level].data);
+					gpuBytes += levels[level].bytes;
+				}
+				mipCount = levelCount - 1;
 			} else {
-				//Free whatever junk we have
-				stbi_image_free(data);
-
-				CheckException(false, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to open cubemap face image file!")
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, face.size.x, face.size.y, 0, memoryFormat, GL_UNSIGNED_BYTE, face.pixels.get());
+				gpuBytes += std::size_t(face.size.x) * face.size.y * face.channels;
+				for(unsigned int level = 0; level < face.mips.size(); level++) {
+					glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level + 1, format, face.mips[level].size.x, face.mips[level].size.y, 0, memoryFormat, GL_UNSIGNED_BYTE, face.mips[level].data.data());
+					gpuBytes += face.mips[level].data.size();
+				}
+				mipCount = face.mips.size();
 			}
 		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, originalUnpack);
 
 		//Apply cubemap filtering
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, mipCount > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, mipCount);
 
 		//Configure wrapping mode
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -81,6 +161,11 @@ namespace Cacao {
 		//Unbind texture object since we're done with it for now
 		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
+		//The GPU has its own copy now
+		nativeData->faces.clear();
+		nativeData->cpuBytes = 0;
+		nativeData->gpuBytes = gpuBytes;
+
 		compiled = true;
 
 		//Return an empty future
@@ -104,9 +189,14 @@ namespace Cacao {
 		CheckException(!bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot release bound cubemap!");
 
 		glDeleteTextures(1, &(nativeData->gpuID));
+		nativeData->gpuBytes = 0;
 		compiled = false;
 	}
 
+	AssetMemoryUsage Cubemap::GetMemoryUsage() {
+		return {.cpu = nativeData->cpuBytes, .gpu = nativeData->gpuBytes};
+	}
+
 	void Cubemap::Bind(int slot) {
 		CheckException(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID(), Exception::GetExceptionCodeFromMeaning("RenderThread"), "Cannot bind cubemap in non-rendering thread!")
 		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot bind uncompiled cubemap!");
@@ -114,8 +204,7 @@ namespace Cacao {
 
 		//Bind the texture to the requested slot
 		currentSlot = slot;
-		glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, nativeData->gpuID);
+		glState.BindTexture(slot, GL_TEXTURE_CUBE_MAP, nativeData->gpuID);
 		bound = true;
 	}
 
@@ -125,8 +214,7 @@ namespace Cacao {
 		CheckException(bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot unbind unbound cubemap!");
 
 		//Unbind the texture from its current slot
-		glActiveTexture(GL_TEXTURE0 + currentSlot);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		glState.ReleaseTexture(currentSlot, GL_TEXTURE_CUBE_MAP);
 		currentSlot = -1;
 		bound = false;
 	}
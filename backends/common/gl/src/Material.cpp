@@ -0,0 +1,145 @@
+#include "Graphics/Material.hpp"
+#include "GLMaterialData.hpp"
+#include "GLShaderData.hpp"
+#include "Core/Exception.hpp"
+#include "Core/Engine.hpp"
+#include "GLUtils.hpp"
+#include "GLStateCache.hpp"
+
+#include "GLHeaders.hpp"
+
+#include <algorithm>
+
+namespace Cacao {
+	Material::Material(AssetHandle<Shader> shader)
+	  : shader(shader) {
+		CheckException(!shader.IsNull(), Exception::GetExceptionCodeFromMeaning("NullValue"), "Cannot create a material with a null shader!")
+
+		//Create native data
+		nativeData.reset(new MaterialData());
+
+		//Start from a zeroed block laid out like the shader's
+		nativeData->block.resize(shader->nativeData->blockSize);
+		nativeData->version = 1;
+		nativeData->ubo = 0;
+		nativeData->uploadedVersion = 0;
+	}
+
+	Material::~Material() {
+		if(nativeData->ubo == 0) return;
+
+		//Delete the buffer on the engine thread (without waiting on it)
+		if(std::this_thread::get_id() != Engine::GetInstance()->GetThreadID()) {
+			InvokeGL([ubo = nativeData->ubo]() {
+				glDeleteBuffers(1, &ubo);
+			});
+			return;
+		}
+		glDeleteBuffers(1, &(nativeData->ubo));
+	}
+
+	//Find a spec entry of a shader that can be set
+	static const UniformSlot& FindSlot(const std::vector<UniformSlot>& uniforms, const std::string& name) {
+		auto it = std::find_if(uniforms.begin(), uniforms.end(), [&name](const UniformSlot& slot) {
+			return slot.name == name;
+		});
+		CheckException(it != uniforms.end(), Exception::GetExceptionCodeFromMeaning("NonexistentValue"), "Can't locate targeted item in shader specification!")
+		CheckException(it->error.empty(), it->errorCode, it->error)
+		return *it;
+	}
+
+	void Material::WriteParameter(const std::string& name, const std::type_info& type, const void* value) {
+		const UniformSlot& slot = FindSlot(shader->nativeData->uniforms, name);
+		CheckException(slot.textureSlot == -1, Exception::GetExceptionCodeFromMeaning("WrongType"), "Cannot set a texture as a parameter, use SetTexture instead!")
+		CheckException(*slot.paramType->cppType == type, Exception::GetExceptionCodeFromMeaning("WrongType"), "Parameter value type does not match the type in the shader specification!")
+
+		std::lock_guard lk(nativeData->mtx);
+		WriteBlockValue(nativeData->block.data(), slot, value);
+		nativeData->version++;
+	}
+
+	//Set or replace the texture in a slot
+	static void PutTexture(std::vector<MaterialTexture>& textures, MaterialTexture tex) {
+		auto it = std::find_if(textures.begin(), textures.end(), [&tex](const MaterialTexture& mt) {
+			return mt.slot == tex.slot;
+		});
+		if(it != textures.end()) {
+			*it = tex;
+		} else {
+			textures.push_back(tex);
+		}
+	}
+
+	void Material::SetTexture(const std::string& name, std::shared_ptr<Texture> texture) {
+		CheckException(texture, Exception::GetExceptionCodeFromMeaning("NullValue"), "Cannot set a material texture to a null texture!")
+		const UniformSlot& slot = FindSlot(shader->nativeData->uniforms, name);
+		CheckException(slot.textureSlot != -1, Exception::GetExceptionCodeFromMeaning("WrongType"), "Cannot set a non-texture parameter to a texture!")
+
+		std::lock_guard lk(nativeData->mtx);
+		PutTexture(nativeData->textures, MaterialTexture {.slot = slot.textureSlot, .texture = texture, .view = nullptr});
+	}
+
+	void Material::SetTexture(const std::string& name, std::shared_ptr<UIView> view) {
+		CheckException(view, Exception::GetExceptionCodeFromMeaning("NullValue"), "Cannot set a material texture to a null UI view!")
+		const UniformSlot& slot = FindSlot(shader->nativeData->uniforms, name);
+		CheckException(slot.textureSlot != -1, Exception::GetExceptionCodeFromMeaning("WrongType"), "Cannot set a non-texture parameter to a texture!")
+
+		std::lock_guard lk(nativeData->mtx);
+		PutTexture(nativeData->textures, MaterialTexture {.slot = slot.textureSlot, .texture = nullptr, .view = view});
+	}
+
+	MaterialSnapshot Material::Capture(LinearArena& arena, std::vector<MaterialTexture>& textures) {
+		MaterialSnapshot snapshot {.material = shared_from_this(), .shader = shader.GetManagedAsset(), .firstTexture = textures.size()};
+
+		std::lock_guard lk(nativeData->mtx);
+		unsigned char* block = arena.Allocate<unsigned char>(nativeData->block.size());
+		std::copy(nativeData->block.begin(), nativeData->block.end(), block);
+		snapshot.block = std::span<const unsigned char>(block, nativeData->block.size());
+		snapshot.version = nativeData->version;
+		textures.insert(textures.end(), nativeData->textures.begin(), nativeData->textures.end());
+		snapshot.textureCount = nativeData->textures.size();
+		return snapshot;
+	}
+
+	void Material::Bind(const MaterialSnapshot& snapshot, std::span<const MaterialTexture> textures) {
+		CheckException(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID(), Exception::GetExceptionCodeFromMeaning("RenderThread"), "Cannot bind material in non-rendering thread!")
+		CheckException(snapshot.shader->IsCompiled(), Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot bind material with uncompiled shader!")
+
+		//Upload the captured block if it isn't the one already on the GPU
+		if(!snapshot.block.empty()) {
+			if(nativeData->ubo == 0) {
+				glGenBuffers(1, &(nativeData->ubo));
+				glBindBuffer(GL_UNIFORM_BUFFER, nativeData->ubo);
+				glBufferData(GL_UNIFORM_BUFFER, snapshot.block.size(), snapshot.block.data(), GL_DYNAMIC_DRAW);
+				glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			} else if(snapshot.version != nativeData->uploadedVersion) {
+				glBindBuffer(GL_UNIFORM_BUFFER, nativeData->ubo);
+				glBufferSubData(GL_UNIFORM_BUFFER, 0, snapshot.block.size(), snapshot.block.data());
+				glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			}
+			nativeData->uploadedVersion = snapshot.version;
+			glState.BindUniformBuffer(shaderDataBinding, nativeData->ubo, 0, snapshot.block.size());
+		}
+
+		//Bind textures
+		for(const MaterialTexture& tex : textures) {
+			if(tex.texture) {
+				tex.texture->Bind(tex.slot);
+			} else {
+				tex.view->Bind(tex.slot);
+			}
+		}
+	}
+
+	void Material::Unbind(std::span<const MaterialTexture> textures) {
+		CheckException(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID(), Exception::GetExceptionCodeFromMeaning("RenderThread"), "Cannot unbind material in non-rendering thread!")
+
+		for(const MaterialTexture& tex : textures) {
+			if(tex.texture) {
+				tex.texture->Unbind();
+			} else {
+				tex.view->Unbind();
+			}
+		}
+	}
+}
@@ -4,21 +4,200 @@
 #include "Core/Exception.hpp"
 #include "Core/Engine.hpp"
 #include "GLUtils.hpp"
+#include "GLStateCache.hpp"
+#include "Graphics/Rendering/RenderObjects.hpp"
+#include "Utilities/MappedFile.hpp"
 
 #include <future>
+#include <limits>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #include "GLHeaders.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "glm/gtc/packing.hpp"
+#include "glm/gtc/matrix_transform.hpp"
 
 namespace Cacao {
-	Mesh::Mesh(std::vector<Vertex> vertices, std::vector<glm::uvec3> indices)
-	  : Asset(false), vertices(vertices), indices(indices) {
+	//Triangles are uploaded as they are stored, so they have to be laid out like an index buffer
+	static_assert(sizeof(glm::uvec3) == 3 * sizeof(unsigned int), "Triangles must be three tightly packed indices!");
+
+	//Whether every vertex of a mesh can be indexed with 16-bit indices
+	static bool FitsShortIndices(std::size_t vertexCount) {
+		return vertexCount <= 65536;
+	}
+
+	//Narrow triangles to 16-bit indices, which halves the index buffer
+	static void NarrowIndices(std::span<const glm::uvec3> indices, std::vector<uint16_t>& out) {
+		out.resize(indices.size() * 3);
+		for(std::size_t i = 0; i < indices.size(); i++) {
+			out[i * 3] = uint16_t(indices[i].x);
+			out[(i * 3) + 1] = uint16_t(indices[i].y);
+			out[(i * 3) + 2] = uint16_t(indices[i].z);
+		}
+	}
+
+	//Totals for GetMemoryReport
+	static std::atomic<std::size_t> compiledMeshes = 0, compiledVertices = 0, fullVertexBytes = 0, actualVertexBytes = 0;
+
+	Mesh::Mesh(std::vector<Vertex> vertices, std::vector<glm::uvec3> indices, VertexFormat format)
+	  : Asset(false), vertices(std::move(vertices)), indices(std::move(indices)), format(VertexFormat::Full), positionTransform(1.0f) {
+		vertexData = this->vertices;
+		indexData = this->indices;
+
+		//Find bounds
+		if(vertexData.empty()) {
+			bounds = {glm::vec3(0.0f), glm::vec3(0.0f)};
+		} else {
+			bounds = {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest())};
+			for(const Vertex& vertex : vertexData) {
+				bounds.min = glm::min(bounds.min, vertex.position);
+				bounds.max = glm::max(bounds.max, vertex.position);
+			}
+		}
+
 		//Create native data
 		nativeData.reset(new MeshData());
+
+		if(format != VertexFormat::Full) SetVertexFormat(format);
+	}
+
+	Mesh::Mesh(std::shared_ptr<MappedFile> file, std::span<const Vertex> vertices, std::span<const glm::uvec3> indices, BoundingBox bounds)
+	  : Asset(false), mapping(file), vertexData(vertices), indexData(indices), bounds(bounds), format(VertexFormat::Full), positionTransform(1.0f) {
+		//Create native data
+		nativeData.reset(new MeshData());
+	}
+
+	//Pack a normal or tangent, with an extra sign in the spare bits
+	static uint32_t PackDirection(glm::vec3 dir, float sign = 0.0f) {
+		return glm::packSnorm3x10_1x2(glm::vec4(dir, sign));
+	}
+
+	//Pack the parts of a vertex shared by both packed formats
+	template<typename T>
+	static void PackAttributes(T& packed, const Vertex& vertex) {
+		//Only the bitangent's direction relative to the tangent and normal is kept
+		float bitangentSign = (glm::dot(glm::cross(vertex.normal, vertex.tangent), vertex.bitangent) < 0.0f ? -1.0f : 1.0f);
+		packed.texCoords = glm::packHalf2x16(vertex.texCoords);
+		packed.normal = PackDirection(vertex.normal);
+		packed.tangent = PackDirection(vertex.tangent, bitangentSign);
+	}
+
+	//Pack vertices in a format, returning the transform that undoes any quantization
+	static glm::mat4 PackVertices(std::span<const Vertex> vertices, const BoundingBox& bounds, VertexFormat format, std::vector<unsigned char>& out) {
+		if(format == VertexFormat::Packed) {
+			out.resize(vertices.size() * sizeof(PackedVertex));
+			PackedVertex* packed = reinterpret_cast<PackedVertex*>(out.data());
+			for(std::size_t i = 0; i < vertices.size(); i++) {
+				packed[i].position = vertices[i].position;
+				PackAttributes(packed[i], vertices[i]);
+			}
+			return glm::mat4(1.0f);
+		}
+
+		//Quantize positions around the center of the bounds, with the same scale on every axis so that the transform doesn't skew normals
+		glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+		glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+		float scale = std::max({halfExtent.x, halfExtent.y, halfExtent.z});
+		if(scale <= 0.0f) scale = 1.0f;
+
+		out.resize(vertices.size() * sizeof(QuantizedVertex));
+		QuantizedVertex* quantized = reinterpret_cast<QuantizedVertex*>(out.data());
+		for(std::size_t i = 0; i < vertices.size(); i++) {
+			glm::vec3 normalized = glm::clamp((vertices[i].position - center) / scale, -1.0f, 1.0f);
+			for(int axis = 0; axis < 3; axis++) {
+				quantized[i].position[axis] = int16_t(std::round(normalized[axis] * 32767.0f));
+			}
+			quantized[i].position[3] = 0;
+			PackAttributes(quantized[i], vertices[i]);
+		}
+		return glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(scale));
+	}
+
+	void Mesh::SetVertexFormat(VertexFormat newFormat) {
+		CheckException(!compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot change the vertex format of a compiled mesh!")
+
+		format = newFormat;
+		nativeData->packed.clear();
+		if(format == VertexFormat::Full) {
+			positionTransform = glm::mat4(1.0f);
+		} else {
+			positionTransform = PackVertices(vertexData, bounds, format, nativeData->packed);
+		}
+
+		for(MeshLOD& lod : lods) {
+			lod.mesh->SetVertexFormat(newFormat);
+		}
+	}
+
+	void Mesh::AddLOD(std::shared_ptr<Mesh> lod, float error) {
+		CheckException(!compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot add a LOD to a compiled mesh!")
+		CheckException(lod, Exception::GetExceptionCodeFromMeaning("NullValue"), "Cannot add a null LOD to a mesh!")
+
+		lod->SetVertexFormat(format);
+		lods.push_back(MeshLOD {.mesh = lod, .error = error});
+	}
+
+	//Point the vertex inputs at a vertex buffer of the given format
+	static void ConfigureVertexLayout(VertexFormat format) {
+		if(format == VertexFormat::Full) {
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+			glEnableVertexAttribArray(2);
+			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+			glEnableVertexAttribArray(3);
+			glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+			glEnableVertexAttribArray(4);
+			glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+			return;
+		}
+
+		//Packed formats only differ in how positions are stored
+		GLsizei stride;
+		std::size_t texCoords, normal, tangent;
+		if(format == VertexFormat::Packed) {
+			stride = sizeof(PackedVertex);
+			texCoords = offsetof(PackedVertex, texCoords);
+			normal = offsetof(PackedVertex, normal);
+			tangent = offsetof(PackedVertex, tangent);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+		} else {
+			stride = sizeof(QuantizedVertex);
+			texCoords = offsetof(QuantizedVertex, texCoords);
+			normal = offsetof(QuantizedVertex, normal);
+			tangent = offsetof(QuantizedVertex, tangent);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)0);
+		}
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)texCoords);
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)tangent);
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(4, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)normal);
+
+		//There is no bitangent (shaders rebuild it from the tangent sign)
+		glDisableVertexAttribArray(3);
+	}
+
+	VertexMemoryReport Mesh::GetMemoryReport() {
+		return VertexMemoryReport {.meshes = compiledMeshes, .vertices = compiledVertices, .fullBytes = fullVertexBytes, .actualBytes = actualVertexBytes};
 	}
 
 	std::shared_future<void> Mesh::Compile() {
 		if(std::this_thread::get_id() != Engine::GetInstance()->GetThreadID()) {
+			//Narrow the indices (ours and the LODs') here rather than on the main thread
+			if(!compiled && FitsShortIndices(vertexData.size()) && nativeData->shortIndices.empty()) NarrowIndices(indexData, nativeData->shortIndices);
+			for(MeshLOD& lod : lods) {
+				Mesh& lodMesh = *lod.mesh;
+				if(!lodMesh.compiled && FitsShortIndices(lodMesh.vertexData.size()) && lodMesh.nativeData->shortIndices.empty()) NarrowIndices(lodMesh.indexData, lodMesh.nativeData->shortIndices);
+			}
+
 			//Invoke OpenGL (ES) on the main thread
 			return InvokeGL([this]() {
 				this->Compile();
@@ -31,44 +210,71 @@ namespace Cacao {
 		glGenBuffers(1, &nativeData->vbo);
 		glGenBuffers(1, &nativeData->ibo);
 
-		//Unpack index buffer data from vec3 to floats
-		std::vector<unsigned int> ibd(indices.size() * 3);
-		for(int i = 0; i < indices.size(); i++) {
-			glm::vec3 idx = indices[i];
-			ibd[i * 3] = idx.x;
-			ibd[(i * 3) + 1] = idx.y;
-			ibd[(i * 3) + 2] = idx.z;
-		}
-
 		//Bind vertex array
 		glBindVertexArray(nativeData->vao);
 
+		//Pack vertices again if they were dropped after an earlier upload
+		if(format != VertexFormat::Full && nativeData->packed.empty() && !vertexData.empty()) {
+			PackVertices(vertexData, bounds, format, nativeData->packed);
+		}
+
 		//Bind vertex buffer
 		glBindBuffer(GL_ARRAY_BUFFER, nativeData->vbo);
 		//Load vertex buffer with data
-		glBufferData(GL_ARRAY_BUFFER, (vertices.size() * sizeof(Vertex)), &vertices[0], GL_STATIC_DRAW);
+		if(format == VertexFormat::Full) {
+			nativeData->vertexBytes = vertexData.size_bytes();
+			glBufferData(GL_ARRAY_BUFFER, nativeData->vertexBytes, vertexData.data(), GL_STATIC_DRAW);
+		} else {
+			nativeData->vertexBytes = nativeData->packed.size();
+			glBufferData(GL_ARRAY_BUFFER, nativeData->vertexBytes, nativeData->packed.data(), GL_STATIC_DRAW);
+
+			//The GPU has its own copy now
+			std::vector<unsigned char>().swap(nativeData->packed);
+		}
 
 		//Configure vertex buffer layout
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+		ConfigureVertexLayout(format);
+
+		//Configure per-instance transform, one column per location
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		for(GLuint col = 0; col < 4; col++) {
+			glEnableVertexAttribArray(instanceTransformLocation + col);
+			glVertexAttribPointer(instanceTransformLocation + col, 4, GL_FLOAT, GL_FALSE, sizeof(RenderObject), (void*)(offsetof(RenderObject, transformMatrix) + col * sizeof(glm::vec4)));
+			glVertexAttribDivisor(instanceTransformLocation + col, 1);
+		}
+		nativeData->instanceOffset = 0;
 
 		//Bind index buffer
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, nativeData->ibo);
-		//Load index buffer with data
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (indices.size() * 3 * sizeof(unsigned int)), &ibd[0], GL_STATIC_DRAW);
+		//Load index buffer with data (triangles are already packed like a 32-bit index buffer)
+		if(FitsShortIndices(vertexData.size())) {
+			if(nativeData->shortIndices.empty()) NarrowIndices(indexData, nativeData->shortIndices);
+			nativeData->indexType = GL_UNSIGNED_SHORT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, nativeData->shortIndices.size() * sizeof(uint16_t), nativeData->shortIndices.data(), GL_STATIC_DRAW);
+			nativeData->gpuBytes = nativeData->vertexBytes + nativeData->shortIndices.size() * sizeof(uint16_t);
+
+			//The GPU has its own copy now
+			std::vector<uint16_t>().swap(nativeData->shortIndices);
+		} else {
+			nativeData->indexType = GL_UNSIGNED_INT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size_bytes(), indexData.data(), GL_STATIC_DRAW);
+			nativeData->gpuBytes = nativeData->vertexBytes + indexData.size_bytes();
+		}
 
 		//Save vertex array state
 		glBindVertexArray(nativeData->vao);
 		glBindVertexArray(0);
 
+		compiledMeshes++;
+		compiledVertices += vertexData.size();
+		fullVertexBytes += vertexData.size_bytes();
+		actualVertexBytes += nativeData->vertexBytes;
+
+		//Compile the LOD chain along with us
+		for(MeshLOD& lod : lods) {
+			if(!lod.mesh->IsCompiled()) lod.mesh->Compile();
+		}
+
 		compiled = true;
 
 		//Return an empty future
@@ -93,20 +299,71 @@ namespace Cacao {
 		glDeleteBuffers(1, &nativeData->vbo);
 		glDeleteBuffers(1, &nativeData->ibo);
 
+		compiledMeshes--;
+		compiledVertices -= vertexData.size();
+		fullVertexBytes -= vertexData.size_bytes();
+		actualVertexBytes -= nativeData->vertexBytes;
+		nativeData->gpuBytes = 0;
+
+		for(MeshLOD& lod : lods) {
+			if(lod.mesh->IsCompiled()) lod.mesh->Release();
+		}
+
 		compiled = false;
 	}
 
+	AssetMemoryUsage Mesh::GetMemoryUsage() {
+		AssetMemoryUsage usage {.cpu = (vertices.size() * sizeof(Vertex)) + (indices.size() * sizeof(glm::uvec3)), .gpu = nativeData->gpuBytes};
+		for(MeshLOD& lod : lods) {
+			AssetMemoryUsage lodUsage = lod.mesh->GetMemoryUsage();
+			usage.cpu += lodUsage.cpu;
+			usage.gpu += lodUsage.gpu;
+		}
+		return usage;
+	}
+
 	void Mesh::Draw() {
 		CheckException(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID(), Exception::GetExceptionCodeFromMeaning("RenderThread"), "Cannot draw mesh in non-rendering thread!")
 		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot draw uncompiled mesh!")
 
 		//Bind vertex array
-		glBindVertexArray(nativeData->vao);
+		glState.BindVertexArray(nativeData->vao);
 
 		//Draw object
-		glDrawElements(GL_TRIANGLES, (indices.size() * 3), GL_UNSIGNED_INT, nullptr);
+		glDrawElements(GL_TRIANGLES, (indexData.size() * 3), nativeData->indexType, nullptr);
+		glState.stats.draws++;
+		glState.stats.instances++;
+		glState.stats.triangles += indexData.size();
 
 		//Unbind vertex array
-		glBindVertexArray(0);
+		glState.ReleaseVertexArray();
+	}
+
+	void Mesh::DrawInstanced(unsigned int count, std::size_t firstInstance) {
+		CheckException(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID(), Exception::GetExceptionCodeFromMeaning("RenderThread"), "Cannot draw mesh in non-rendering thread!")
+		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot draw uncompiled mesh!")
+
+		//Bind vertex array
+		glState.BindVertexArray(nativeData->vao);
+
+		//Point the instance attributes at the first instance (there's no base instance in OpenGL 4.1 or OpenGL ES 3.0)
+		std::size_t offset = firstInstance * sizeof(RenderObject);
+		if(offset != nativeData->instanceOffset) {
+			glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+			for(GLuint col = 0; col < 4; col++) {
+				glVertexAttribPointer(instanceTransformLocation + col, 4, GL_FLOAT, GL_FALSE, sizeof(RenderObject), (void*)(offset + offsetof(RenderObject, transformMatrix) + col * sizeof(glm::vec4)));
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			nativeData->instanceOffset = offset;
+		}
+
+		//Draw instances
+		glDrawElementsInstanced(GL_TRIANGLES, (indexData.size() * 3), nativeData->indexType, nullptr, count);
+		glState.stats.draws++;
+		glState.stats.instances += count;
+		glState.stats.triangles += indexData.size() * count;
+
+		//Unbind vertex array
+		glState.ReleaseVertexArray();
 	}
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include "Graphics/Window.hpp"
 #include "Events/EventSystem.hpp"
 #include "GLUtils.hpp"
+#include "GLStateCache.hpp"
+#include "GLTextureUploader.hpp"
+#include "GLTextureStreamer.hpp"
 #include "Core/Engine.hpp"
 #include "Core/Exception.hpp"
 #include "ExceptionCodes.hpp"
@@ -13,6 +16,10 @@
 #include "Graphics/Textures/Cubemap.hpp"
 #include "GLUIView.hpp"
 
+#include <queue>
+#include <algorithm>
+#include <chrono>
+
 constexpr glm::vec3 clearColorSRGB {float(0xCF) / 256, 1.0f, float(0x4D) / 256};
 
 namespace Cacao {
@@ -22,16 +29,34 @@ namespace Cacao {
 	//Queue mutex
 	static std::mutex queueMutex;
 
+	//Render thread work waiting for the driver (only touched on the render thread)
+	static std::vector<std::function<bool()>> glPolls;
+
 	//UI quad assets
 	static GLuint uiVao, uiVbo;
 	static UIViewShaderManager uivsm;
 
+	//Run every poll once, dropping the ones that finish
+	static void RunGLPolls() {
+		if(glPolls.empty()) return;
+		std::vector<std::function<bool()>> polls;
+		polls.swap(glPolls);
+		for(std::function<bool()>& poll : polls) {
+			if(!poll()) glPolls.push_back(std::move(poll));
+		}
+	}
+
 	void RenderController::UpdateGraphicsState() {
 		//Process OpenGL (ES) tasks
-		while(!glQueue.empty()) {
+		while(true) {
 			//Acquire next task
 			queueMutex.lock();
-			Task& task = glQueue.front();
+			if(glQueue.empty()) {
+				queueMutex.unlock();
+				break;
+			}
+			Task task = glQueue.front();
+			glQueue.pop();
 			queueMutex.unlock();
 
 			//Run task
@@ -44,119 +69,156 @@ namespace Cacao {
 			} catch(...) {
 				task.status->set_exception(std::current_exception());
 			}
-
-			//Remove task from queue
-			queueMutex.lock();
-			glQueue.pop();
-			queueMutex.unlock();
 		}
+
+		//Move texture uploads along within this frame's budget
+		PumpTextureUploads();
+
+		//Check on work waiting for the driver, keeping what isn't done yet
+		RunGLPolls();
 	}
 
-	void RenderController::ProcessFrame(std::shared_ptr<Frame> frame) {
-		//Send the frame into the queue
-		std::shared_future<void> frameTask = InvokeGL([frame]() {
-			//Clear the screen
-			//We use an obnoxious neon alligator green because it indicates that something is messed up if you can see it
-			glm::vec3 clearColorLinear = glm::pow(clearColorSRGB, glm::vec3 {2.2f});
-			glClearColor(clearColorLinear.r, clearColorLinear.g, clearColorLinear.b, 1.0f);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-			//Upload globals
-			Shader::UploadCacaoGlobals(frame->projection, frame->view);
-
-			//Render main scene
-			for(RenderObject& obj : frame->objects) {
-				//Upload material data to shader
-				obj.material.shader->UploadData(obj.material.data);
-				obj.material.shader->UploadCacaoLocals(obj.transformMatrix);
-
-				//Bind shader
-				obj.material.shader->Bind();
-
-				//Configure OpenGL (ES)
-				glEnable(GL_DEPTH_TEST);
-				glDisable(GL_BLEND);
-				glDepthFunc(GL_LESS);
-
-				//Draw the mesh
-				obj.mesh->Draw();
-
-				//Unbind any textures
-				const ShaderSpec& spec = obj.material.shader->GetSpec();
-				for(ShaderUploadItem& sui : obj.material.data) {
-					if(std::find_if(spec.begin(), spec.end(), [&sui](ShaderItemInfo sii) {
-						   return (sii.type == SpvType::SampledImage && sii.entryName == sui.target);
-					   }) != spec.end()) {
-						if(sui.data.type() == typeid(Texture2D*)) {
-							Texture2D* tex = std::any_cast<Texture2D*>(sui.data);
-							tex->Unbind();
-						} else if(sui.data.type() == typeid(Cubemap*)) {
-							Cubemap* tex = std::any_cast<Cubemap*>(sui.data);
-							tex->Unbind();
-						} else if(sui.data.type() == typeid(UIView*)) {
-							UIView* view = std::any_cast<UIView*>(sui.data);
-							view->Unbind();
-						} else if(sui.data.type() == typeid(AssetHandle<Texture2D>)) {
-							AssetHandle<Texture2D> tex = std::any_cast<AssetHandle<Texture2D>>(sui.data);
-							tex->Unbind();
-						} else if(sui.data.type() == typeid(AssetHandle<Cubemap>)) {
-							AssetHandle<Cubemap> tex = std::any_cast<AssetHandle<Cubemap>>(sui.data);
-							tex->Unbind();
-						} else if(sui.data.type() == typeid(AssetHandle<UIView>)) {
-							AssetHandle<UIView> view = std::any_cast<AssetHandle<UIView>>(sui.data);
-							view->Unbind();
-						}
-					}
+	void RenderController::ProcessFrame(Frame& frame) {
+		//Stream texture detail in or out based on how large textures are drawn in this frame
+		PumpTextureStreaming();
+
+		//Clear the screen
+		//We use an obnoxious neon alligator green because it indicates that something is messed up if you can see it
+		glm::vec3 clearColorLinear = glm::pow(clearColorSRGB, glm::vec3 {2.2f});
+		glClearColor(clearColorLinear.r, clearColorLinear.g, clearColorLinear.b, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		//Upload globals
+		Shader::UploadCacaoGlobals(frame.projection, frame.view);
+
+		//Upload the render objects as the instance buffer if anything is instanced
+		//Reallocating the storage every frame means we never wait on last frame's draws to finish with it
+		if(!frame.objects.empty() && std::any_of(frame.materials.begin(), frame.materials.end(), [](const MaterialSnapshot& mat) { return mat.shader->IsInstanced(); })) {
+			glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+			glBufferData(GL_ARRAY_BUFFER, frame.objects.size_bytes(), frame.objects.data(), GL_STREAM_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		//Render main scene
+		//Objects arrive sorted by shader, then material, then mesh, so each of those is only bound when it changes
+		glState.Begin();
+		glState.SetCapability(GL_DEPTH_TEST, true);
+		glState.SetCapability(GL_BLEND, false);
+		glState.DepthFunc(GL_LESS);
+		//Materials are drawn as they were captured when the frame was built
+		auto texturesOf = [&frame](const MaterialSnapshot& material) {
+			return std::span<const MaterialTexture>(frame.textures.data() + material.firstTexture, material.textureCount);
+		};
+		const MaterialSnapshot* lastMaterial = nullptr;
+		for(std::size_t i = 0; i < frame.objects.size(); i++) {
+			RenderObject& obj = frame.objects[i];
+			const MaterialSnapshot& material = frame.materials[obj.material];
+
+			if(&material != lastMaterial) {
+				if(lastMaterial) lastMaterial->material->Unbind(texturesOf(*lastMaterial));
+
+				//Switch shaders if this material uses a different one
+				if(!lastMaterial || lastMaterial->shader != material.shader) {
+					if(lastMaterial) lastMaterial->shader->Unbind();
+					material.shader->Bind();
 				}
 
-				//Unbind shader
-				obj.material.shader->Unbind();
+				//Bind the material's data block and textures (the block is only uploaded if it changed)
+				material.material->Bind(material, texturesOf(material));
+				lastMaterial = &material;
 			}
 
-			//Draw skybox (if one exists)
-			if(!frame->skybox.IsNull()) frame->skybox->Draw(frame->projection, frame->view);
-
-			//Draw UI
-			if(Engine::GetInstance()->GetGlobalUIView()->HasBeenRendered()) {
-				//Create projection matrix
-				glm::mat4 project = glm::ortho(0.0f, 1.0f, 0.0f, 1.0f);
-
-				//Upload uniforms
-				ShaderUploadData uiud;
-				uiud.emplace_back(ShaderUploadItem {.target = "uiTex", .data = std::any(Engine::GetInstance()->GetGlobalUIView().get())});
-				uivsm->Bind();
-				uivsm->UploadData(uiud);
-				Shader::UploadCacaoGlobals(project, glm::identity<glm::mat4>());//Kinda scary but it'll get overwritten for the next frame
-
-				//Configure OpenGL (ES)
-				glDisable(GL_DEPTH_TEST);
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-				//Draw quad
-				glBindVertexArray(uiVao);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-				glBindVertexArray(0);
-
-				//Reset OpenGL (ES) configurations to normal
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_LESS);
-				glDisable(GL_BLEND);
-
-				//Unbind UI view texture and shader
-				uivsm->Unbind();
-				Engine::GetInstance()->GetGlobalUIView()->Unbind();
+			//Draw every object in a run sharing this mesh and material at once if we can
+			if(material.shader->IsInstanced()) {
+				std::size_t runEnd = i + 1;
+				while(runEnd < frame.objects.size() && frame.objects[runEnd].mesh == obj.mesh && frame.objects[runEnd].material == obj.material) runEnd++;
+				frame.meshes[obj.mesh]->DrawInstanced(runEnd - i, i);
+				i = runEnd - 1;
+				continue;
 			}
-		});
 
-		//Update the graphics state (will guarantee that the task is processed, so it doesn't need to be waited on)
-		UpdateGraphicsState();
+			//Draw the mesh
+			material.shader->UploadCacaoLocals(obj.transformMatrix);
+			frame.meshes[obj.mesh]->Draw();
+		}
+		if(lastMaterial) {
+			lastMaterial->material->Unbind(texturesOf(*lastMaterial));
+			lastMaterial->shader->Unbind();
+		}
+		glState.End();
+
+		std::stringstream stats;
+		stats << "Scene pass: " << glState.stats.draws << " draws (" << glState.stats.instances << " instances, " << glState.stats.triangles << " triangles), " << glState.stats.programBinds << " program binds, " << glState.stats.textureBinds << " texture binds, " << glState.stats.uniformBufferBinds << " uniform buffer binds, " << glState.stats.vertexArrayBinds << " vertex array binds, " << glState.stats.stateChanges << " state changes, " << glState.stats.skippedBinds << " redundant binds skipped";
+		Logging::EngineLog(stats.str(), LogLevel::Trace);
+
+		//Draw skybox (if one exists)
+		if(!frame.skybox.IsNull()) frame.skybox->Draw(frame.projection, frame.view);
+
+		//Draw UI
+		if(Engine::GetInstance()->GetGlobalUIView()->HasBeenRendered()) {
+			//Create projection matrix
+			glm::mat4 project = glm::ortho(0.0f, 1.0f, 0.0f, 1.0f);
+
+			//Upload uniforms
+			ShaderUploadData uiud;
+			uiud.emplace_back(ShaderUploadItem {.target = "uiTex", .data = std::any(Engine::GetInstance()->GetGlobalUIView().get())});
+			uivsm->Bind();
+			uivsm->UploadData(uiud);
+			Shader::UploadCacaoGlobals(project, glm::identity<glm::mat4>());//Kinda scary but it'll get overwritten for the next frame
+
+			//Configure OpenGL (ES)
+			glDisable(GL_DEPTH_TEST);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			//Draw quad
+			glBindVertexArray(uiVao);
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+			glBindVertexArray(0);
+
+			//Reset OpenGL (ES) configurations to normal
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_LESS);
+			glDisable(GL_BLEND);
+
+			//Unbind UI view texture and shader
+			uivsm->Unbind();
+			Engine::GetInstance()->GetGlobalUIView()->Unbind();
+		}
 	}
 
 	void EnqueueGLJob(Task& task) {
 		queueMutex.lock();
 		glQueue.push(task);
 		queueMutex.unlock();
+
+		//Let the render thread know there's work to do
+		RenderController::GetInstance()->WakeUp();
+	}
+
+	void AddGLPoll(std::function<bool()> poll) {
+		glPolls.push_back(std::move(poll));
+	}
+
+	void RenderController::EnqueueTask(Task& task) {
+		EnqueueGLJob(task);
+	}
+
+	void RenderController::RunWhenReady(std::shared_future<void> future, std::function<void()> then) {
+		auto poll = [future, then]() {
+			if(future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+			then();
+			return true;
+		};
+
+		//Polls can only be added on the render thread
+		if(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID()) {
+			AddGLPoll(poll);
+		} else {
+			InvokeGL([poll]() {
+				AddGLPoll(poll);
+			});
+		}
 	}
 
 	void RenderController::Init() {
@@ -170,12 +232,28 @@ namespace Cacao {
 		glEnable(GL_FRAMEBUFFER_SRGB);
 #endif
 
+		//Let the driver use as many threads as it wants for compiling shaders, since we check for completion instead of waiting
+		if(GLAD_GL_KHR_parallel_shader_compile) {
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#ifndef ES
+		} else if(GLAD_GL_ARB_parallel_shader_compile) {
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+#endif
+		}
+
 		//Create globals UBO
 		glGenBuffers(1, &globalsUBO);
 		glBindBuffer(GL_UNIFORM_BUFFER, globalsUBO);
 		glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
 		glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+		//Create instance buffer
+		//Meshes point their instance attributes at it when compiled, so it has to exist first and always hold at least one instance
+		glGenBuffers(1, &instanceVBO);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(RenderObject), nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
 		//Compile UI view shader
 		uivsm.Compile();
 
@@ -229,9 +307,21 @@ namespace Cacao {
 			glQueue.pop();
 		}
 
+		//Stop streaming texture detail and let texture uploads land
+		ShutdownTextureStreaming();
+		ShutdownTextureUploads();
+
+		//Let work waiting for the driver finish
+		while(!glPolls.empty()) {
+			RunGLPolls();
+		}
+
 		//Delete global shader UBO
 		glDeleteBuffers(1, &globalsUBO);
 
+		//Delete instance buffer
+		glDeleteBuffers(1, &instanceVBO);
+
 		isInitialized = false;
 	}
 
@@ -6,8 +6,11 @@
 #include "Core/Log.hpp"
 #include "Core/Engine.hpp"
 #include "Core/Exception.hpp"
+#include "Utilities/VFS.hpp"
 #include "GLUtils.hpp"
+#include "GLStateCache.hpp"
 #include "GLHooks.hpp"
+#include "GLShaderCache.hpp"
 
 #include "GLHeaders.hpp"
 #include "spirv_glsl.hpp"
@@ -19,19 +22,44 @@
 #include <cstdio>
 #include <cstring>
 #include <utility>
+#include <algorithm>
 #include <future>
 #include <iostream>
+#include <map>
+#include <type_traits>
 
 namespace Cacao {
-	//Required static member initialization
-	GLuint Shader::ShaderData::uboIndexCounter = 1;
+	//Add the members of the push constant block to the layout
+	//SPIRV-Cross only emits the block if it can keep these offsets (std140), so they are also the offsets OpenGL (ES) uses
+	static void ReadBlockLayout(spirv_cross::CompilerGLSL& compiler, spirv_cross::ShaderResources& res, ShaderBlockLayout& layout) {
+		for(auto& pcb : res.push_constant_buffers) {
+			const spirv_cross::SPIRType& type = compiler.get_type(pcb.base_type_id);
+			layout.size = std::max(layout.size, compiler.get_declared_struct_size(type));
+			for(uint32_t i = 0; i < type.member_types.size(); i++) {
+				BlockMember& member = layout.members[compiler.get_member_name(pcb.base_type_id, i)];
+				member.offset = compiler.type_struct_member_offset(type, i);
+				member.matrixStride = (compiler.get_type(type.member_types[i]).columns > 1 ? compiler.type_struct_member_matrix_stride(type, i) : 0);
+			}
+		}
+	}
 
-	std::pair<std::string, std::string> RunSpvCross(std::vector<uint32_t>& vbuf, std::vector<uint32_t>& fbuf) {
+	//Add the names the push constant block was declared with to the layout
+	//These are only known once the GLSL has been generated
+	static void ReadBlockNames(spirv_cross::CompilerGLSL& compiler, spirv_cross::ShaderResources& res, ShaderBlockLayout& layout) {
+		for(auto& pcb : res.push_constant_buffers) {
+			std::string name = compiler.get_remapped_declared_block_name(pcb.id);
+			if(std::find(layout.names.begin(), layout.names.end(), name) == layout.names.end()) layout.names.push_back(name);
+		}
+	}
+
+	std::pair<std::string, std::string> RunSpvCross(std::vector<uint32_t>& vbuf, std::vector<uint32_t>& fbuf, bool& instanced, ShaderBlockLayout& block) {
 		//Convert SPIR-V to GLSL
 
 		//Create common options
+		//OpenGL (ES) has no push constants, so custom shader data becomes a uniform block
 		spirv_cross::CompilerGLSL::Options options;
 		ConfigureSPIRV(&options);
+		options.emit_push_constant_as_uniform_buffer = true;
 
 		//Parse SPIR-V IR
 		spirv_cross::Parser vertParse(std::move(vbuf));
@@ -70,6 +98,14 @@ namespace Cacao {
 			}
 		}
 
+		//Shaders with an input at the instance transform location are instanced
+		instanced = false;
+		for(auto& in : vertRes.stage_inputs) {
+			if(vertGLSL.has_decoration(in.id, spv::DecorationLocation) && vertGLSL.get_decoration(in.id, spv::DecorationLocation) == instanceTransformLocation) {
+				instanced = true;
+			}
+		}
+
 		//Load fragment shader
 		spirv_cross::ParsedIR& fir = fragParse.get_parsed_ir();
 		bool fhlsl = fir.source.hlsl;
@@ -88,197 +124,381 @@ namespace Cacao {
 			}
 		}
 
+		//Record where custom shader data lives
+		ReadBlockLayout(vertGLSL, vertRes, block);
+		ReadBlockLayout(fragGLSL, fragRes, block);
+
 		//Remove image decorations
 		for(auto& img : fragRes.sampled_images) {
 			fragGLSL.unset_decoration(img.id, spv::DecorationDescriptorSet);
 		}
 
 		//Compile SPIR-V to GLSL
-		return std::make_pair<std::string, std::string>(vertGLSL.compile(), fragGLSL.compile());
+		std::pair<std::string, std::string> glsl(vertGLSL.compile(), fragGLSL.compile());
+		ReadBlockNames(vertGLSL, vertRes, block);
+		ReadBlockNames(fragGLSL, fragRes, block);
+		return glsl;
 	}
 
-	Shader::Shader(std::string vertexPath, std::string fragmentPath, ShaderSpec spec)
-	  : Asset(false), bound(false), specification(spec) {
-		//Validate that these paths exist
-		CheckException(std::filesystem::exists(vertexPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot create a shader from a non-existent vertex shader file!")
-		CheckException(std::filesystem::exists(fragmentPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot create a shader from a non-existent fragment shader file!")
+	//Get the GLSL for a shader's SPIR-V, from the shader cache if it's there
+	static GeneratedShader GenerateGLSL(std::vector<uint32_t>& vertex, std::vector<uint32_t>& fragment, uint64_t& cacheKey) {
+		cacheKey = HashShaderSource(vertex, fragment);
+		GeneratedShader generated;
+		if(LoadCachedGLSL(cacheKey, generated)) return generated;
+
+		auto glsl = RunSpvCross(vertex, fragment, generated.instanced, generated.block);
+		generated.vertexCode = std::move(glsl.first);
+		generated.fragmentCode = std::move(glsl.second);
+		StoreCachedGLSL(cacheKey, generated);
+		return generated;
+	}
 
-		//Load SPIR-V code
+	//Get the description of a C++ type that a shader value is set with
+	template<typename T, typename Scalar, unsigned int Rows, unsigned int Columns>
+	static const ParameterType* ParamTypeOf() {
+		static const ParameterType pt = {
+			.cppType = &typeid(T),
+			.extract = [](const std::any& value) -> const void* { return std::any_cast<T>(&value); },
+			.scalarSize = sizeof(Scalar),
+			.rows = Rows,
+			.columns = Columns};
+		return &pt;
+	}
 
-		//Open file streams
-		FILE* vf = fopen(vertexPath.c_str(), "rb");
-		CheckException(vf, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open vertex shader file!")
-		FILE* ff = fopen(fragmentPath.c_str(), "rb");
-		CheckException(ff, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open fragment shader file!")
-
-		//Get size of shader files
-		fseek(vf, 0, SEEK_END);
-		long vlen = ftell(vf) / sizeof(uint32_t);
-		rewind(vf);
-		fseek(ff, 0, SEEK_END);
-		long flen = ftell(ff) / sizeof(uint32_t);
-		rewind(ff);
-
-		//Load shader data into vectors
-		std::vector<uint32_t> vbuf(vlen);
-		std::vector<uint32_t> fbuf(flen);
-		if(fread(vbuf.data(), sizeof(uint32_t), vlen, vf) != std::size_t(vlen)) {
-			//Clean up file streams before exception throw
-			fclose(vf);
-			fclose(ff);
-			CheckException(false, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to read vertex shader data from file!")
+	//Pick the C++ type for a shader value with a scalar type and size
+	template<typename Scalar>
+	static const ParameterType* ResolveParamType(int dims) {
+		switch(dims) {
+			case 1: return ParamTypeOf<Scalar, Scalar, 1, 1>();
+			case 2: return ParamTypeOf<glm::vec<2, Scalar>, Scalar, 2, 1>();
+			case 3: return ParamTypeOf<glm::vec<3, Scalar>, Scalar, 3, 1>();
+			case 4: return ParamTypeOf<glm::vec<4, Scalar>, Scalar, 4, 1>();
 		}
-		if(fread(fbuf.data(), sizeof(uint32_t), flen, ff) != std::size_t(flen)) {
-			//Clean up file streams before exception throw
-			fclose(vf);
-			fclose(ff);
-			CheckException(false, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to read fragment shader data from file!")
+		if constexpr(std::is_floating_point_v<Scalar>) {
+			switch(dims) {
+				case 6: return ParamTypeOf<glm::mat<2, 2, Scalar>, Scalar, 2, 2>();
+				case 7: return ParamTypeOf<glm::mat<2, 3, Scalar>, Scalar, 3, 2>();
+				case 8: return ParamTypeOf<glm::mat<2, 4, Scalar>, Scalar, 4, 2>();
+				case 10: return ParamTypeOf<glm::mat<3, 2, Scalar>, Scalar, 2, 3>();
+				case 11: return ParamTypeOf<glm::mat<3, 3, Scalar>, Scalar, 3, 3>();
+				case 12: return ParamTypeOf<glm::mat<3, 4, Scalar>, Scalar, 4, 3>();
+				case 14: return ParamTypeOf<glm::mat<4, 2, Scalar>, Scalar, 2, 4>();
+				case 15: return ParamTypeOf<glm::mat<4, 3, Scalar>, Scalar, 3, 4>();
+				case 16: return ParamTypeOf<glm::mat<4, 4, Scalar>, Scalar, 4, 4>();
+			}
 		}
+		return nullptr;
+	}
 
-		//Close file streams
-		fclose(vf);
-		fclose(ff);
+	//Pick the C++ type for a shader value (nullptr for textures and unsupported sizes)
+	//Boolean vectors are set with integer vectors
+	static const ParameterType* ResolveParamType(SpvType type, int dims) {
+		switch(type) {
+			case SpvType::Boolean: return (dims == 1 ? ParamTypeOf<bool, bool, 1, 1>() : (dims <= 4 ? ResolveParamType<int>(dims) : nullptr));
+			case SpvType::Int: return ResolveParamType<int>(dims);
+			case SpvType::UInt: return ResolveParamType<unsigned int>(dims);
+			case SpvType::Float: return ResolveParamType<float>(dims);
+			case SpvType::Double: return ResolveParamType<double>(dims);
+			case SpvType::Int64: return ResolveParamType<int64_t>(dims);
+			case SpvType::UInt64: return ResolveParamType<uint64_t>(dims);
+			default: return nullptr;
+		}
+	}
 
-		//Create native data
-		nativeData.reset(new ShaderData());
+	//Check that writing a value of a type to a block member stays inside the block (a spec that disagrees with the shader could otherwise write past it)
+	static bool FitsBlockMember(const ParameterType& pt, const BlockMember& member, std::size_t blockSize) {
+		if(pt.columns > 1 && member.matrixStride == 0) return false;
+		std::size_t columnSize = (*pt.cppType == typeid(bool) ? sizeof(uint32_t) : pt.rows * pt.scalarSize);
+		std::size_t end = member.offset + ((pt.columns - 1) * member.matrixStride) + columnSize;
+		return end <= blockSize;
+	}
 
-		//Get shader code
-		auto glsl = RunSpvCross(vbuf, fbuf);
-		nativeData->vertexCode = glsl.first;
-		nativeData->fragmentCode = glsl.second;
+	//Resolve the spec against the shader's data block once so that setting values doesn't have to look anything up
+	//Texture slots are handed out in spec order and never change
+	static std::vector<UniformSlot> ResolveSpec(const ShaderSpec& spec, const ShaderBlockLayout& block) {
+		std::vector<UniformSlot> slots;
+		int textureSlots = 0;
+		for(const ShaderItemInfo& info : spec) {
+			UniformSlot& slot = slots.emplace_back();
+			slot.name = info.entryName;
+			slot.type = SpvType(uint32_t(info.type));
+			slot.textureSlot = -1;
+			slot.paramType = nullptr;
+			slot.offset = slot.matrixStride = 0;
+			slot.errorCode = 0;
+
+			//Turn dimensions into single number (easier for matching types)
+			slot.dims = (4 * info.size.y) - (4 - info.size.x);
+
+			//Record why this entry can't be set, if it can't
+			//Errors are only raised when something is actually set
+			UniformTypeCheckResponse res = CheckUniformType(info.type);
+			auto member = block.members.find(info.entryName);
+			if(!res.ok) {
+				slot.error = res.err;
+				slot.errorCode = Exception::GetExceptionCodeFromMeaning("UnsupportedType");
+			} else if(info.size.x == 1 && info.size.y >= 2) {
+				slot.error = "Shaders cannot have data with one column and 2+ rows!";
+				slot.errorCode = Exception::GetExceptionCodeFromMeaning("UniformUploadFailure");
+			} else if(info.size.x > 1 && info.size.y > 1 && info.type != SpvType::Float && info.type != SpvType::Double) {
+				slot.error = "Shaders cannot have data with 2+ columns and rows that are not floats or doubles!";
+				slot.errorCode = Exception::GetExceptionCodeFromMeaning("UniformUploadFailure");
+			} else if(info.type == SpvType::SampledImage && slot.dims != 1) {
+				slot.error = "Shaders cannot have arrays or matrices of textures!";
+				slot.errorCode = Exception::GetExceptionCodeFromMeaning("UniformUploadFailure");
+			} else if(info.type == SpvType::SampledImage) {
+				slot.textureSlot = textureSlots++;
+			} else if(member == block.members.end()) {
+				slot.error = "Shader does not contain the requested uniform!";
+				slot.errorCode = Exception::GetExceptionCodeFromMeaning("NonexistentValue");
+			} else if(!(slot.paramType = ResolveParamType(slot.type, slot.dims))) {
+				slot.error = "Shader data type is not supported!";
+				slot.errorCode = Exception::GetExceptionCodeFromMeaning("UnsupportedType");
+			} else if(!FitsBlockMember(*slot.paramType, member->second, block.size)) {
+				slot.error = "Shader data type does not match the uniform it is set on!";
+				slot.errorCode = Exception::GetExceptionCodeFromMeaning("UniformUploadFailure");
+				slot.paramType = nullptr;
+			} else {
+				slot.offset = member->second.offset;
+				slot.matrixStride = member->second.matrixStride;
+			}
+		}
+		return slots;
 	}
 
-	Shader::Shader(std::vector<uint32_t>& vertex, std::vector<uint32_t>& fragment, ShaderSpec spec)
-	  : Asset(false), bound(false), specification(spec) {
-		//Create native data
-		nativeData.reset(new ShaderData());
+	//Shader and program objects of a program the driver may still be compiling and linking
+	struct PendingProgram {
+		GLuint vertex, fragment, program;
+	};
+
+	//Start compiling and linking a program from GLSL
+	//Nothing here asks the driver for a result, so with parallel shader compilation the driver does the work on its own threads
+	static PendingProgram SubmitProgram(const std::string& vertexCode, const std::string& fragmentCode) {
+		PendingProgram pending;
+
+		//Compile shaders
+		const GLchar* vertexSrc = vertexCode.c_str();
+		pending.vertex = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(pending.vertex, 1, &vertexSrc, 0);
+		glCompileShader(pending.vertex);
+		const GLchar* fragmentSrc = fragmentCode.c_str();
+		pending.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(pending.fragment, 1, &fragmentSrc, 0);
+		glCompileShader(pending.fragment);
+
+		//Link shader program (letting the driver know that we want its binary)
+		pending.program = glCreateProgram();
+		glAttachShader(pending.program, pending.vertex);
+		glAttachShader(pending.program, pending.fragment);
+		glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(pending.program);
+
+		return pending;
+	}
 
-		//Get shader code
-		auto glsl = RunSpvCross(vertex, fragment);
-		nativeData->vertexCode = glsl.first;
-		nativeData->fragmentCode = glsl.second;
+	//Check whether the driver is done with a submitted program without waiting for it
+	static bool IsProgramReady(const PendingProgram& pending) {
+		if(!HasParallelShaderCompile()) return true;
+		GLint done = GL_FALSE;
+		glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &done);
+		return done == GL_TRUE;
 	}
 
-	std::shared_future<void> Shader::Compile() {
-		if(std::this_thread::get_id() != Engine::GetInstance()->GetThreadID()) {
-			//Invoke OpenGL (ES) on the main thread
-			return InvokeGL([this]() {
-				this->Compile();
-			});
-		}
-		CheckException(!compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot compile compiled shader!");
+	//Get a submitted program once it is done (waiting for the driver if it isn't), cleaning up its shader objects
+	static GLuint FinishProgram(const PendingProgram& pending) {
+		//Get the log of a failed shader or program and clean everything up
+		auto fail = [&pending](GLuint object, bool isProgram) {
+			GLint maxLen = 0;
+			(isProgram ? glGetProgramiv : glGetShaderiv)(object, GL_INFO_LOG_LENGTH, &maxLen);
+			std::vector<GLchar> infoLog(std::max(maxLen, 1), '\0');
+			(isProgram ? glGetProgramInfoLog : glGetShaderInfoLog)(object, maxLen, &maxLen, infoLog.data());
+			glDeleteProgram(pending.program);
+			glDeleteShader(pending.vertex);
+			glDeleteShader(pending.fragment);
+			return std::string(infoLog.data());
+		};
+
+		//Confirm shader compilation
+		GLint status;
+		glGetShaderiv(pending.vertex, GL_COMPILE_STATUS, &status);
+		CheckException(status == GL_TRUE, Exception::GetExceptionCodeFromMeaning("GLESError"), std::string("Vertex shader compilation failure: ") + fail(pending.vertex, false))
+		glGetShaderiv(pending.fragment, GL_COMPILE_STATUS, &status);
+		CheckException(status == GL_TRUE, Exception::GetExceptionCodeFromMeaning("GLESError"), std::string("Fragment shader compilation failure: ") + fail(pending.fragment, false))
 
-		//Create vertex shader base
-		GLuint compiledVertexShader = glCreateShader(GL_VERTEX_SHADER);
-		const GLchar* vertexSrc = nativeData->vertexCode.c_str();
+		//Confirm shader program linking
+		glGetProgramiv(pending.program, GL_LINK_STATUS, &status);
+		CheckException(status == GL_TRUE, Exception::GetExceptionCodeFromMeaning("GLESError"), std::string("Shader linking failure: ") + fail(pending.program, true))
 
-		//Compile vertex shader
-		glShaderSource(compiledVertexShader, 1, &vertexSrc, 0);
-		glCompileShader(compiledVertexShader);
+		//Detach and delete linked shaders
+		glDetachShader(pending.program, pending.fragment);
+		glDetachShader(pending.program, pending.vertex);
+		glDeleteShader(pending.vertex);
+		glDeleteShader(pending.fragment);
 
-		//Confirm vertex shader compilation
-		GLint vertexCompileStatus;
-		glGetShaderiv(compiledVertexShader, GL_COMPILE_STATUS, &vertexCompileStatus);
-		if(vertexCompileStatus == GL_FALSE) {
-			//Get compilation log
-			GLint maxLen = 0;
-			glGetShaderiv(compiledVertexShader, GL_INFO_LOG_LENGTH, &maxLen);
-			std::vector<GLchar> infoLog(maxLen);
-			glGetShaderInfoLog(compiledVertexShader, maxLen, &maxLen, &infoLog[0]);
-			//Clean up resources
-			glDeleteShader(compiledVertexShader);
-			//Throw exception
-			CheckException(false, Exception::GetExceptionCodeFromMeaning("GLESError"), std::string("Vertex shader compilation failure: ") + infoLog.data());
-			return {};
-		}
+		return pending.program;
+	}
 
-		//Create fragment shader base
-		GLuint compiledFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		const GLchar* fragmentSrc = nativeData->fragmentCode.c_str();
+	Shader::Shader(std::string vertexPath, std::string fragmentPath, ShaderSpec spec)
+	  : Asset(false), bound(false), specification(spec) {
+		//Validate that these paths exist
+		CheckException(VFS::GetInstance()->Exists(vertexPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot create a shader from a non-existent vertex shader file!")
+		CheckException(VFS::GetInstance()->Exists(fragmentPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot create a shader from a non-existent fragment shader file!")
 
-		//Compile fragment shader
-		glShaderSource(compiledFragmentShader, 1, &fragmentSrc, 0);
-		glCompileShader(compiledFragmentShader);
+		//Load SPIR-V code
+		auto readCode = [](const std::string& path) {
+			std::shared_ptr<MappedFile> file = VFS::GetInstance()->Open(path);
+			std::vector<uint32_t> code(file->GetSize() / sizeof(uint32_t));
+			if(!code.empty()) std::memcpy(code.data(), file->GetData(), code.size() * sizeof(uint32_t));
+			return code;
+		};
+		std::vector<uint32_t> vbuf = readCode(vertexPath);
+		std::vector<uint32_t> fbuf = readCode(fragmentPath);
 
-		//Confirm fragment shader compilation
-		GLint fragmentCompileStatus;
-		glGetShaderiv(compiledFragmentShader, GL_COMPILE_STATUS, &fragmentCompileStatus);
-		if(fragmentCompileStatus == GL_FALSE) {
-			//Get compilation log
-			GLint maxLen = 0;
-			glGetShaderiv(compiledFragmentShader, GL_INFO_LOG_LENGTH, &maxLen);
-			std::vector<GLchar> infoLog(maxLen);
-			glGetShaderInfoLog(compiledFragmentShader, maxLen, &maxLen, &infoLog[0]);
-			//Clean up resources
-			glDeleteShader(compiledVertexShader);
-			glDeleteShader(compiledFragmentShader);
-			//Throw exception
-			CheckException(false, Exception::GetExceptionCodeFromMeaning("GLESError"), std::string("Fragment shader compilation failure: ") + infoLog.data());
-			return {};
-		}
+		//Create native data
+		nativeData.reset(new ShaderData());
 
-		//Create shader program
-		GLuint program = glCreateProgram();
+		//Get shader code
+		GeneratedShader glsl = GenerateGLSL(vbuf, fbuf, nativeData->cacheKey);
+		nativeData->vertexCode = std::move(glsl.vertexCode);
+		nativeData->fragmentCode = std::move(glsl.fragmentCode);
+		nativeData->instanced = glsl.instanced;
+
+		//Lay out the spec
+		nativeData->uniforms = ResolveSpec(specification, glsl.block);
+		nativeData->blockSize = glsl.block.size;
+		nativeData->blockNames = std::move(glsl.block.names);
+		nativeData->block.resize(glsl.block.size);
+	}
 
-		//Attach compiled shaders to program
-		glAttachShader(program, compiledVertexShader);
-		glAttachShader(program, compiledFragmentShader);
+	Shader::Shader(std::vector<uint32_t>& vertex, std::vector<uint32_t>& fragment, ShaderSpec spec)
+	  : Asset(false), bound(false), specification(spec) {
+		//Create native data
+		nativeData.reset(new ShaderData());
 
-		//Link shader program
-		glLinkProgram(program);
+		//Get shader code
+		GeneratedShader glsl = GenerateGLSL(vertex, fragment, nativeData->cacheKey);
+		nativeData->vertexCode = std::move(glsl.vertexCode);
+		nativeData->fragmentCode = std::move(glsl.fragmentCode);
+		nativeData->instanced = glsl.instanced;
+
+		//Lay out the spec
+		nativeData->uniforms = ResolveSpec(specification, glsl.block);
+		nativeData->blockSize = glsl.block.size;
+		nativeData->blockNames = std::move(glsl.block.names);
+		nativeData->block.resize(glsl.block.size);
+	}
 
-		//Confirm shader program linking
-		GLint linkStatus;
-		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
-		if(linkStatus == GL_FALSE) {
-			//Get linking log
-			GLint maxLen = 0;
-			glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLen);
-			std::vector<GLchar> infoLog(maxLen);
-			glGetProgramInfoLog(program, maxLen, &maxLen, &infoLog[0]);
-			//Clean up resources
-			glDeleteProgram(program);
-			glDeleteShader(compiledVertexShader);
-			glDeleteShader(compiledFragmentShader);
-			//Throw exception
-			CheckException(false, Exception::GetExceptionCodeFromMeaning("GLESError"), std::string("Shader linking failure: ") + infoLog.data());
-			return {};
-		}
+	std::shared_future<void> Shader::Compile() {
+		CheckException(!compiled && !nativeData->compiling.exchange(true), Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot compile compiled shader!");
+
+		//Set up everything around a linked program
+		auto finish = [this](GLuint program) {
+			//Look for the engine's uniform blocks first, so that the program is all there is to delete if one is missing
+			//The local one is optional for instanced shaders, which get their transform from the instance buffer
+			GLuint globalUBOIdx = glGetUniformBlockIndex(program, "CacaoGlobals");
+			GLuint localUBOIdx = glGetUniformBlockIndex(program, "CacaoLocals");
+			if(globalUBOIdx == GL_INVALID_INDEX || (localUBOIdx == GL_INVALID_INDEX && !nativeData->instanced)) glDeleteProgram(program);
+			CheckException(globalUBOIdx != GL_INVALID_INDEX, Exception::GetExceptionCodeFromMeaning("NonexistentValue"), "Shader does not contain the Cacao Engine globals uniform block!")
+			CheckException(localUBOIdx != GL_INVALID_INDEX || nativeData->instanced, Exception::GetExceptionCodeFromMeaning("NonexistentValue"), "Shader does not contain the Cacao Engine locals uniform block!")
+
+			//Setup local UBO
+			glGenBuffers(1, &(nativeData->localsUBO));
+			glBindBuffer(GL_UNIFORM_BUFFER, nativeData->localsUBO);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+			//Link global UBO
+			glUniformBlockBinding(program, globalUBOIdx, globalsBinding);
+			glBindBufferBase(GL_UNIFORM_BUFFER, globalsBinding, globalsUBO);
+
+			//Link local UBO
+			//Every shader shares the same binding point, which the shader's own buffer is bound to when it is bound
+			if(localUBOIdx != GL_INVALID_INDEX) glUniformBlockBinding(program, localUBOIdx, localsBinding);
+
+			//Link custom data UBO under every name the stages declared it with (may have been optimized out even if the shader declares it)
+			for(const std::string& blockName : nativeData->blockNames) {
+				GLuint dataUBOIdx = glGetUniformBlockIndex(program, blockName.c_str());
+				if(dataUBOIdx != GL_INVALID_INDEX) glUniformBlockBinding(program, dataUBOIdx, shaderDataBinding);
+			}
 
-		//Detach and delete linked shaders
-		glDetachShader(program, compiledFragmentShader);
-		glDetachShader(program, compiledVertexShader);
-		glDeleteShader(compiledVertexShader);
-		glDeleteShader(compiledFragmentShader);
+			//Setup the buffer for data uploaded directly to this shader (materials bring their own)
+			if(nativeData->blockSize > 0) {
+				glGenBuffers(1, &(nativeData->blockUBO));
+				glBindBuffer(GL_UNIFORM_BUFFER, nativeData->blockUBO);
+				glBufferData(GL_UNIFORM_BUFFER, nativeData->blockSize, nativeData->block.data(), GL_DYNAMIC_DRAW);
+				glBindBuffer(GL_UNIFORM_BUFFER, 0);
+				nativeData->blockDirty = false;
+			}
 
-		//Setup local UBO
-		glGenBuffers(1, &(nativeData->localsUBO));
-		glBindBuffer(GL_UNIFORM_BUFFER, nativeData->localsUBO);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			//Point samplers at their texture slots, which never change
+			//Samplers that were optimized out are left alone, binding a texture for them is harmless
+			glUseProgram(program);
+			for(const UniformSlot& slot : nativeData->uniforms) {
+				if(slot.textureSlot == -1) continue;
+				GLint location = glGetUniformLocation(program, slot.name.c_str());
+				if(location != -1) glUniform1i(location, slot.textureSlot);
+			}
+			glUseProgram(0);
 
-		//Link global UBO
-		GLuint globalUBOIdx = glGetUniformBlockIndex(program, "CacaoGlobals");
-		CheckException(globalUBOIdx != GL_INVALID_INDEX, Exception::GetExceptionCodeFromMeaning("NonexistentValue"), "Shader does not contain the Cacao Engine globals uniform block!")
-		glUniformBlockBinding(program, globalUBOIdx, 0);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, globalsUBO);
+			//Set GPU ID and compiled values
+			nativeData->gpuID = program;
+			compiled = true;
+			nativeData->compiling = false;
+		};
 
-		//Link local UBO
-		GLuint localUBOIdx = glGetUniformBlockIndex(program, "CacaoLocals");
-		CheckException(localUBOIdx != GL_INVALID_INDEX, Exception::GetExceptionCodeFromMeaning("NonexistentValue"), "Shader does not contain the Cacao Engine locals uniform block!")
-		glUniformBlockBinding(program, localUBOIdx, ShaderData::uboIndexCounter);
-		glBindBufferBase(GL_UNIFORM_BUFFER, ShaderData::uboIndexCounter, nativeData->localsUBO);
+		if(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID()) {
+			//Whoever compiles on the render thread is about to use the shader, so wait for the driver
+			try {
+				GLuint program = LoadCachedProgram(nativeData->cacheKey);
+				if(program == 0) {
+					program = FinishProgram(SubmitProgram(nativeData->vertexCode, nativeData->fragmentCode));
+					StoreCachedProgram(nativeData->cacheKey, program);
+				}
+				finish(program);
+			} catch(...) {
+				nativeData->compiling = false;
+				throw;
+			}
 
-		//Increment UBO index counter
-		ShaderData::uboIndexCounter++;
-		if(ShaderData::uboIndexCounter == globalsUBO) ShaderData::uboIndexCounter++;
+			//Return an already completed future
+			std::promise<void> done;
+			done.set_value();
+			return done.get_future().share();
+		}
 
-		//Set GPU ID and compiled values
-		nativeData->gpuID = program;
-		compiled = true;
+		//Submit on the render thread, then check back on later frames until the driver is done so that it never has to wait
+		//The returned future is only fulfilled once the program is linked
+		std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+		InvokeGL([this, done, finish]() {
+			try {
+				//Use the cached program binary if there is one, otherwise build the program from source and cache it
+				GLuint cached = LoadCachedProgram(nativeData->cacheKey);
+				if(cached != 0) {
+					finish(cached);
+					done->set_value();
+					return;
+				}
 
-		//Return an empty future
-		return {};
+				PendingProgram pending = SubmitProgram(nativeData->vertexCode, nativeData->fragmentCode);
+				AddGLPoll([this, done, finish, pending]() {
+					if(!IsProgramReady(pending)) return false;
+					try {
+						GLuint program = FinishProgram(pending);
+						StoreCachedProgram(nativeData->cacheKey, program);
+						finish(program);
+						done->set_value();
+					} catch(...) {
+						nativeData->compiling = false;
+						done->set_exception(std::current_exception());
+					}
+					return true;
+				});
+			} catch(...) {
+				nativeData->compiling = false;
+				done->set_exception(std::current_exception());
+			}
+		});
+		return done->get_future().share();
 	}
 
 	void Shader::Release() {
@@ -297,15 +517,24 @@ namespace Cacao {
 		CheckException(!bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot release bound shader!");
 
 		glDeleteProgram(nativeData->gpuID);
+		glDeleteBuffers(1, &(nativeData->localsUBO));
+		if(nativeData->blockUBO != 0) glDeleteBuffers(1, &(nativeData->blockUBO));
+		nativeData->blockUBO = 0;
 		compiled = false;
 	}
 
+	bool Shader::IsInstanced() {
+		return nativeData->instanced;
+	}
+
 	void Shader::Bind() {
 		CheckException(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID(), Exception::GetExceptionCodeFromMeaning("RenderThread"), "Cannot bind shader in non-rendering thread!")
 		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot bind uncompiled shader!");
 		CheckException(!bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot bind bound shader!");
 
-		glUseProgram(nativeData->gpuID);
+		glState.UseProgram(nativeData->gpuID);
+		glState.BindUniformBuffer(localsBinding, nativeData->localsUBO, 0, sizeof(glm::mat4));
+		if(nativeData->blockUBO != 0) glState.BindUniformBuffer(shaderDataBinding, nativeData->blockUBO, 0, nativeData->blockSize);
 		bound = true;
 	}
 
@@ -315,11 +544,51 @@ namespace Cacao {
 		CheckException(bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot unbind unbound shader!");
 
 		//Clear current program
-		glUseProgram(0);
+		glState.ReleaseProgram();
 
 		bound = false;
 	}
 
+	void Shader::PrepareUploadData(ShaderUploadData& data) {
+		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot prepare data for uncompiled shader!")
+
+		for(ShaderUploadItem& item : data) {
+			if(item.layout == nativeData.get()) continue;
+
+			//Find the item in the layout
+			auto it = std::find_if(nativeData->uniforms.begin(), nativeData->uniforms.end(), [&item](const UniformSlot& slot) {
+				return slot.name == item.target;
+			});
+			CheckException(it != nativeData->uniforms.end(), Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Can't locate targeted item in shader specification!")
+
+			item.layout = nativeData.get();
+			item.layoutIndex = it - nativeData->uniforms.begin();
+		}
+	}
+
+	//Bind a texture from upload data to a texture slot
+	static void BindUploadTexture(std::any& data, int slot) {
+		if(data.type() == typeid(Texture2D*)) {
+			std::any_cast<Texture2D*>(data)->Bind(slot);
+		} else if(data.type() == typeid(Cubemap*)) {
+			std::any_cast<Cubemap*>(data)->Bind(slot);
+		} else if(data.type() == typeid(UIView*)) {
+			std::any_cast<UIView*>(data)->Bind(slot);
+		} else if(data.type() == typeid(AssetHandle<Texture2D>)) {
+			std::any_cast<AssetHandle<Texture2D>&>(data)->Bind(slot);
+		} else if(data.type() == typeid(AssetHandle<Cubemap>)) {
+			std::any_cast<AssetHandle<Cubemap>&>(data)->Bind(slot);
+		} else if(data.type() == typeid(AssetHandle<UIView>)) {
+			std::any_cast<AssetHandle<UIView>&>(data)->Bind(slot);
+		} else if(data.type() == typeid(RawGLTexture)) {
+			RawGLTexture& tex = std::any_cast<RawGLTexture&>(data);
+			glState.BindTexture(slot, GL_TEXTURE_2D, tex.texObj);
+			(*tex.slot) = slot;
+		} else {
+			CheckException(false, Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Non-texture value supplied to texture uniform!")
+		}
+	}
+
 	void Shader::UploadData(ShaderUploadData& data) {
 		if(std::this_thread::get_id() != Engine::GetInstance()->GetThreadID()) {
 			//Invoke OpenGL (ES) on the main thread
@@ -330,199 +599,48 @@ namespace Cacao {
 		}
 		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot upload data to uncompiled shader!")
 
-		//Create a map for quicker reference later
-		std::map<std::string, ShaderItemInfo> foundItems;
-		for(ShaderUploadItem& item : data) {
-			//Attempt to locate item in shader spec
-			bool found = false;
-			if(!foundItems.contains(item.target)) {
-				for(ShaderItemInfo sii : specification) {
-					foundItems.insert_or_assign(sii.entryName, sii);
-					if(sii.entryName.compare(item.target) == 0) {
-						found = true;
-						break;
-					}
-				}
-			}
-			CheckException(found, Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Can't locate targeted item in shader specification!")
+		//Resolve anything we haven't seen before
+		PrepareUploadData(data);
 
-			//Grab shader item info
-			ShaderItemInfo info = foundItems[item.target];
+		//Get ID of currently bound shader (to restore later)
+		//Only do this if we are not currently bound
+		GLint currentlyBound = -1;
+		if(!bound) {
+			glGetIntegerv(GL_CURRENT_PROGRAM, &currentlyBound);
 
-			//Obtain uniform location
-			std::stringstream ulocPath;
-			ulocPath << (info.type == SpvType::SampledImage ? "" : "shader.") << item.target;
-			GLint uniformLocation = glGetUniformLocation(nativeData->gpuID, ulocPath.str().c_str());
-			CheckException(uniformLocation != -1, Exception::GetExceptionCodeFromMeaning("NonexistentValue"), "Shader does not contain the requested uniform!")
-
-			//Confirm that spec does not contain types that aren't supported
-			UniformTypeCheckResponse res = CheckUniformType(info.type);
-			CheckException(res.ok, Exception::GetExceptionCodeFromMeaning("UnsupportedType"), res.err)
-
-			//Turn dimensions into single number (easier for uploading)
-			int dims = (4 * info.size.y) - (4 - info.size.x);
-			CheckException(!(info.size.x == 1 && info.size.y >= 2), Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Shaders cannot have data with one column and 2+ rows!")
-			CheckException(!(info.size.x > 1 && info.size.y > 1 && info.type != SpvType::Float && info.type != SpvType::Double), Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Shaders cannot have data with 2+ columns and rows that are not floats or doubles!")
+			//Bind shader
+			Bind();
+		}
 
-			//Get ID of currently bound shader (to restore later)
-			//Only do this if we are not currently bound
-			GLint currentlyBound = -1;
-			if(!bound) {
-				glGetIntegerv(GL_CURRENT_PROGRAM, &currentlyBound);
+		for(ShaderUploadItem& item : data) {
+			UniformSlot& slot = nativeData->uniforms[item.layoutIndex];
+			CheckException(slot.error.empty(), slot.errorCode, slot.error)
 
-				//Bind shader
-				Bind();
+			if(slot.textureSlot != -1) {
+				BindUploadTexture(item.data, slot.textureSlot);
+				continue;
 			}
 
-			int imageSlotCounter = 0;
+			//Write the value into our copy of the data block
+			const void* value = slot.paramType->extract(item.data);
+			CheckException(value, Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Failed cast of shader upload value to type specified in target!")
+			WriteBlockValue(nativeData->block.data(), slot, value);
+			nativeData->blockDirty = true;
+		}
 
-			//Attempt to cast data to correct type and upload it
-			//It is so annoying that this is how this must be done
-			try {
-				switch(info.type) {
-					case SpvType::Boolean:
-						switch(dims) {
-							case 1:
-								glUniform1i(uniformLocation, std::any_cast<bool>(item.data));
-								break;
-							case 2:
-								glUniform2iv(uniformLocation, 1, glm::value_ptr<int>(glm::ivec2(std::any_cast<glm::ivec2>(item.data))));
-								break;
-							case 3:
-								glUniform3iv(uniformLocation, 1, glm::value_ptr<int>(glm::ivec3(std::any_cast<glm::ivec3>(item.data))));
-								break;
-							case 4:
-								glUniform4iv(uniformLocation, 1, glm::value_ptr<int>(glm::ivec4(std::any_cast<glm::ivec4>(item.data))));
-								break;
-						}
-						break;
-					case SpvType::Int:
-						switch(dims) {
-							case 1:
-								glUniform1i(uniformLocation, std::any_cast<int>(item.data));
-								break;
-							case 2:
-								glUniform2iv(uniformLocation, 1, glm::value_ptr<int>(std::any_cast<glm::ivec2>(item.data)));
-								break;
-							case 3:
-								glUniform3iv(uniformLocation, 1, glm::value_ptr<int>(std::any_cast<glm::ivec3>(item.data)));
-								break;
-							case 4:
-								glUniform4iv(uniformLocation, 1, glm::value_ptr<int>(std::any_cast<glm::ivec4>(item.data)));
-								break;
-						}
-						break;
-					case SpvType::SampledImage:
-						//Confirm valid dimensions
-						CheckException(dims == 1, Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Shaders cannot have arrays or matrices of textures!")
-
-						//Bind texture to the next available slot
-						if(item.data.type() == typeid(Texture2D*)) {
-							Texture2D* tex = std::any_cast<Texture2D*>(item.data);
-							tex->Bind(imageSlotCounter);
-						} else if(item.data.type() == typeid(Cubemap*)) {
-							Cubemap* tex = std::any_cast<Cubemap*>(item.data);
-							tex->Bind(imageSlotCounter);
-						} else if(item.data.type() == typeid(UIView*)) {
-							UIView* view = std::any_cast<UIView*>(item.data);
-							view->Bind(imageSlotCounter);
-						} else if(item.data.type() == typeid(AssetHandle<Texture2D>)) {
-							AssetHandle<Texture2D> tex = std::any_cast<AssetHandle<Texture2D>>(item.data);
-							tex->Bind(imageSlotCounter);
-						} else if(item.data.type() == typeid(AssetHandle<Cubemap>)) {
-							AssetHandle<Cubemap> tex = std::any_cast<AssetHandle<Cubemap>>(item.data);
-							tex->Bind(imageSlotCounter);
-						} else if(item.data.type() == typeid(AssetHandle<UIView>)) {
-							AssetHandle<UIView> view = std::any_cast<AssetHandle<UIView>>(item.data);
-							view->Bind(imageSlotCounter);
-						} else if(item.data.type() == typeid(RawGLTexture)) {
-							glActiveTexture(GL_TEXTURE0 + imageSlotCounter);
-							RawGLTexture tex = std::any_cast<RawGLTexture>(item.data);
-							glBindTexture(GL_TEXTURE_2D, tex.texObj);
-							(*tex.slot) = imageSlotCounter;
-						} else {
-							CheckException(false, Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Non-texture value supplied to texture uniform!")
-						}
-
-						//Upload slot ID to shader
-						glUniform1i(uniformLocation, imageSlotCounter);
-
-						//Increment slot counter
-						imageSlotCounter++;
-						break;
-					case SpvType::UInt:
-						switch(dims) {
-							case 1:
-								glUniform1ui(uniformLocation, std::any_cast<unsigned int>(item.data));
-								break;
-							case 2:
-								glUniform2uiv(uniformLocation, 1, glm::value_ptr(std::any_cast<glm::uvec2>(item.data)));
-								break;
-							case 3:
-								glUniform3uiv(uniformLocation, 1, glm::value_ptr(std::any_cast<glm::uvec3>(item.data)));
-								break;
-							case 4:
-								glUniform4uiv(uniformLocation, 1, glm::value_ptr(std::any_cast<glm::uvec4>(item.data)));
-								break;
-						}
-						break;
-					case SpvType::Float:
-						switch(dims) {
-							case 1:
-								glUniform1f(uniformLocation, std::any_cast<float>(item.data));
-								break;
-							case 2:
-								glUniform2fv(uniformLocation, 1, glm::value_ptr(std::any_cast<glm::vec2>(item.data)));
-								break;
-							case 3:
-								glUniform3fv(uniformLocation, 1, glm::value_ptr(std::any_cast<glm::vec3>(item.data)));
-								break;
-							case 4:
-								glUniform4fv(uniformLocation, 1, glm::value_ptr(std::any_cast<glm::vec4>(item.data)));
-								break;
-							case 6:
-								glUniformMatrix2fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat2>(item.data)));
-								break;
-							case 7:
-								glUniformMatrix2x3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat2x3>(item.data)));
-								break;
-							case 8:
-								glUniformMatrix2x4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat2x4>(item.data)));
-								break;
-							case 10:
-								glUniformMatrix3x2fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat3x2>(item.data)));
-								break;
-							case 11:
-								glUniformMatrix3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat3>(item.data)));
-								break;
-							case 12:
-								glUniformMatrix3x4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat3x4>(item.data)));
-								break;
-							case 14:
-								glUniformMatrix4x2fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat4x2>(item.data)));
-								break;
-							case 15:
-								glUniformMatrix4x3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat4x3>(item.data)));
-								break;
-							case 16:
-								glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(std::any_cast<glm::mat4>(item.data)));
-								break;
-						}
-						break;
-					case SpvType::Double:
-					case SpvType::Int64:
-					case SpvType::UInt64:
-						Handle64BitTypes(uniformLocation, item, info, dims);
-				}
-			} catch(const std::bad_cast&) {
-				CheckException(false, Exception::GetExceptionCodeFromMeaning("UniformUploadFailure"), "Failed cast of shader upload value to type specified in target!")
-			}
+		//Upload the data block in one go if anything changed
+		if(nativeData->blockDirty) {
+			glBindBuffer(GL_UNIFORM_BUFFER, nativeData->blockUBO);
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, nativeData->blockSize, nativeData->block.data());
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			nativeData->blockDirty = false;
+		}
+		if(nativeData->blockUBO != 0) glState.BindUniformBuffer(shaderDataBinding, nativeData->blockUBO, 0, nativeData->blockSize);
 
-			//Restore previous shader (only if we weren't bound before)
-			if(currentlyBound != -1) {
-				Unbind();
-				glUseProgram(currentlyBound);
-			}
+		//Restore previous shader (only if we weren't bound before)
+		if(currentlyBound != -1) {
+			Unbind();
+			glState.UseProgram(currentlyBound);
 		}
 	}
 
@@ -0,0 +1,267 @@
+#include "GLShaderCache.hpp"
+#include "Core/Engine.hpp"
+#include "Core/Log.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <functional>
+#include <cstring>
+
+namespace Cacao {
+	//Cache file layout: a header, then the payload
+	//The payload is hashed so that damaged or half-written files are ignored
+	struct CacheFileHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t payloadSize, payloadHash;
+	};
+	constexpr char glslMagic[4] = {'C', 'G', 'L', 'S'};
+	constexpr char programMagic[4] = {'C', 'P', 'R', 'G'};
+
+	//Bump this whenever the GLSL generated from the same SPIR-V changes
+	constexpr uint32_t cacheVersion = 2;
+
+#ifdef ES
+	constexpr const char* backendName = "gles";
+#else
+	constexpr const char* backendName = "gl";
+#endif
+
+	//64-bit FNV-1a
+	static uint64_t Hash(const void* data, std::size_t size, uint64_t hash = 0xCBF29CE484222325ull) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for(std::size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	static std::string Hex(uint64_t value) {
+		std::stringstream hex;
+		hex << std::hex << std::setw(16) << std::setfill('0') << value;
+		return hex.str();
+	}
+
+	//Get the path of a cache entry (empty if the cache is disabled)
+	static std::filesystem::path CachePath(const std::string& name) {
+		const std::string& dir = Engine::GetInstance()->cfg.shaderCacheDir;
+		if(dir.empty()) return {};
+		return std::filesystem::path(dir) / name;
+	}
+
+	//Payload writing and reading (reads fail once the payload runs out)
+	template<typename T>
+	static void Put(std::vector<char>& out, const T& value) {
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+	static void PutString(std::vector<char>& out, const std::string& str) {
+		Put<uint64_t>(out, str.size());
+		out.insert(out.end(), str.begin(), str.end());
+	}
+	struct PayloadReader {
+		const std::vector<char>& data;
+		std::size_t pos = 0;
+
+		template<typename T>
+		bool Get(T& value) {
+			if(data.size() - pos < sizeof(T)) return false;
+			std::memcpy(&value, data.data() + pos, sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+
+		bool GetString(std::string& str) {
+			uint64_t size;
+			if(!Get(size) || data.size() - pos < size) return false;
+			str.assign(data.data() + pos, size);
+			pos += size;
+			return true;
+		}
+	};
+
+	static bool ReadCacheFile(const std::filesystem::path& path, const char (&magic)[4], std::vector<char>& payload) {
+		std::error_code ec;
+		uint64_t fileSize = std::filesystem::file_size(path, ec);
+		if(ec || fileSize < sizeof(CacheFileHeader)) return false;
+
+		std::ifstream in(path, std::ios::binary);
+		CacheFileHeader header;
+		if(!in.read(reinterpret_cast<char*>(&header), sizeof(CacheFileHeader))) return false;
+		if(std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != cacheVersion || header.payloadSize != fileSize - sizeof(CacheFileHeader)) return false;
+
+		payload.resize(header.payloadSize);
+		if(!in.read(payload.data(), payload.size())) return false;
+		return Hash(payload.data(), payload.size()) == header.payloadHash;
+	}
+
+	static void WriteCacheFile(const std::filesystem::path& path, const char (&magic)[4], const std::vector<char>& payload) {
+		CacheFileHeader header {};
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = cacheVersion;
+		header.payloadSize = payload.size();
+		header.payloadHash = Hash(payload.data(), payload.size());
+
+		//Write to a temporary file (one per thread) first so that nobody reads a half-written entry
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+		std::filesystem::path tempPath = path;
+		tempPath += "." + std::to_string(std::hash<std::thread::id> {}(std::this_thread::get_id())) + ".tmp";
+		bool written = false;
+		{
+			std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(&header), sizeof(CacheFileHeader));
+			out.write(payload.data(), payload.size());
+			written = out.good();
+		}
+		if(written) std::filesystem::rename(tempPath, path, ec);
+		if(!written || ec) {
+			std::filesystem::remove(tempPath, ec);
+			Logging::EngineLog("Failed to write shader cache entry \"" + path.string() + "\"!", LogLevel::Warn);
+		}
+	}
+
+	uint64_t HashShaderSource(const std::vector<uint32_t>& vertex, const std::vector<uint32_t>& fragment) {
+		uint64_t hash = Hash(backendName, std::strlen(backendName));
+		hash = Hash(&cacheVersion, sizeof(cacheVersion), hash);
+		uint64_t sizes[2] = {vertex.size(), fragment.size()};
+		hash = Hash(sizes, sizeof(sizes), hash);
+		hash = Hash(vertex.data(), vertex.size() * sizeof(uint32_t), hash);
+		return Hash(fragment.data(), fragment.size() * sizeof(uint32_t), hash);
+	}
+
+	bool LoadCachedGLSL(uint64_t key, GeneratedShader& out) {
+		std::filesystem::path path = CachePath(Hex(key) + ".glsl");
+		std::vector<char> payload;
+		if(path.empty() || !ReadCacheFile(path, glslMagic, payload)) return false;
+
+		PayloadReader reader {payload};
+		uint8_t instanced;
+		uint64_t blockSize, memberCount;
+		if(!reader.Get(instanced) || !reader.Get(blockSize) || !reader.Get(memberCount)) return false;
+		GeneratedShader shader;
+		shader.instanced = instanced;
+		shader.block.size = blockSize;
+		for(uint64_t i = 0; i < memberCount; i++) {
+			std::string name;
+			uint64_t offset, matrixStride;
+			if(!reader.GetString(name) || !reader.Get(offset) || !reader.Get(matrixStride)) return false;
+			shader.block.members.insert_or_assign(name, BlockMember {.offset = offset, .matrixStride = matrixStride});
+		}
+		uint64_t nameCount;
+		if(!reader.Get(nameCount)) return false;
+		for(uint64_t i = 0; i < nameCount; i++) {
+			if(!reader.GetString(shader.block.names.emplace_back())) return false;
+		}
+		if(!reader.GetString(shader.vertexCode) || !reader.GetString(shader.fragmentCode)) return false;
+
+		out = std::move(shader);
+		return true;
+	}
+
+	void StoreCachedGLSL(uint64_t key, const GeneratedShader& shader) {
+		std::filesystem::path path = CachePath(Hex(key) + ".glsl");
+		if(path.empty()) return;
+
+		std::vector<char> payload;
+		Put<uint8_t>(payload, shader.instanced);
+		Put<uint64_t>(payload, shader.block.size);
+		Put<uint64_t>(payload, shader.block.members.size());
+		for(const auto& [name, member] : shader.block.members) {
+			PutString(payload, name);
+			Put<uint64_t>(payload, member.offset);
+			Put<uint64_t>(payload, member.matrixStride);
+		}
+		Put<uint64_t>(payload, shader.block.names.size());
+		for(const std::string& name : shader.block.names) {
+			PutString(payload, name);
+		}
+		PutString(payload, shader.vertexCode);
+		PutString(payload, shader.fragmentCode);
+		WriteCacheFile(path, glslMagic, payload);
+	}
+
+	//Hash of the driver, as program binaries only work with the driver that made them
+	static uint64_t DriverHash() {
+		static const uint64_t hash = []() {
+			uint64_t driver = Hash(backendName, std::strlen(backendName));
+			for(GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+				const char* str = reinterpret_cast<const char*>(glGetString(name));
+				if(str) driver = Hash(str, std::strlen(str), driver);
+				driver = Hash("\n", 1, driver);
+			}
+			return driver;
+		}();
+		return hash;
+	}
+
+	//Some drivers support program binaries but don't have any formats to give them out in
+	static bool ProgramBinariesSupported() {
+		static const bool supported = []() {
+			GLint formats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			return formats > 0;
+		}();
+		return supported;
+	}
+
+	GLuint LoadCachedProgram(uint64_t key) {
+		if(!ProgramBinariesSupported()) return 0;
+		std::filesystem::path path = CachePath(Hex(key) + "-" + Hex(DriverHash()) + ".bin");
+		std::vector<char> payload;
+		if(path.empty() || !ReadCacheFile(path, programMagic, payload)) return 0;
+
+		PayloadReader reader {payload};
+		uint32_t format;
+		if(!reader.Get(format)) return 0;
+
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, format, payload.data() + reader.pos, payload.size() - reader.pos);
+
+		//Drivers may reject binaries even with the same version string, in which case the caller compiles from source and replaces the entry
+		GLint linkStatus;
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+		if(linkStatus == GL_FALSE) {
+			glDeleteProgram(program);
+			Logging::EngineLog("Driver rejected cached program binary \"" + path.string() + "\", compiling from source", LogLevel::Trace);
+			return 0;
+		}
+		return program;
+	}
+
+	void StoreCachedProgram(uint64_t key, GLuint program) {
+		if(!ProgramBinariesSupported()) return;
+		std::filesystem::path path = CachePath(Hex(key) + "-" + Hex(DriverHash()) + ".bin");
+		if(path.empty()) return;
+
+		//Get the binary, putting the format in front of it
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if(length <= 0) return;
+		std::vector<char> payload;
+		Put<uint32_t>(payload, 0);
+		std::size_t start = payload.size();
+		payload.resize(start + length);
+		GLenum format = 0;
+		GLsizei written = 0;
+		glGetProgramBinary(program, length, &written, &format, payload.data() + start);
+		if(written <= 0) return;
+		payload.resize(start + written);
+		uint32_t storedFormat = format;
+		std::memcpy(payload.data(), &storedFormat, sizeof(uint32_t));
+
+		//Write it out off the render thread if possible
+		std::shared_ptr<thread_pool> pool = Engine::GetInstance()->GetThreadPool();
+		if(pool) {
+			pool->enqueue_detach([path, payload = std::move(payload)]() {
+				WriteCacheFile(path, programMagic, payload);
+			});
+		} else {
+			WriteCacheFile(path, programMagic, payload);
+		}
+	}
+}
@@ -3,8 +3,13 @@
 #include "Core/Log.hpp"
 #include "Core/Engine.hpp"
 #include "Core/Exception.hpp"
+#include "Utilities/VFS.hpp"
 #include "GLTexture2DData.hpp"
 #include "GLUtils.hpp"
+#include "GLStateCache.hpp"
+#include "GLTextureUploader.hpp"
+#include "GLTextureStreamer.hpp"
+#include "Graphics/Textures/CookedTexture.hpp"
 
 #include "stb_image.h"
 
@@ -12,74 +17,195 @@
 
 #include <future>
 #include <filesystem>
+#include <memory>
+#include <vector>
+#include <climits>
 
 namespace Cacao {
+	//An image ready to upload
+	struct LoadedImage {
+		std::shared_ptr<CookedTexture> cooked;//If the image has a cooked texture, its mapping (with the whole mip chain)
+		std::shared_ptr<const unsigned char> pixels;//Otherwise, the decoded image
+		glm::ivec2 size;
+		int channels;
+		GLenum format;
+	};
+
+	//Map an image's cooked texture if it has one, and decode it (flipped for OpenGL (ES)) otherwise
+	static LoadedImage LoadImage(const std::string& filePath) {
+		LoadedImage image;
+		bool srgb = true;
+		image.cooked = CookedTexture::Find(filePath);
+		if(image.cooked) {
+			image.size = image.cooked->GetSize();
+			image.channels = image.cooked->GetChannels();
+			srgb = image.cooked->IsSRGB();
+		} else {
+			//Ensure stb_image flips image Y (because OpenGL)
+			//Only set for this thread, as other threads may be decoding other images
+			stbi_set_flip_vertically_on_load_thread(true);
+
+			//Load image
+			std::shared_ptr<MappedFile> file = VFS::GetInstance()->Open(filePath);
+			CheckException(file->GetSize() <= INT_MAX, Exception::GetExceptionCodeFromMeaning("IO"), "2D texture image file is too large to load!")
+			unsigned char* pixels = stbi_load_from_memory(file->GetData(), int(file->GetSize()), &image.size.x, &image.size.y, &image.channels, 0);
+
+			CheckException(pixels, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load 2D texture image file!")
+
+			image.pixels.reset(pixels, stbi_image_free);
+		}
+
+		//Determine image format
+		if(image.channels == 1) {
+			image.format = GL_RED;
+		} else if(image.channels == 3) {
+			image.format = (srgb ? GL_SRGB8 : GL_RGB8);
+		} else if(image.channels == 4) {
+			image.format = (srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8);
+		}
+		return image;
+	}
+
 	Texture2D::Texture2D(std::string filePath)
 	  : Texture(false) {
 		//Create native data
 		nativeData.reset(new Tex2DData());
-
-		//Ensure stb_image flips image Y (because OpenGL)
-		stbi_set_flip_vertically_on_load(true);
+		nativeData->filePath = filePath;
+		nativeData->stream = std::make_shared<StreamedTexture>();
 
 		//Load image
-		dataBuffer = stbi_load(filePath.c_str(), &imgSize.x, &imgSize.y, &numImgChannels, 0);
-
-		CheckException(dataBuffer, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load 2D texture image file!")
+		LoadedImage image = LoadImage(filePath);
+		nativeData->cooked = image.cooked;
+		nativeData->pixels = image.pixels;
+		nativeData->format = image.format;
+		imgSize = image.size;
+		numImgChannels = image.channels;
+		nativeData->cpuBytes = (image.pixels ? std::size_t(imgSize.x) * imgSize.y * numImgChannels : 0);
 
 		bound = false;
 		currentSlot = -1;
-
-		//Determine image format
-		if(numImgChannels == 1) {
-			nativeData->format = GL_RED;
-		} else if(numImgChannels == 3) {
-			nativeData->format = GL_SRGB8;
-		} else if(numImgChannels == 4) {
-			nativeData->format = GL_SRGB8_ALPHA8;
-		}
 	}
 
 	std::shared_future<void> Texture2D::Compile() {
-		if(std::this_thread::get_id() != Engine::GetInstance()->GetThreadID()) {
-			//Invoke OpenGL (ES) on the main thread
-			return InvokeGL([this]() {
-				this->Compile();
-			});
-		}
-		CheckException(!compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot compile compiled texture!");
+		std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+		std::shared_future<void> uploaded = done->get_future().share();
 
-		//Create texture object
-		glGenTextures(1, &(nativeData->gpuID));
+		//Creates the texture and starts streaming the image into it (on the render thread)
+		auto startUpload = [this, done]() {
+			CheckException(!compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot compile compiled texture!");
 
-		//Bind texture object so we can work on it
-		glBindTexture(GL_TEXTURE_2D, nativeData->gpuID);
+			//The image is let go of once uploaded, so load it again if this texture was released and is being recompiled
+			if(!nativeData->pixels && !nativeData->cooked) {
+				LoadedImage image = LoadImage(nativeData->filePath);
+				nativeData->cooked = image.cooked;
+				nativeData->pixels = image.pixels;
+				nativeData->format = image.format;
+				imgSize = image.size;
+				numImgChannels = image.channels;
+				nativeData->cpuBytes = (image.pixels ? std::size_t(imgSize.x) * imgSize.y * numImgChannels : 0);
+			}
 
-		//Load image data into texture object
-		glTexImage2D(GL_TEXTURE_2D, 0, nativeData->format, imgSize.x, imgSize.y, 0, GetTextureMemoryFormat(nativeData->format), GL_UNSIGNED_BYTE, dataBuffer);
+			//Cooked textures come with their whole mip chain, while decoded images only have the full-size level and get mipmaps generated once it's uploaded
+			GLenum memoryFormat = GetTextureMemoryFormat(nativeData->format);
+			std::vector<TextureUpload> levels;
+			auto addLevel = [this, &levels, memoryFormat](GLint level, glm::ivec2 size, std::shared_ptr<const unsigned char> pixels) {
+				levels.push_back({.texture = nativeData->gpuID, .target = GL_TEXTURE_2D, .image = GL_TEXTURE_2D, .level = level, .size = size, .format = memoryFormat, .type = GL_UNSIGNED_BYTE, .pixelSize = std::size_t(numImgChannels), .pixels = pixels});
+			};
+			bool generateMipmaps = !nativeData->cooked;
 
-		//Apply texture mipmap filtering
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			//Large cooked textures start out with only their small levels, and the texture streamer brings in the rest as they're drawn bigger
+			int firstLevel = (nativeData->cooked ? GetStreamingFloor(*nativeData->cooked) : 0);
+			int maxLevel = (nativeData->cooked ? int(nativeData->cooked->GetLevels().size()) - 1 : 10);
 
-		//Configure mipmap levels
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 10);
+			//Create texture object
+			glGenTextures(1, &(nativeData->gpuID));
 
-		//Generate mipmaps for texture
-		glGenerateMipmap(GL_TEXTURE_2D);
+			if(nativeData->cooked) {
+				const std::vector<CookedTexture::Level>& cookedLevels = nativeData->cooked->GetLevels();
+				for(std::size_t i = firstLevel; i < cookedLevels.size(); i++) {
+					//Point into the mapping, keeping it alive until the level is uploaded
+					addLevel(i, cookedLevels[i].size, std::shared_ptr<const unsigned char>(nativeData->cooked, cookedLevels[i].data));
+				}
+			} else {
+				addLevel(0, imgSize, nativeData->pixels);
+			}
 
-		//Configure texture wrapping mode
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			//Bind texture object so we can work on it
+			glBindTexture(GL_TEXTURE_2D, nativeData->gpuID);
 
-		//Unbind texture object since we're done with it for now
-		glBindTexture(GL_TEXTURE_2D, 0);
+			//Allocate storage for each level, which the texture uploader fills in over the next frames
+			std::size_t gpuBytes = 0;
+			for(const TextureUpload& level : levels) {
+				glTexImage2D(GL_TEXTURE_2D, level.level, nativeData->format, level.size.x, level.size.y, 0, memoryFormat, GL_UNSIGNED_BYTE, nullptr);
+				gpuBytes += std::size_t(level.size.x) * level.size.y * numImgChannels;
+			}
 
-		compiled = true;
+			//Generated mipmaps add about a third on top of the full-size level
+			if(generateMipmaps) gpuBytes += gpuBytes / 3;
+			nativeData->gpuBytes = gpuBytes;
 
-		//Return an empty future
-		return {};
+			//Apply texture mipmap filtering
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+			//Configure mipmap levels
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+
+			//Configure texture wrapping mode
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+			//Unbind texture object since we're done with it for now
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			//Stream the levels in, finishing up once the last one lands
+			nativeData->upload = done;
+			std::shared_ptr<std::size_t> remaining = std::make_shared<std::size_t>(levels.size());
+			for(TextureUpload& level : levels) {
+				QueueTextureUpload(std::move(level), [data = nativeData, remaining, generateMipmaps, firstLevel]() {
+					if(--*remaining > 0) return;
+
+					//Now that the whole image is there, generate mipmaps for texture if needed and let go of the CPU copy
+					if(generateMipmaps) {
+						glBindTexture(GL_TEXTURE_2D, data->gpuID);
+						glGenerateMipmap(GL_TEXTURE_2D);
+						glBindTexture(GL_TEXTURE_2D, 0);
+					}
+
+					//Streamed textures hand the cooked texture over to the streamer, which uploads the rest of the levels from it
+					if(firstLevel > 0) {
+						data->stream->texture = data->gpuID;
+						data->stream->format = data->format;
+						data->stream->source = data->cooked;
+						data->stream->floorLevel = firstLevel;
+						RegisterStreamedTexture(data->stream);
+					}
+					data->pixels.reset();
+					data->cooked.reset();
+					data->cpuBytes = 0;
+
+					std::shared_ptr<std::promise<void>> upload = std::move(data->upload);
+					upload->set_value();
+				});
+			}
+
+			compiled = true;
+		};
+
+		if(std::this_thread::get_id() != Engine::GetInstance()->GetThreadID()) {
+			//Start the upload on the main thread, handing any exception back through the future
+			InvokeGL([startUpload, done]() {
+				try {
+					startUpload();
+				} catch(...) {
+					done->set_exception(std::current_exception());
+				}
+			});
+			return uploaded;
+		}
+		startUpload();
+		return uploaded;
 	}
 
 	void Texture2D::Release() {
@@ -97,10 +223,30 @@ namespace Cacao {
 		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot release uncompiled texture!");
 		CheckException(!bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot release bound texture!");
 
+		//Stop the upload if it's still going, letting whoever is waiting on it know
+		if(nativeData->upload) {
+			CancelTextureUploads(nativeData->gpuID);
+			nativeData->upload->set_exception(std::make_exception_ptr(Exception {"Texture was released before it finished uploading!", Exception::GetExceptionCodeFromMeaning("BadCompileState")}));
+			nativeData->upload.reset();
+		}
+
+		//Stop streaming levels in and let go of the cooked texture
+		UnregisterStreamedTexture(nativeData->stream);
+		nativeData->stream->source.reset();
+
 		glDeleteTextures(1, &(nativeData->gpuID));
+		nativeData->gpuBytes = 0;
 		compiled = false;
 	}
 
+	AssetMemoryUsage Texture2D::GetMemoryUsage() {
+		return {.cpu = nativeData->cpuBytes, .gpu = nativeData->gpuBytes + nativeData->stream->streamedBytes};
+	}
+
+	void Texture2D::RequestDetail(float screenSize) {
+		RequestStreamedDetail(*(nativeData->stream), screenSize);
+	}
+
 	void Texture2D::Bind(int slot) {
 		CheckException(std::this_thread::get_id() == Engine::GetInstance()->GetThreadID(), Exception::GetExceptionCodeFromMeaning("RenderThread"), "Cannot bind texture in non-rendering thread!")
 		CheckException(compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot bind uncompiled texture!");
@@ -108,8 +254,7 @@ namespace Cacao {
 
 		//Bind the texture to the requested slot
 		currentSlot = slot;
-		glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTexture(GL_TEXTURE_2D, nativeData->gpuID);
+		glState.BindTexture(slot, GL_TEXTURE_2D, nativeData->gpuID);
 		bound = true;
 	}
 
@@ -119,8 +264,7 @@ namespace Cacao {
 		CheckException(bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot unbind unbound texture!");
 
 		//Unbind the texture from its current slot
-		glActiveTexture(GL_TEXTURE0 + currentSlot);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		glState.ReleaseTexture(currentSlot, GL_TEXTURE_2D);
 		currentSlot = -1;
 		bound = false;
 	}
@@ -0,0 +1,152 @@
+#include "GLTextureStreamer.hpp"
+#include "GLTextureUploader.hpp"
+#include "GLUtils.hpp"
+#include "Core/Engine.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace Cacao {
+	//Levels at most this many pixels across are always resident
+	constexpr int floorSize = 64;
+
+	static std::vector<std::shared_ptr<StreamedTexture>> streamed;
+
+	//Bytes of levels above the floors that are resident or being uploaded
+	static std::size_t residentBytes = 0;
+
+	//Frames the streamer has seen, for telling how recently textures were drawn
+	static uint64_t frameCounter = 0;
+
+	//Textures that want another level this frame (kept to reuse its storage)
+	static std::vector<std::shared_ptr<StreamedTexture>> loads;
+
+	static std::size_t LevelBytes(const StreamedTexture& texture, int level) {
+		return texture.source->GetLevels()[level].bytes;
+	}
+
+	int GetStreamingFloor(const CookedTexture& source) {
+		const std::vector<CookedTexture::Level>& levels = source.GetLevels();
+		int floor = 0;
+		while(floor + 1 < int(levels.size()) && std::max(levels[floor].size.x, levels[floor].size.y) > floorSize) floor++;
+		return floor;
+	}
+
+	void RegisterStreamedTexture(std::shared_ptr<StreamedTexture> texture) {
+		texture->residentLevel = texture->wantedLevel = texture->floorLevel;
+		texture->pendingLevel = -1;
+		texture->lastUsed = frameCounter;
+		texture->registered = true;
+		streamed.push_back(texture);
+	}
+
+	void UnregisterStreamedTexture(const std::shared_ptr<StreamedTexture>& texture) {
+		if(!texture->registered) return;
+		CancelTextureUploads(texture->texture);
+		for(int level = texture->residentLevel; level < texture->floorLevel; level++) {
+			residentBytes -= LevelBytes(*texture, level);
+		}
+		if(texture->pendingLevel >= 0) residentBytes -= LevelBytes(*texture, texture->pendingLevel);
+		texture->pendingLevel = -1;
+		texture->streamedBytes = 0;
+		texture->registered = false;
+		std::erase(streamed, texture);
+	}
+
+	//Drop a texture's most detailed level
+	static void EvictLevel(StreamedTexture& texture) {
+		int level = texture.residentLevel++;
+		glBindTexture(GL_TEXTURE_2D, texture.texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.residentLevel);
+
+		//Respecifying the level as empty lets the driver free its memory
+		glTexImage2D(GL_TEXTURE_2D, level, texture.format, 0, 0, 0, GetTextureMemoryFormat(texture.format), GL_UNSIGNED_BYTE, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		residentBytes -= LevelBytes(texture, level);
+		texture.streamedBytes -= LevelBytes(texture, level);
+	}
+
+	//Start uploading the level above a texture's most detailed one, which is sampled once it's all there
+	static void LoadLevel(const std::shared_ptr<StreamedTexture>& texture) {
+		int level = texture->residentLevel - 1;
+		const CookedTexture::Level& data = texture->source->GetLevels()[level];
+		GLenum memoryFormat = GetTextureMemoryFormat(texture->format);
+		glBindTexture(GL_TEXTURE_2D, texture->texture);
+		glTexImage2D(GL_TEXTURE_2D, level, texture->format, data.size.x, data.size.y, 0, memoryFormat, GL_UNSIGNED_BYTE, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		texture->pendingLevel = level;
+		residentBytes += data.bytes;
+		texture->streamedBytes += data.bytes;
+
+		QueueTextureUpload({.texture = texture->texture, .target = GL_TEXTURE_2D, .image = GL_TEXTURE_2D, .level = level, .size = data.size, .format = memoryFormat, .type = GL_UNSIGNED_BYTE, .pixelSize = std::size_t(texture->source->GetChannels()), .pixels = std::shared_ptr<const unsigned char>(texture->source, data.data)},
+			[texture, level]() {
+				texture->pendingLevel = -1;
+				texture->residentLevel = level;
+				glBindTexture(GL_TEXTURE_2D, texture->texture);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			});
+	}
+
+	//Find the texture to take a level from to make room for another, or nullptr if none can spare one
+	//Textures not drawn this frame can always spare their levels above the floor, and drawn ones can spare detail they don't want
+	//Of those, the least recently drawn goes first, and the largest level breaks ties
+	static StreamedTexture* PickVictim(const StreamedTexture* requester) {
+		StreamedTexture* victim = nullptr;
+		for(const std::shared_ptr<StreamedTexture>& texture : streamed) {
+			if(texture.get() == requester || texture->pendingLevel >= 0 || texture->residentLevel >= texture->floorLevel) continue;
+			if(texture->lastUsed == frameCounter && texture->residentLevel >= texture->wantedLevel) continue;
+			if(!victim || texture->lastUsed < victim->lastUsed || (texture->lastUsed == victim->lastUsed && texture->residentLevel < victim->residentLevel)) victim = texture.get();
+		}
+		return victim;
+	}
+
+	void PumpTextureStreaming() {
+		if(streamed.empty()) return;
+		frameCounter++;
+		const std::size_t budget = Engine::GetInstance()->cfg.textureMemoryBudget;
+
+		//Work out the level each texture wants from how large it was drawn
+		//Textures nobody asked about keep what they last wanted, since the render loop can run more often than frames are gathered
+		loads.clear();
+		for(const std::shared_ptr<StreamedTexture>& texture : streamed) {
+			float screenSize = texture->demand.exchange(0.0f, std::memory_order_relaxed);
+			if(screenSize > 0.0f) {
+				//A level has enough detail once it has at least as many texels across as there are pixels
+				glm::ivec2 fullSize = texture->source->GetSize();
+				float texelsPerPixel = std::max(fullSize.x, fullSize.y) / screenSize;
+				texture->wantedLevel = std::clamp(int(std::floor(std::log2(std::max(texelsPerPixel, 1.0f)))), 0, texture->floorLevel);
+				texture->lastUsed = frameCounter;
+			}
+			if(texture->pendingLevel < 0 && texture->wantedLevel < texture->residentLevel) loads.push_back(texture);
+		}
+
+		//Serve the textures furthest from the detail they want first
+		std::sort(loads.begin(), loads.end(), [](const std::shared_ptr<StreamedTexture>& a, const std::shared_ptr<StreamedTexture>& b) {
+			return (a->residentLevel - a->wantedLevel) > (b->residentLevel - b->wantedLevel);
+		});
+		for(const std::shared_ptr<StreamedTexture>& texture : loads) {
+			std::size_t bytes = LevelBytes(*texture, texture->residentLevel - 1);
+			while(residentBytes + bytes > budget) {
+				StreamedTexture* victim = PickVictim(texture.get());
+				if(!victim) break;
+				EvictLevel(*victim);
+			}
+
+			//If nothing else can give up a level, everything left has to wait for something to stop being drawn
+			if(residentBytes + bytes > budget) break;
+			LoadLevel(texture);
+		}
+		loads.clear();
+	}
+
+	void ShutdownTextureStreaming() {
+		for(const std::shared_ptr<StreamedTexture>& texture : streamed) {
+			texture->registered = false;
+			texture->streamedBytes = 0;
+		}
+		streamed.clear();
+		residentBytes = 0;
+	}
+}
@@ -0,0 +1,204 @@
+#include "GLTextureUploader.hpp"
+#include "Core/Engine.hpp"
+#include "Core/Log.hpp"
+#include "Graphics/Rendering/RenderController.hpp"
+
+#include <array>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+
+namespace Cacao {
+	//Ring layout (a buffer grows if a single row doesn't fit in it)
+	constexpr std::size_t ringSlotCount = 4;
+	constexpr std::size_t ringSlotSize = 4 * 1024 * 1024;
+
+	struct UploadJob {
+		TextureUpload upload;
+		std::function<void()> onDone;
+		int nextRow = 0;				//First row not handed to a slot yet
+		unsigned int chunksInFlight = 0;//Chunks handed to slots that haven't been fenced yet
+		bool cancelled = false;
+	};
+
+	//A buffer in the ring
+	struct RingSlot {
+		enum class State {
+			Free,	//Ready to be mapped
+			Filling,//Mapped, and being filled by the thread pool
+			Copying //Copied into its texture, waiting on the fence
+		};
+
+		GLuint pbo = 0;
+		std::size_t capacity = 0;
+		State state = State::Free;
+		std::atomic<bool> filled {false};
+		GLsync fence = nullptr;
+
+		//The rows of the job this slot holds
+		std::shared_ptr<UploadJob> job;
+		int firstRow = 0, rows = 0;
+	};
+
+	static std::array<RingSlot, ringSlotCount> ring;
+
+	//Jobs with rows left to hand out, oldest first
+	static std::deque<std::shared_ptr<UploadJob>> jobs;
+
+	static std::size_t RowSize(const TextureUpload& upload) {
+		return std::size_t(upload.size.x) * upload.pixelSize;
+	}
+
+	//Copy rows into a texture from whatever is bound to GL_PIXEL_UNPACK_BUFFER (or from client memory if nothing is)
+	static void CopyRows(const TextureUpload& upload, int firstRow, int rows, const void* source) {
+		//Rows are tightly packed, which the default alignment of 4 doesn't allow for (e.g. RGB)
+		GLint alignment;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		glBindTexture(upload.target, upload.texture);
+		glTexSubImage2D(upload.image, upload.level, 0, firstRow, upload.size.x, rows, upload.format, upload.type, source);
+		glBindTexture(upload.target, 0);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+	}
+
+	//Finish a job if every row has been copied and fenced
+	static void FinishIfDone(const std::shared_ptr<UploadJob>& job) {
+		if(job->cancelled || job->chunksInFlight > 0 || job->nextRow < job->upload.size.y) return;
+		job->upload.pixels.reset();
+		job->onDone();
+	}
+
+	void QueueTextureUpload(TextureUpload upload, std::function<void()> onDone) {
+		std::shared_ptr<UploadJob> job = std::make_shared<UploadJob>();
+		job->upload = std::move(upload);
+		job->onDone = std::move(onDone);
+		jobs.push_back(job);
+	}
+
+	void CancelTextureUploads(GLuint texture) {
+		//Slots holding rows of cancelled jobs still go through the ring so their buffers are unmapped and fenced, but skip the copy
+		for(const std::shared_ptr<UploadJob>& job : jobs) {
+			if(job->upload.texture == texture) job->cancelled = true;
+		}
+		for(RingSlot& slot : ring) {
+			if(slot.job && slot.job->upload.texture == texture) slot.job->cancelled = true;
+		}
+		std::erase_if(jobs, [](const std::shared_ptr<UploadJob>& job) { return job->cancelled; });
+	}
+
+	void PumpTextureUploads() {
+		//Free the slots whose copies the GPU has finished
+		for(RingSlot& slot : ring) {
+			if(slot.state != RingSlot::State::Copying) continue;
+			if(glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) continue;
+			glDeleteSync(slot.fence);
+			slot.fence = nullptr;
+			slot.state = RingSlot::State::Free;
+
+			std::shared_ptr<UploadJob> job = std::move(slot.job);
+			job->chunksInFlight--;
+			FinishIfDone(job);
+		}
+
+		//Copy the slots the thread pool has filled into their textures
+		for(RingSlot& slot : ring) {
+			if(slot.state != RingSlot::State::Filling || !slot.filled.load(std::memory_order_acquire)) continue;
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+			bool intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+			if(!slot.job->cancelled) {
+				if(intact) {
+					CopyRows(slot.job->upload, slot.firstRow, slot.rows, nullptr);
+				} else {
+					//The buffer's contents were lost while it was mapped (which drivers may do on e.g. a display mode change), so copy from the pixels instead
+					glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+					CopyRows(slot.job->upload, slot.firstRow, slot.rows, slot.job->upload.pixels.get() + slot.firstRow * RowSize(slot.job->upload));
+				}
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			slot.state = RingSlot::State::Copying;
+		}
+
+		//Hand out rows to free slots until the budget runs out
+		std::size_t budget = Engine::GetInstance()->cfg.textureUploadBudget, spent = 0;
+		std::shared_ptr<thread_pool> pool = Engine::GetInstance()->GetThreadPool();
+		for(RingSlot& slot : ring) {
+			if(slot.state != RingSlot::State::Free) continue;
+			while(!jobs.empty() && jobs.front()->nextRow == jobs.front()->upload.size.y) jobs.pop_front();
+			if(jobs.empty()) break;
+			std::shared_ptr<UploadJob> job = jobs.front();
+			const TextureUpload& upload = job->upload;
+			std::size_t rowSize = RowSize(upload);
+
+			//Take as many rows as fit in the slot and the rest of the budget
+			//The first chunk of a frame always gets at least one row, so an upload can't stall on a tiny budget
+			std::size_t room = std::min(std::max(slot.capacity, ringSlotSize), (spent < budget ? budget - spent : 0));
+			if(spent > 0 && room < rowSize) break;
+			int rows = int(std::clamp<std::size_t>(room / rowSize, 1, upload.size.y - job->nextRow));
+			std::size_t bytes = rows * rowSize;
+
+			//Map the slot, growing it if needed
+			//Its last copy has been fenced, so it can be mapped without waiting on the GPU
+			if(slot.pbo == 0) glGenBuffers(1, &slot.pbo);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+			if(slot.capacity < bytes) {
+				slot.capacity = std::max(bytes, ringSlotSize);
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, slot.capacity, nullptr, GL_STREAM_DRAW);
+			}
+			void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			const unsigned char* source = upload.pixels.get() + job->nextRow * rowSize;
+			if(!mapped) {
+				//Copy straight from the pixels rather than getting stuck
+				Logging::EngineLog("Failed to map texture upload buffer, uploading directly instead", LogLevel::Warn);
+				CopyRows(upload, job->nextRow, rows, source);
+				job->nextRow += rows;
+				spent += bytes;
+				FinishIfDone(job);
+				continue;
+			}
+
+			slot.state = RingSlot::State::Filling;
+			slot.filled.store(false, std::memory_order_relaxed);
+			slot.job = job;
+			slot.firstRow = job->nextRow;
+			slot.rows = rows;
+			job->nextRow += rows;
+			job->chunksInFlight++;
+			spent += bytes;
+
+			//Fill it on the thread pool, waking the render thread so the copy goes out as soon as possible
+			auto fill = [filled = &slot.filled, mapped, source, bytes]() {
+				std::memcpy(mapped, source, bytes);
+				filled->store(true, std::memory_order_release);
+				RenderController::GetInstance()->WakeUp();
+			};
+			if(pool) {
+				pool->enqueue_detach(fill);
+			} else {
+				fill();
+			}
+		}
+	}
+
+	void ShutdownTextureUploads() {
+		//Let everything in flight land, which needs the thread pool and the GPU to finish up
+		auto busy = []() {
+			return !jobs.empty() || std::any_of(ring.begin(), ring.end(), [](const RingSlot& slot) { return slot.state != RingSlot::State::Free; });
+		};
+		while(busy()) {
+			PumpTextureUploads();
+			std::this_thread::yield();
+		}
+
+		for(RingSlot& slot : ring) {
+			if(slot.pbo != 0) glDeleteBuffers(1, &slot.pbo);
+			slot.pbo = 0;
+			slot.capacity = 0;
+		}
+	}
+}
@@ -37,6 +37,13 @@ namespace Cacao {
 		glBindVertexArray(0);
 
 		//Write lines
+		//Uniforms are the same for every glyph (the glyph texture is reused), so set them up once
+		int glyphSlot = -1;
+		ShaderUploadData up;
+		up.emplace_back(ShaderUploadItem {.target = "glyph", .data = std::any(RawGLTexture {.texObj = tex, .slot = &glyphSlot})});
+		up.emplace_back(ShaderUploadItem {.target = "color", .data = std::any(color)});
+		TextShaders::shader->PrepareUploadData(up);
+
 		int lineCounter = 0;
 		for(Line ln : lines) {
 			//Calculate starting position
@@ -96,17 +103,13 @@ namespace Cacao {
 
 				//Upload uniforms
 				TextShaders::shader->Bind();
-				ShaderUploadData up;
-				RawGLTexture upTex = {.texObj = tex, .slot = new int(-1)};
-				up.emplace_back(ShaderUploadItem {.target = "glyph", .data = std::any(upTex)});
-				up.emplace_back(ShaderUploadItem {.target = "color", .data = std::any(color)});
 				TextShaders::shader->UploadData(up);
 
 				//Draw glyph
 				glDrawArrays(GL_TRIANGLES, 0, 6);
 
 				//Unbind objects
-				glActiveTexture(GL_TEXTURE0 + (*upTex.slot));
+				glActiveTexture(GL_TEXTURE0 + glyphSlot);
 				glBindTexture(GL_TEXTURE_2D, 0);
 				TextShaders::shader->Unbind();
 
@@ -4,6 +4,7 @@
 
 #include "GLUIView.hpp"
 #include "GLUtils.hpp"
+#include "GLStateCache.hpp"
 #include "Graphics/Window.hpp"
 
 namespace Cacao {
@@ -71,8 +72,7 @@ namespace Cacao {
 
 		//Bind the front buffer to the requested slot
 		currentSlot = slot;
-		glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTexture(GL_TEXTURE_2D, frontBuffer->colorTex);
+		glState.BindTexture(slot, GL_TEXTURE_2D, frontBuffer->colorTex);
 		bound = true;
 	}
 
@@ -81,8 +81,7 @@ namespace Cacao {
 		CheckException(bound, Exception::GetExceptionCodeFromMeaning("BadBindState"), "Cannot unbind unbound UI view!");
 
 		//Unbind the texture from its current slot
-		glActiveTexture(GL_TEXTURE0 + currentSlot);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		glState.ReleaseTexture(currentSlot, GL_TEXTURE_2D);
 		currentSlot = -1;
 		bound = false;
 	}
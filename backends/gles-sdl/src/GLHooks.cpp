@@ -18,9 +18,6 @@ namespace Cacao {
 		return retval;
 	}
 
-	//Does nothing because the above check means this will never get called, we just can't have those functions in the compilation unit
-	void Handle64BitTypes(GLint, ShaderUploadItem& _, ShaderItemInfo& __, int) {}
-
 	void ConfigureSPIRV(spirv_cross::CompilerGLSL::Options* opts) {
 		opts->version = 300;
 		opts->es = true;
@@ -7,10 +7,36 @@
 
 #include <vector>
 #include <future>
+#include <span>
 
 namespace Cacao {
+	class MappedFile;
+
+	///@brief How much GPU memory compiled meshes' vertices take up, and how much they would take as full floats
+	struct VertexMemoryReport {
+		std::size_t meshes;		///<The number of compiled meshes
+		std::size_t vertices;	///<The number of vertices in them
+		std::size_t fullBytes;	///<The size of the vertices if every mesh used VertexFormat::Full
+		std::size_t actualBytes;///<The size of the vertices in the formats the meshes actually use
+	};
+
+	///@brief An axis-aligned box enclosing a mesh in local space
+	struct BoundingBox {
+		glm::vec3 min;///<The corner with the smallest coordinates
+		glm::vec3 max;///<The corner with the largest coordinates
+	};
+
+	class Mesh;
+
+	///@brief A simplified version of a mesh, drawn in its place when the difference is too small to see
+	struct MeshLOD {
+		std::shared_ptr<Mesh> mesh;///<The simplified mesh
+		float error;			   ///<Estimate of how far (in local space) the simplified surface strays from the full-detail one: the root mean square distance of moved vertices from the planes they were simplified from, so parts may stray further
+	};
+
 	/**
 	 * @brief A mesh. Implementation is backend-dependent
+	 * @details A mesh may carry a chain of LODs, which are compiled, released, and repacked along with it
 	 */
 	class Mesh final : public Asset {
 	  public:
@@ -20,8 +46,22 @@ namespace Cacao {
 		 *
 		 * @param vertices The list of vertices
 		 * @param indices The list of indices (each "index" is a triangle comprised of three positions in the vertex list)
+		 * @param format How to lay out the vertices on the GPU (optional, defaults to VertexFormat::Full)
 		 */
-		Mesh(std::vector<Vertex> vertices, std::vector<glm::uvec3> indices);
+		Mesh(std::vector<Vertex> vertices, std::vector<glm::uvec3> indices, VertexFormat format = VertexFormat::Full);
+
+		/**
+		 * @brief Create a mesh that reads its vertices and indices straight out of a mapped file
+		 * @details Nothing is copied; the data is handed to the GPU from the mapping when compiled.
+		 * The mesh keeps the mapping alive for as long as it lives.
+		 * @note For use by the engine only (see Model for cooked model files)
+		 *
+		 * @param file The mapped file
+		 * @param vertices The vertices, which must lie within the mapping
+		 * @param indices The triangles, which must lie within the mapping
+		 * @param bounds The bounds of the vertices
+		 */
+		Mesh(std::shared_ptr<MappedFile> file, std::span<const Vertex> vertices, std::span<const glm::uvec3> indices, BoundingBox bounds);
 
 		/**
 		 * @brief Delete the mesh and release compiled data if present
@@ -39,6 +79,19 @@ namespace Cacao {
 		 */
 		void Draw();
 
+		/**
+		 * @brief Draw several instances of the mesh at once
+		 * @details Each instance takes its transform from the renderer's instance buffer, which holds the transforms of the frame's render objects
+		 *
+		 * @param count The number of instances to draw
+		 * @param firstInstance The index of the render object holding the first instance's transform
+		 *
+		 * @note For use by the engine only
+		 *
+		 * @throws Exception If not compiled or if not called on the engine thread
+		 */
+		void DrawInstanced(unsigned int count, std::size_t firstInstance);
+
 		/**
 		 * @brief Compile the raw mesh data into a format that can be drawn
 		 *
@@ -55,18 +108,123 @@ namespace Cacao {
 		 */
 		void Release() override;
 
+		/**
+		 * @brief Estimate how much memory the mesh and its LODs take up
+		 * @details Counts vertex and index data owned by the mesh (not data read from a mapped file) and the buffers on the GPU.
+		 *
+		 * @return The memory usage
+		 */
+		AssetMemoryUsage GetMemoryUsage() override;
+
 		///@brief Gets the type of this asset. Needed for safe downcasting from Asset
 		std::string GetType() override {
 			return "MESH";
 		}
 
+		/**
+		 * @brief Change how the vertices are laid out on the GPU
+		 * @details Packing is done here, so call this off of the engine thread to keep it from holding up rendering
+		 *
+		 * @param newFormat The new format
+		 *
+		 * @throws Exception If the mesh is compiled
+		 */
+		void SetVertexFormat(VertexFormat newFormat);
+
+		/**
+		 * @brief Get how the vertices are laid out on the GPU
+		 *
+		 * @return The vertex format
+		 */
+		VertexFormat GetVertexFormat() const {
+			return format;
+		}
+
+		/**
+		 * @brief Get the transform that turns the positions stored on the GPU back into the mesh's positions
+		 * @details This is the identity matrix unless the vertex format is VertexFormat::Quantized
+		 *
+		 * @return The dequantization transform
+		 */
+		const glm::mat4& GetPositionTransform() const {
+			return positionTransform;
+		}
+
+		/**
+		 * @brief Get how much GPU memory compiled meshes' vertices take up
+		 *
+		 * @return The memory report for every mesh compiled right now
+		 */
+		static VertexMemoryReport GetMemoryReport();
+
+		/**
+		 * @brief Add a LOD to the end of the LOD chain
+		 *
+		 * @param lod The simplified mesh, which should be coarser than the LODs already in the chain
+		 * @param error Estimate of how far (in local space) the simplified surface strays from this mesh (see MeshLOD::error)
+		 *
+		 * @throws Exception If this mesh is compiled
+		 */
+		void AddLOD(std::shared_ptr<Mesh> lod, float error);
+
+		/**
+		 * @brief Get the LOD chain
+		 *
+		 * @return The LODs, from the most detailed to the coarsest (this mesh itself isn't included)
+		 */
+		const std::vector<MeshLOD>& GetLODs() const {
+			return lods;
+		}
+
+		/**
+		 * @brief Get the vertices
+		 *
+		 * @return The vertex list
+		 */
+		std::span<const Vertex> GetVertices() const {
+			return vertexData;
+		}
+
+		/**
+		 * @brief Get the indices
+		 *
+		 * @return The index list (each "index" is a triangle comprised of three positions in the vertex list)
+		 */
+		std::span<const glm::uvec3> GetIndices() const {
+			return indexData;
+		}
+
+		/**
+		 * @brief Get the bounds
+		 *
+		 * @return The box enclosing every vertex
+		 */
+		const BoundingBox& GetBounds() const {
+			return bounds;
+		}
+
 	  private:
 		//Backend-implemented data type
 		struct MeshData;
 
+		//Data owned by the mesh (empty for meshes read from a mapped file)
 		std::vector<Vertex> vertices;
 		std::vector<glm::uvec3> indices;
 
+		//File the data lives in when the mesh doesn't own it
+		std::shared_ptr<MappedFile> mapping;
+
+		//Where the data actually is, in either case
+		std::span<const Vertex> vertexData;
+		std::span<const glm::uvec3> indexData;
+
+		BoundingBox bounds;
+
+		VertexFormat format;
+		glm::mat4 positionTransform;
+
+		std::vector<MeshLOD> lods;
+
 		std::shared_ptr<MeshData> nativeData;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Vertex.hpp"
+
+#include <vector>
+#include <span>
+#include <cstddef>
+
+namespace Cacao {
+	/**
+	 * @brief Reorder triangles so that the GPU's post-transform vertex cache hits as often as possible
+	 * @details Uses Tom Forsyth's linear-speed vertex cache optimization, which greedily picks the triangle whose vertices score best given a simulated cache
+	 *
+	 * @param indices The triangles to reorder
+	 * @param vertexCount The number of vertices the triangles index into
+	 */
+	void OptimizeVertexCache(std::vector<glm::uvec3>& indices, std::size_t vertexCount);
+
+	/**
+	 * @brief Reorder clusters of triangles so that the ones facing outwards are drawn first, which lets depth testing reject more of what's behind them
+	 * @details The triangles are split into clusters where the vertex cache would be cold anyway (and, in big clusters, where splitting keeps the cache miss ratio within the threshold), which are then sorted.
+	 * Triangles should already be in vertex cache order.
+	 *
+	 * @param indices The triangles to reorder
+	 * @param vertices The vertices the triangles index into
+	 * @param threshold How much worse the average cache miss ratio of a cluster may get from splitting it (1.05 allows 5% worse)
+	 */
+	void OptimizeOverdraw(std::vector<glm::uvec3>& indices, std::span<const Vertex> vertices, float threshold = 1.05f);
+
+	/**
+	 * @brief Reorder vertices to the order triangles first use them in, so that vertex fetches walk through memory in order
+	 * @details Vertices that no triangle uses are dropped
+	 *
+	 * @param vertices The vertices to reorder
+	 * @param indices The triangles, which are remapped to the new vertex order
+	 */
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<glm::uvec3>& indices);
+
+	/**
+	 * @brief Optimize a mesh for rendering
+	 * @details Runs OptimizeVertexCache, OptimizeOverdraw and OptimizeVertexFetch in that order
+	 *
+	 * @param vertices The vertices to optimize
+	 * @param indices The triangles to optimize
+	 */
+	void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<glm::uvec3>& indices);
+
+	/**
+	 * @brief Simulate a FIFO post-transform vertex cache to find the average cache miss ratio of triangles
+	 *
+	 * @param indices The triangles
+	 * @param vertexCount The number of vertices the triangles index into
+	 * @param cacheSize The number of vertices the simulated cache holds (optional, defaults to 16)
+	 *
+	 * @return The number of vertices transformed per triangle (between 0.5 at best for large meshes and 3 at worst)
+	 */
+	float ComputeACMR(std::span<const glm::uvec3> indices, std::size_t vertexCount, std::size_t cacheSize = 16);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Vertex.hpp"
+
+#include <vector>
+#include <span>
+#include <cstddef>
+
+namespace Cacao {
+	/**
+	 * @brief Reduce the number of triangles in a mesh by collapsing edges
+	 * @details Edges are collapsed cheapest first by quadric error (Garland and Heckbert), with each collapse moving one vertex onto the other so that no new vertices are needed.
+	 * Vertices on a border or texture seam are never moved, so those stay intact, and collapses that would flip a triangle are skipped.
+	 * A collapse's error is the root mean square distance of the moved vertex from the planes of the original triangles it stands in for.
+	 * This estimates how far the surface strays rather than bounding it, so some of the simplified surface may stray further.
+	 *
+	 * @param vertices The vertices of the mesh
+	 * @param indices The triangles of the mesh
+	 * @param targetTriangles The number of triangles to aim for
+	 * @param maxError The largest error (in local space) a collapse may have, which may stop simplification before the target is reached
+	 * @param resultError Where to put the largest error of any collapse done (optional)
+	 *
+	 * @return The triangles of the simplified mesh, which index into the same vertices (some of which are now unused)
+	 */
+	std::vector<glm::uvec3> SimplifyMesh(std::span<const Vertex> vertices, std::span<const glm::uvec3> indices, std::size_t targetTriangles, float maxError, float* resultError = nullptr);
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <map>
 #include <utility>
+#include <memory>
 
 #include "Mesh.hpp"
 
@@ -15,18 +16,66 @@ namespace Cacao {
 		/**
 		 * @brief Load a model from a file path
 		 *
+		 * @details Each mesh is optimized for rendering and given a chain of simplified LODs unless asked not to (see OptimizeMesh and SimplifyMesh)
+		 *
 		 * @param filePath The path to load from
+		 * @param optimize Whether to optimize the meshes and generate their LODs (optional, defaults to true)
 		 *
-		 * @note Prefer to use AssetManager::LoadMesh if loading a mesh from a model file
+		 * @note Prefer to use AssetManager::LoadModel or AssetManager::LoadMesh over direct construction
 		 *
 		 * @throws Exception If the file does not exist, could not be parsed, or has no meshes
 		 */
-		Model(std::string filePath);
+		Model(std::string filePath, bool optimize = true);
+
+		/**
+		 * @brief Load a model from its cooked model file instead of the source file
+		 * @details Meshes read their vertices and indices straight out of the mapped cooked file, so nothing is parsed, converted, or copied
+		 *
+		 * @param filePath The path of the source model file (the cooked model file is found next to it)
+		 *
+		 * @return The model
+		 *
+		 * @throws Exception If the cooked model file does not exist, could not be mapped, or is not a valid cooked model file for this build
+		 * @see GetCookedPath,HasFreshCook
+		 */
+		static std::shared_ptr<Model> LoadCooked(const std::string& filePath);
+
+		/**
+		 * @brief Get where the cooked model file for a model file goes
+		 *
+		 * @param filePath The path of the source model file
+		 *
+		 * @return The path of the cooked model file
+		 */
+		static std::string GetCookedPath(const std::string& filePath) {
+			return filePath + ".cmesh";
+		}
 
 		/**
-		 * @brief Destroy the model (does not destroy meshes)
+		 * @brief Check if a model file has a cooked model file that is newer than it
+		 * @details Cooked model files in asset archives are always up to date, since stale ones are left out when packing.
+		 *
+		 * @param filePath The path of the source model file
+		 *
+		 * @return Whether there is an up-to-date cooked model file
+		 */
+		static bool HasFreshCook(const std::string& filePath);
+
+		/**
+		 * @brief Write this model as a cooked model file
+		 * @details A cooked model file holds every mesh's vertices and indices in the layout they are uploaded to the GPU in, along with their bounds, so that it can be loaded without Assimp.
+		 * The file is written next to the destination first and moved into place once complete, so it is never seen half-written.
+		 *
+		 * @param cookedPath The path to write to
+		 *
+		 * @throws Exception If the file could not be written
+		 */
+		void Cook(const std::string& cookedPath);
+
+		/**
+		 * @brief Destroy the model (extracted meshes live on as long as something else owns them)
 		 */
-		~Model();
+		~Model() = default;
 
 		/**
 		 * @brief List the meshes in this model
@@ -37,13 +86,15 @@ namespace Cacao {
 
 		/**
 		 * @brief Extract a mesh from this model
-		 * @note The extracted mesh, if modified, will have those modifications reflected in the model's stored in-memory mesh. The mesh will not be deleted with the model.
+		 * @note The extracted mesh is shared with the model, so modifications to it will be reflected in the model's stored in-memory mesh
 		 *
 		 * @param id The name of the mesh to extract
 		 *
+		 * @return The mesh
+		 *
 		 * @throws Exception If the model does not contain a mesh with the given name
 		 */
-		Mesh* ExtractMesh(std::string id);
+		std::shared_ptr<Mesh> ExtractMesh(std::string id);
 
 		/**
 		 * @brief Check if this model contains a given mesh
@@ -53,7 +104,10 @@ namespace Cacao {
 		bool HasMesh(std::string id);
 
 	  private:
-		std::map<std::string, Mesh*> meshes;
+		//Cooked models fill in their meshes themselves
+		Model() = default;
+
+		std::map<std::string, std::shared_ptr<Mesh>> meshes;
 
 		enum ModelOrientation {
 			PosX,
@@ -68,6 +68,14 @@ namespace Cacao {
 			return texture->IsCompiled();
 		}
 
+		/**
+		 * @brief Estimate how much memory the cubemap takes up
+		 * @see Cubemap::GetMemoryUsage
+		 */
+		AssetMemoryUsage GetMemoryUsage() override {
+			return texture->GetMemoryUsage();
+		}
+
 		///@brief Gets the type of this asset. Needed for safe downcasting from Asset
 		std::string GetType() override {
 			return "SKYBOX";
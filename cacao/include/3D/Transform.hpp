@@ -4,6 +4,9 @@
 #include "glm/mat4x4.hpp"
 
 namespace Cacao {
+	//Forward declaration of Entity for owner notifications
+	class Entity;
+
 	/**
 	 * @brief A transform defining position, rotation, and scale
 	 */
@@ -17,10 +20,32 @@ namespace Cacao {
 		 * @param scale Scale from the center
 		 */
 		Transform(glm::vec3 position, glm::vec3 rotation, glm::vec3 scale)
-		  : pos(position), rot(rotation), scale(scale), transMat(1.0) {
+		  : pos(position), rot(rotation), scale(scale), transMat(1.0), owner(nullptr) {
 			RecalculateTransformationMatrix();
 		}
 
+		/**
+		 * @brief Copy a transform
+		 *
+		 * @note The copy is not attached to the original's entity
+		 */
+		Transform(const Transform& other)
+		  : pos(other.pos), rot(other.rot), scale(other.scale), transMat(other.transMat), owner(nullptr) {}
+
+		/**
+		 * @brief Assign the position, rotation, and scale of another transform to this one
+		 *
+		 * @note This transform stays attached to its own entity
+		 */
+		Transform& operator=(const Transform& other) {
+			pos = other.pos;
+			rot = other.rot;
+			scale = other.scale;
+			transMat = other.transMat;
+			MarkDirty();
+			return *this;
+		}
+
 		/**
 		 * @brief Get the position
 		 *
@@ -56,6 +81,7 @@ namespace Cacao {
 		void SetPosition(glm::vec3 newPos) {
 			pos = newPos;
 			RecalculateTransformationMatrix();
+			MarkDirty();
 		}
 
 		/**
@@ -66,6 +92,7 @@ namespace Cacao {
 		void SetRotation(glm::vec3 newRot) {
 			rot = newRot;
 			RecalculateTransformationMatrix();
+			MarkDirty();
 		}
 
 		/**
@@ -76,22 +103,33 @@ namespace Cacao {
 		void SetScale(glm::vec3 newScale) {
 			scale = newScale;
 			RecalculateTransformationMatrix();
+			MarkDirty();
 		}
 
 		/**
 		 * @brief Get the matrix representing the applied transformations
+		 * @details Only reads, so parallel scripts may call this on the same transform at once
 		 *
 		 * @return The transformation matrix
 		 */
-		glm::mat4 GetTransformationMatrix() {
+		glm::mat4 GetTransformationMatrix() const {
 			return transMat;
 		}
 
 	  private:
 		glm::vec3 pos, rot, scale;
 
+		//Local matrix, recalculated whenever the transform changes
 		glm::mat4 transMat;
 
+		//Entity this is the local transform of (null if standalone)
+		Entity* owner;
+
 		void RecalculateTransformationMatrix();
+
+		//Invalidate the world matrices of the owner's subtree
+		void MarkDirty();
+
+		friend Entity;
 	};
 }
\ No newline at end of file
@@ -3,13 +3,24 @@
 #include "glm/glm.hpp"
 
 namespace Cacao {
+	/**
+	 * @brief How a mesh's vertices are laid out on the GPU
+	 * @details Shaders see the same inputs whatever the format, except that the packed formats have no bitangent input.
+	 * Instead, the tangent input has a fourth component holding the sign of the bitangent, so shaders that need it should compute it as cross(normal, tangent.xyz) * tangent.w.
+	 */
+	enum class VertexFormat {
+		Full,	 ///<Every attribute as full floats (56 bytes)
+		Packed,	 ///<Float positions, half-float texture coordinates, and 10-bit normals and tangents with the bitangent sign in the tangent's spare bits (24 bytes)
+		Quantized///<Like Packed, but with positions as 16-bit integers scaled to the mesh bounds (20 bytes). The engine undoes the scaling by folding it into the transform, which shaders should normalize normals after applying
+	};
+
 	///@brief A vertex in a mesh
 	struct Vertex {
-		const glm::vec3 position; ///<The position in local space
-		const glm::vec2 texCoords;///<The texture coordinates
-		const glm::vec3 tangent;  ///<The right vector in tangent space
-		const glm::vec3 bitangent;///<The front vector in tangent space
-		const glm::vec3 normal;	  ///<The up vector in tangent space
+		glm::vec3 position; ///<The position in local space
+		glm::vec2 texCoords;///<The texture coordinates
+		glm::vec3 tangent;	///<The right vector in tangent space
+		glm::vec3 bitangent;///<The front vector in tangent space
+		glm::vec3 normal;	///<The up vector in tangent space
 
 		/**
 		 * @brief Create a new vertex
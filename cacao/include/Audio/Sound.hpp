@@ -2,6 +2,7 @@
 
 #include "Utilities/Asset.hpp"
 #include "Utilities/MiscUtils.hpp"
+#include "Utilities/MappedFile.hpp"
 #include "Events/EventSystem.hpp"
 
 #include "AL/al.h"
@@ -47,6 +48,17 @@ namespace Cacao {
 		 */
 		void Release() override;
 
+		/**
+		 * @brief Estimate how much memory the sound takes up
+		 * @details Counts the decoded samples and, once compiled, the copy of them in the audio buffer (which OpenAL keeps in system memory)
+		 *
+		 * @return The memory usage
+		 */
+		AssetMemoryUsage GetMemoryUsage() override {
+			std::size_t sampleBytes = audioData.size() * sizeof(short);
+			return {.cpu = sampleBytes * (compiled ? 2 : 1), .gpu = 0};
+		}
+
 		///@brief Gets the type of this asset. Needed for safe downcasting from Asset
 		std::string GetType() override {
 			return "SOUND";
@@ -67,10 +79,10 @@ namespace Cacao {
 
 		//Sound data initialization methods
 		void _InitFlac();
-		void _InitMP3();
-		void _InitWAV();
-		void _InitVorbis();
-		void _InitOpus();
+		void _InitMP3(const MappedFile& file);
+		void _InitWAV(const MappedFile& file);
+		void _InitVorbis(const MappedFile& file);
+		void _InitOpus(const MappedFile& file);
 
 		//Need to let the FLAC decoder (which has to be a class per the API) access our methods
 		friend class FLACDecoder;
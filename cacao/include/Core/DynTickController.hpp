@@ -9,6 +9,9 @@
 #include "Graphics/Rendering/RenderObjects.hpp"
 
 namespace Cacao {
+	//Forward declaration of World for scheduling
+	class World;
+
 	/**
 	 * @brief Controls dynamic ticks
 	 */
@@ -53,12 +56,33 @@ namespace Cacao {
 
 		std::jthread* thread;
 
-		std::vector<std::shared_ptr<Component>> tickScriptList;
 		double timestep;
 
-		DynTickController()
-		  : isRunning(false), thread(nullptr) {}
+		//Simulation time not yet consumed by fixed ticks (in seconds)
+		double fixedAccumulator;
+
+		//A group of scripts that can run at the same time
+		struct TickWave {
+			std::vector<Script*> scripts;
+			bool parallel;
+		};
+
+		//Waves of scripts to run this tick, in order
+		std::vector<TickWave> schedule;
 
-		void LocateComponents(std::shared_ptr<Entity> e, std::function<void(std::shared_ptr<Component>)> maybeMatch);
+		//World and store structure version the schedule was built for
+		World* scheduledWorld;
+		uint64_t scheduledVersion;
+
+		//Sort the active scripts of a world into waves, unless the schedule is already up to date
+		//Returns whether the schedule was rebuilt
+		bool BuildSchedule(World& world);
+
+		//Run a function on every scheduled script
+		template<typename F>
+		void RunSchedule(F&& func);
+
+		DynTickController()
+		  : isRunning(false), thread(nullptr), scheduledWorld(nullptr), scheduledVersion(0) {}
 	};
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+#include <cstddef>
+
 namespace Cacao {
 	/**
 	 * @brief Engine configuration values
@@ -11,14 +14,45 @@ namespace Cacao {
 		 */
 		int targetDynTPS;
 
+		///@brief The number of fixed ticks that should occur within a second
+		int fixedTickRate;
+
 		/**
-		 * @brief The rate at which fixed ticks should occur
-		 *
-		 * @warning Fixed ticks are not yet implemented into the engine!
+		 * @brief The maximum number of fixed ticks that can run during one dynamic tick
+		 * @details If the engine falls further behind than this, the remaining simulation time is dropped instead of making the next tick even longer
 		 */
-		int fixedTickRate;
+		int maxFixedTicks;
+
+		/**
+		 * @brief How many pixels a mesh LOD's estimated error may cover on screen before a more detailed one is drawn instead
+		 * @details LOD errors are estimates (see MeshLOD::error), so parts of a LOD may be off by more than this. Higher values draw fewer triangles at the cost of more visible simplification
+		 */
+		float lodErrorPixels;
+
+		/**
+		 * @brief The directory to cache generated and compiled shaders in, relative to the working directory
+		 * @details Shaders found in the cache load without being converted or compiled again. An empty path disables the cache.
+		 */
+		std::string shaderCacheDir;
 
-		///@brief The number of frames the renderer can be behind before skipping some to catch up
-		int maxFrameLag;
+		/**
+		 * @brief How many bytes of texture data may be sent to the GPU per frame
+		 * @details Larger textures are spread across as many frames as they need. At least one chunk is always sent each frame, so uploads can't stall.
+		 */
+		std::size_t textureUploadBudget;
+
+		/**
+		 * @brief How many bytes of GPU memory streamed texture detail may use
+		 * @details Large cooked textures only keep their small mip levels resident, and load more detailed ones as they are drawn bigger.
+		 * Those detailed levels share this budget, and the least recently drawn textures give theirs up when it runs out.
+		 */
+		std::size_t textureMemoryBudget;
+
+		/**
+		 * @brief How many bytes of memory each asset type may take up before assets nothing holds anymore are evicted
+		 * @details Assets are kept loaded for a while after their last handle goes away, so loading them again soon after is instant.
+		 * Types can be given their own budgets with AssetManager::SetMemoryBudget.
+		 */
+		std::size_t assetMemoryBudget;
 	};
 }
\ No newline at end of file
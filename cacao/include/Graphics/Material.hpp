@@ -1,12 +1,169 @@
 #pragma once
 
 #include "Shader.hpp"
+#include "Textures/Texture.hpp"
+#include "Utilities/LinearArena.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <span>
+#include <typeinfo>
+#include <type_traits>
 
 namespace Cacao {
-	///@brief A shader and data to input into it
-	struct Material {
+	class UIView;
+	class Material;
+
+	/**
+	 * @brief A texture set on a material (either a texture or a UI view)
+	 */
+	struct MaterialTexture {
+		int slot;						 ///<The texture unit to bind to
+		std::shared_ptr<Texture> texture;///<The texture (null if this is a UI view)
+		std::shared_ptr<UIView> view;	 ///<The UI view (null if this is a texture)
+	};
+
+	/**
+	 * @brief The state of a material captured for drawing a frame
+	 * @details Frames are drawn with what was captured when they were built, so changes made to a material while a frame is being drawn show up in the next frame instead of partway through this one
+	 */
+	struct MaterialSnapshot {
+		std::shared_ptr<Material> material;	  ///<The material (kept alive for its GPU data)
+		std::shared_ptr<Shader> shader;		  ///<The shader to draw with
+		std::span<const unsigned char> block; ///<The parameters as of the capture (stored in the frame arena)
+		uint64_t version;					  ///<How many times the parameters had been changed as of the capture
+		std::size_t firstTexture, textureCount;///<The range of the captured textures in the frame's texture list
+	};
+
+	/**
+	 * @brief A shader and data to input into it. Implementation is backend-dependent
+	 * @details Non-texture parameters are packed into a block laid out from the shader specification, which is only sent to the GPU again after a parameter changes.
+	 * Binding a material is then just binding that block and its textures.
+	 */
+	class Material : public std::enable_shared_from_this<Material> {
 	  public:
-		AssetHandle<Shader> shader;///<The shader to use
-		ShaderUploadData data;	   ///<The data to upload
+		/**
+		 * @brief Create a material
+		 * @details Parameters start out zeroed and textures start out unset
+		 *
+		 * @param shader The shader to use (doesn't need to be compiled yet)
+		 *
+		 * @throws Exception If the shader handle is null
+		 */
+		Material(AssetHandle<Shader> shader);
+
+		/**
+		 * @brief Delete the material and its GPU data
+		 */
+		~Material();
+
+		///@brief Copying is banned
+		Material(const Material&) = delete;
+
+		///@brief Copy-assignment is banned
+		Material& operator=(const Material&) = delete;
+
+		/**
+		 * @brief Set a parameter
+		 * @details The type must be the one the shader specification calls for (e.g. glm::vec3 for a three-component float vector, glm::ivec2 for a two-component boolean vector)
+		 *
+		 * @param name The name of the entry in the shader specification
+		 * @param value The new value
+		 *
+		 * @throws Exception If the entry doesn't exist, is a texture, can't be set on this backend, or has a different type
+		 */
+		template<typename T>
+		void SetParameter(const std::string& name, const T& value) {
+			WriteParameter(name, typeid(T), &value);
+		}
+
+		/**
+		 * @brief Set a texture
+		 *
+		 * @param name The name of the entry in the shader specification
+		 * @param texture The new texture
+		 *
+		 * @throws Exception If the entry doesn't exist, isn't a texture, or can't be set on this backend
+		 */
+		void SetTexture(const std::string& name, std::shared_ptr<Texture> texture);
+
+		/**
+		 * @brief Set a texture to a UI view
+		 *
+		 * @param name The name of the entry in the shader specification
+		 * @param view The UI view
+		 *
+		 * @throws Exception If the entry doesn't exist, isn't a texture, or can't be set on this backend
+		 */
+		void SetTexture(const std::string& name, std::shared_ptr<UIView> view);
+
+		/**
+		 * @brief Set a texture from an asset handle
+		 *
+		 * @param name The name of the entry in the shader specification
+		 * @param texture The new texture
+		 *
+		 * @throws Exception If the entry doesn't exist, isn't a texture, or can't be set on this backend
+		 */
+		template<typename T>
+		void SetTexture(const std::string& name, AssetHandle<T> texture) {
+			static_assert(std::is_base_of_v<Texture, T>, "Cannot set a texture to a non-texture asset!");
+			SetTexture(name, std::static_pointer_cast<Texture>(texture.GetManagedAsset()));
+		}
+
+		/**
+		 * @brief Get the shader
+		 *
+		 * @return The shader this material uses
+		 */
+		AssetHandle<Shader>& GetShader() {
+			return shader;
+		}
+
+		/**
+		 * @brief Capture the current parameters and textures for drawing a frame
+		 *
+		 * @param arena The frame arena to copy the parameters into
+		 * @param textures The frame's texture list to add the textures to
+		 *
+		 * @return The captured state
+		 *
+		 * @note For use by the engine only. The material must be owned by a shared pointer.
+		 */
+		MaterialSnapshot Capture(LinearArena& arena, std::vector<MaterialTexture>& textures);
+
+		/**
+		 * @brief Make captured data and textures of this material the ones the bound shader draws with
+		 * @details Uploads the captured parameters first if they differ from the last ones uploaded
+		 *
+		 * @param snapshot The captured state
+		 * @param textures The captured textures
+		 *
+		 * @note For use by the engine only
+		 *
+		 * @throws Exception If the shader is not compiled or if not called on the engine thread
+		 */
+		void Bind(const MaterialSnapshot& snapshot, std::span<const MaterialTexture> textures);
+
+		/**
+		 * @brief Detach the textures bound by Bind
+		 *
+		 * @param textures The captured textures that were bound
+		 *
+		 * @note For use by the engine only
+		 *
+		 * @throws Exception If not called on the engine thread
+		 */
+		void Unbind(std::span<const MaterialTexture> textures);
+
+	  private:
+		//Backend-implemented data type
+		struct MaterialData;
+
+		AssetHandle<Shader> shader;
+		std::shared_ptr<MaterialData> nativeData;
+
+		void WriteParameter(const std::string& name, const std::type_info& type, const void* value);
 	};
-}
\ No newline at end of file
+}
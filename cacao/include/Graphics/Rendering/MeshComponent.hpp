@@ -13,12 +13,18 @@ namespace Cacao {
 	 */
 	class MeshComponent : public Component {
 	  public:
+		///@brief Component kind of mesh renderers (used for World::Each queries)
+		static constexpr const char* kind = "MESH";
+
 		///@brief Gets the type of this componet. Needed for safe downcasting from Component
 		std::string GetKind() override {
-			return "MESH";
+			return kind;
 		}
 
 		AssetHandle<Mesh> mesh;		  ///<The mesh to render
 		std::shared_ptr<Material> mat;///<The material to render the mesh with
+
+		///@brief The LOD of the mesh drawn last frame (0 being the full mesh), which the engine keeps so that LOD choices don't flicker
+		unsigned int lod = 0;
 	};
 }
\ No newline at end of file
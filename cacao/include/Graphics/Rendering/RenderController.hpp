@@ -2,12 +2,16 @@
 
 #include "RenderObjects.hpp"
 #include "Core/Engine.hpp"
+#include "Utilities/TripleBuffer.hpp"
+#include "Utilities/Task.hpp"
 
 #include <thread>
-#include <queue>
 #include <condition_variable>
 #include <mutex>
+#include <atomic>
 #include <vector>
+#include <future>
+#include <functional>
 
 namespace Cacao {
 	/**
@@ -32,27 +36,69 @@ namespace Cacao {
 		void Run();
 
 		/**
-		 * @brief Enqueue a frame for rendering
+		 * @brief Get the frame to fill in for the next submission
+		 * @details Frames are reused, so the returned frame still contains whatever was put into it the last time it was used
 		 *
-		 * @param frame The frame to enqueue
+		 * @note Only the dynamic tick controller should build frames
+		 *
+		 * @return The frame to fill in
+		 */
+		Frame& BeginFrame() {
+			return frames.GetWriteBuffer();
+		}
+
+		/**
+		 * @brief Submit the frame returned by BeginFrame for rendering
+		 * @details If the renderer hasn't picked up the previously submitted frame yet, it is replaced by this one
 		 */
-		void EnqueueFrame(std::shared_ptr<Frame>& frame) {
+		void SubmitFrame() {
 			if(!Engine::GetInstance()->IsShuttingDown()) {
-				//Add a frame to the queue
-				std::lock_guard guard(fqMutex);
-				frameQueue.push(frame);
+				frames.Publish();
+				WakeUp();
 			}
 		}
 
 		/**
-		 * @brief Clear the frame queue
+		 * @brief Discard the submitted frame if it hasn't been rendered yet
 		 */
 		void ClearRenderQueue() {
-			std::unique_lock<std::mutex> lock(fqMutex);
-			while(!frameQueue.empty()) frameQueue.pop();
-			lock.unlock();
+			frames.Discard();
+		}
+
+		/**
+		 * @brief Wake the render thread because there is new work for it
+		 *
+		 * @note Called automatically when frames or graphics jobs are submitted
+		 */
+		void WakeUp() {
+			wakeCounter.fetch_add(1);
+
+			//Only bother with the lock if the render thread is actually asleep
+			if(sleeping.load()) {
+				std::lock_guard lk(wakeMtx);
+				wakeCV.notify_one();
+			}
 		}
 
+		/**
+		 * @brief Queue a task to run on the render thread
+		 * @details Tasks run in the order they were queued, before the next frame is drawn.
+		 * This is how work that needs the graphics backend (like uploading an asset) gets done without the caller waiting around for it.
+		 *
+		 * @param task The task to run (its status is fulfilled once it has run, or given the exception it threw)
+		 */
+		void EnqueueTask(Task& task);
+
+		/**
+		 * @brief Run a function on the render thread once a future is ready
+		 * @details The future is checked once per render loop instead of being waited on, so nothing blocks on it.
+		 * This is how work that follows something finishing over several frames (like a texture streaming in) gets done.
+		 *
+		 * @param future The future to wait for (an invalid future counts as ready)
+		 * @param then The function to run, which must not throw
+		 */
+		void RunWhenReady(std::shared_future<void> future, std::function<void()> then);
+
 		/**
 		 * @brief Initialize the rendering backend
 		 *
@@ -73,19 +119,23 @@ namespace Cacao {
 		static bool instanceExists;
 
 		RenderController()
-		  : isInitialized(false) {}
+		  : isInitialized(false), wakeCounter(0), sleeping(false) {}
 
 		//Process a frame for drawing
-		void ProcessFrame(std::shared_ptr<Frame> frame);
+		void ProcessFrame(Frame& frame);
 
 		//Update the graphics state
 		void UpdateGraphicsState();
 
-		//Queue of frames to render
-		std::queue<std::shared_ptr<Frame>> frameQueue;
+		//Frames handed from the dynamic tick controller to the renderer
+		TripleBuffer<Frame> frames;
 
-		//Thread safety constructs
-		std::mutex fqMutex;
+		//Wakeup signalling for the render thread
+		//The counter changes whenever there's new work, the rest is only used when the render thread sleeps
+		std::atomic_uint32_t wakeCounter;
+		std::atomic_bool sleeping;
+		std::mutex wakeMtx;
+		std::condition_variable wakeCV;
 
 		bool isInitialized;
 	};
@@ -5,36 +5,36 @@
 #include "3D/Mesh.hpp"
 #include "3D/Skybox.hpp"
 #include "Graphics/Material.hpp"
+#include "Utilities/LinearArena.hpp"
 
 #include <vector>
 #include <optional>
+#include <span>
 
 namespace Cacao {
 	/**
 	 * @brief Internal representation of an object to render
+	 * @details Meshes and materials are referred to by their index in the frame's tables so that objects are plain data and copying them never touches reference counts
 	 */
 	struct RenderObject {
 		glm::mat4 transformMatrix;///<The transformation matrix to apply
-		AssetHandle<Mesh> mesh;	  ///<The mesh to draw
-		Material material;		  ///<The material to draw the mesh with
-
-		/**
-		 * @brief Create a render object
-		 *
-		 * @param transform The transformation matrix
-		 * @param mesh The mesh to draw
-		 * @param mat The material to use
-		 */
-		RenderObject(glm::mat4 transform, AssetHandle<Mesh> mesh, Material mat)
-		  : transformMatrix(transform), mesh(mesh), material(mat) {}
+		uint32_t mesh;			  ///<Index of the mesh to draw in Frame::meshes
+		uint32_t material;		  ///<Index of the captured material to draw the mesh with in Frame::materials
 	};
 
 	/**
 	 * @brief Frame rendering parameters
+	 * @details Frames are reused rather than recreated, so once the tables and arena have grown to fit the scene, building a frame doesn't allocate
 	 */
 	struct Frame {
-		std::vector<RenderObject> objects;///<The list of objects to render
-		glm::mat4 projection, view;		  ///<The projection and view matrices from the main camera
-		AssetHandle<Skybox> skybox;		  ///<The skybox to draw (null handle means no skybox)
+		std::span<RenderObject> objects;					///<The list of objects to render (stored in the frame arena)
+		std::vector<std::shared_ptr<Mesh>> meshes;			///<Each mesh used by this frame, kept alive until the frame is reused
+		std::vector<MaterialSnapshot> materials;			///<The state of each material used by this frame, captured as the frame was built
+		std::vector<MaterialTexture> textures;				///<The textures captured with the materials
+		glm::mat4 projection, view;							///<The projection and view matrices from the main camera
+		AssetHandle<Skybox> skybox;							///<The skybox to draw (null handle means no skybox)
+		double fixedTickAlpha;								///<How far this frame is between the last fixed tick and the next one (0-1), for interpolating fixed tick state
+		LinearArena arena;									///<Storage for transient data of this frame, reset when the frame is reused
+		std::size_t allocations;							///<Number of heap allocations made scheduling scripts and building this frame, with a schedule rebuild counting as one (zero once the scene and its scripts stop changing; running scripts and logging aren't counted)
 	};
 }
\ No newline at end of file
@@ -30,8 +30,14 @@ namespace Cacao {
 
 	///@brief Item of data to upload to a shader
 	struct ShaderUploadItem {
-		std::string target;///<The name of the ShaderItemInfo to target
+		std::string target;///<The name of the ShaderItemInfo to target (if this changes after the item has been uploaded, call Shader::PrepareUploadData again)
 		std::any data;	   ///<The data to upload
+
+		///@cond
+		//Which shader layout the target was last resolved against and where it is in that layout
+		const void* layout = nullptr;
+		std::size_t layoutIndex = 0;
+		///@endcond
 	};
 
 	///@brief Collection of items to upload to a shader
@@ -94,10 +100,11 @@ namespace Cacao {
 
 		/**
 		 * @brief Compile the raw SPIR-V code into a format that can be run by the GPU
+		 * @details When called off the rendering thread, the driver may compile in the background while frames keep rendering. The shader must not be destroyed before the returned future resolves.
 		 *
-		 * @return A future that will resolve when compilation is done
+		 * @return A future that will resolve when compilation and linking are done (already resolved if called on the rendering thread)
 		 *
-		 * @throws Exception If the shader was already compiled or the SPIR-V is invalid
+		 * @throws Exception If the shader was already compiled or is being compiled, or the SPIR-V is invalid
 		 */
 		std::shared_future<void> Compile() override;
 
@@ -117,6 +124,14 @@ namespace Cacao {
 			return bound;
 		}
 
+		/**
+		 * @brief Check if the shader is instanced
+		 * @details Instanced shaders take their transform from a per-instance mat4 vertex input at location 5 instead of CacaoLocals, so that objects sharing a mesh and material can be drawn all at once
+		 *
+		 * @return If the shader is instanced
+		 */
+		bool IsInstanced();
+
 		/**
 		 * @brief Get the shader spec
 		 *
@@ -128,6 +143,8 @@ namespace Cacao {
 
 		/**
 		 * @brief Upload data to the shader
+		 * @details Textures are bound right away and everything else is written into the shader's own copy of its data block, which is sent to the GPU once at the end.
+		 * Prefer a Material for anything drawn more than once, as it keeps its data on the GPU between draws.
 		 *
 		 * @warning Temporarily binds the shader, but previous shader is restored after
 		 *
@@ -137,6 +154,17 @@ namespace Cacao {
 		 */
 		void UploadData(ShaderUploadData& data);
 
+		/**
+		 * @brief Resolve the targets of upload data against this shader ahead of time
+		 * @details UploadData does this by itself the first time it sees an item, so this only moves that work somewhere more convenient.
+		 * After this, uploading the data is a straight loop with no lookups.
+		 *
+		 * @param data The data to prepare
+		 *
+		 * @throws Exception If an item targets something not in the shader specification or the shader was not compiled
+		 */
+		void PrepareUploadData(ShaderUploadData& data);
+
 		/**
 		 * @brief Upload engine global data
 		 *
@@ -165,6 +193,8 @@ namespace Cacao {
 		//Backend-implemented data type
 		struct ShaderData;
 
+		friend class Material;
+
 		bool bound;
 		std::shared_ptr<ShaderData> nativeData;
 		const ShaderSpec specification;
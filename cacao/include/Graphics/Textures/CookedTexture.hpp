@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Utilities/MappedFile.hpp"
+
+#include "glm/vec2.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace Cacao {
+	/**
+	 * @brief A cooked texture file mapped into memory
+	 * @details A cooked texture file holds an image's pixels, already flipped for the GPU, along with every level of its mip chain (generated offline with gamma-correct filtering).
+	 * Loading one only maps the file, so nothing is decoded and the pixels are read straight out of the mapping when uploaded.
+	 */
+	class CookedTexture {
+	  public:
+		/**
+		 * @brief One level of the mip chain, pointing into the mapped file
+		 */
+		struct Level {
+			glm::ivec2 size;		  ///<The size of the level in pixels
+			const unsigned char* data;///<The pixels of the level, tightly packed with 8 bits per channel
+			std::size_t bytes;		  ///<The size of the pixels in bytes
+		};
+
+		/**
+		 * @brief Map and validate a cooked texture file
+		 *
+		 * @param path The path to the cooked texture file
+		 *
+		 * @throws Exception If the file does not exist, could not be mapped, or is not a valid cooked texture file for this build
+		 */
+		CookedTexture(const std::string& path);
+
+		/**
+		 * @brief Get the size of the full-size image
+		 *
+		 * @return The size in pixels
+		 */
+		glm::ivec2 GetSize() const {
+			return levels[0].size;
+		}
+
+		/**
+		 * @brief Get the number of channels per pixel
+		 *
+		 * @return The channel count (1, 3, or 4)
+		 */
+		int GetChannels() const {
+			return channels;
+		}
+
+		/**
+		 * @brief Check if the color channels are sRGB-encoded
+		 *
+		 * @return Whether the texture should be sampled as sRGB
+		 */
+		bool IsSRGB() const {
+			return srgb;
+		}
+
+		/**
+		 * @brief Get the mip chain
+		 *
+		 * @return Every level from the full-size image down to 1x1
+		 */
+		const std::vector<Level>& GetLevels() const {
+			return levels;
+		}
+
+		/**
+		 * @brief Get where the cooked texture file for an image file goes
+		 *
+		 * @param filePath The path of the source image file
+		 *
+		 * @return The path of the cooked texture file
+		 */
+		static std::string GetCookedPath(const std::string& filePath) {
+			return filePath + ".ctex";
+		}
+
+		/**
+		 * @brief Check if a path names a cooked texture file
+		 *
+		 * @param filePath The path to check
+		 *
+		 * @return Whether the path has the cooked texture file extension
+		 */
+		static bool IsCookedPath(const std::string& filePath) {
+			return filePath.ends_with(".ctex");
+		}
+
+		/**
+		 * @brief Check if an image file has a cooked texture file that is newer than it
+		 * @details Cooked texture files in asset archives are always up to date, since stale ones are left out when packing.
+		 *
+		 * @param filePath The path of the source image file
+		 *
+		 * @return Whether there is an up-to-date cooked texture file
+		 */
+		static bool HasFreshCook(const std::string& filePath);
+
+		/**
+		 * @brief Find the cooked texture to use in place of a texture path, if there is one
+		 * @details Cooked texture file paths are mapped directly. Image file paths use the cooked texture file next to them if it is up to date,
+		 * falling back (with a warning) to the image file if it can't be used.
+		 *
+		 * @param filePath The path of an image file or cooked texture file
+		 *
+		 * @return The cooked texture, or nullptr if the image file should be decoded instead
+		 *
+		 * @throws Exception If the path names a cooked texture file that could not be loaded
+		 */
+		static std::shared_ptr<CookedTexture> Find(const std::string& filePath);
+
+		/**
+		 * @brief Write a cooked texture file
+		 * @details The mip chain is generated here, so this takes a while for large images.
+		 * The file is written next to the destination first and moved into place once complete, so it is never seen half-written.
+		 *
+		 * @param pixels The pixels of the image, bottom row first and tightly packed with 8 bits per channel
+		 * @param size The size of the image in pixels
+		 * @param channels The number of channels per pixel (1, 3, or 4)
+		 * @param srgb Whether the color channels are sRGB-encoded (ignored for single-channel images, which are always linear)
+		 * @param cookedPath The path to write to
+		 *
+		 * @throws Exception If the image has an unsupported channel count or the file could not be written
+		 */
+		static void Cook(const unsigned char* pixels, glm::ivec2 size, int channels, bool srgb, const std::string& cookedPath);
+
+	  private:
+		std::shared_ptr<MappedFile> file;
+		std::vector<Level> levels;
+		int channels;
+		bool srgb;
+	};
+}
@@ -17,13 +17,17 @@ namespace Cacao {
 		/**
 		 * @brief Create a new cubemap from a file list
 		 *
-		 * @param filePaths The paths to image files for each face. Must be in the order +X, -X, +Y, -Y, +Z, -Z
+		 * @details The faces are decoded right away, in parallel on the engine thread pool, so compiling only has to upload them.
+		 * Faces with an up-to-date cooked texture file next to them (or given as cooked texture files) are mapped instead, and bring their own mip chain.
+		 *
+		 * @param filePaths The paths to image files or cooked texture files for each face. Must be in the order +X, -X, +Y, -Y, +Z, -Z
+		 * @param mipmaps Whether to use a mip chain for the faces (optional, defaults to false)
 		 *
 		 * @note Prefer to use AssetManager::LoadCubemap over direct construction
 		 *
-		 * @throws Exception If any of the specified files does not exist
+		 * @throws Exception If any of the specified files does not exist or could not be decoded, or the faces are not all square and the same size and format
 		 */
-		Cubemap(std::vector<std::string> filePaths);
+		Cubemap(std::vector<std::string> filePaths, bool mipmaps = false);
 
 		/**
 		 * @brief Destroy the cubemap and its compiled data if applicable
@@ -69,6 +73,14 @@ namespace Cacao {
 		 */
 		void Release() override;
 
+		/**
+		 * @brief Estimate how much memory the cubemap takes up
+		 * @details Counts the decoded faces while they are held for uploading, and the faces (and their mip chains) on the GPU.
+		 *
+		 * @return The memory usage
+		 */
+		AssetMemoryUsage GetMemoryUsage() override;
+
 		///@brief Gets the type of this asset. Needed for safe downcasting from Asset
 		std::string GetType() override {
 			return "CUBEMAP";
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "glm/vec2.hpp"
+
+#include <vector>
+
+namespace Cacao {
+	/**
+	 * @brief One level of a mip chain
+	 */
+	struct MipLevel {
+		glm::ivec2 size;				///<The size of the level in pixels
+		std::vector<unsigned char> data;///<The pixels of the level, tightly packed with 8 bits per channel
+	};
+
+	/**
+	 * @brief Generate the smaller levels of a mip chain on the CPU
+	 * @details Each level halves the one before it (rounding down, but never below 1) with a box filter, down to 1x1.
+	 * Color channels of sRGB images are averaged in linear space so that mips don't get darker. Alpha is always linear.
+	 *
+	 * @param data The pixels of the full-size image, tightly packed with 8 bits per channel
+	 * @param size The size of the full-size image in pixels
+	 * @param channels The number of channels per pixel (1-4)
+	 * @param srgb Whether the color channels are sRGB-encoded
+	 *
+	 * @return The levels after the full-size image, from largest to smallest
+	 */
+	std::vector<MipLevel> GenerateMipChain(const unsigned char* data, glm::ivec2 size, int channels, bool srgb);
+}
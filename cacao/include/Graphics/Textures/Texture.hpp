@@ -30,6 +30,16 @@ namespace Cacao {
 		 */
 		virtual void Unbind() {}
 
+		/**
+		 * @brief Note how large the texture is drawn this frame
+		 * @details Textures that stream their mip levels in use this to decide how much detail to keep. Others ignore it.
+		 *
+		 * @param screenSize How many pixels across the texture covers on screen
+		 *
+		 * @note For use by the engine only. Safe to call from any thread.
+		 */
+		virtual void RequestDetail(float screenSize) {}
+
 		/**
 		 * @brief Check if the texture is bound
 		 *
@@ -15,12 +15,14 @@ namespace Cacao {
 	  public:
 		/**
 		 * @brief Create a new texture from a file
+		 * @details If the image file has an up-to-date cooked texture file next to it, that is mapped instead of decoding the image.
 		 *
-		 * @param filePath The path to an image file
+		 * @param filePath The path to an image file or cooked texture file
 		 *
 		 * @note Prefer to use AssetManager::LoadTexture2D over direct construction
 		 *
 		 * @throws Exception If the file does not exist or could not be opened
+		 * @see CookedTexture
 		 */
 		Texture2D(std::string filePath);
 
@@ -30,7 +32,6 @@ namespace Cacao {
 		~Texture2D() final {
 			if(bound) Unbind();
 			if(compiled) Release();
-			delete dataBuffer;
 		}
 
 		/**
@@ -53,10 +54,25 @@ namespace Cacao {
 		 */
 		void Unbind() override;
 
+		/**
+		 * @brief Note how large the texture is drawn this frame
+		 * @details Only textures loaded from large cooked textures stream their mip levels, others ignore this
+		 *
+		 * @param screenSize How many pixels across the texture covers on screen
+		 *
+		 * @note For use by the engine only. Safe to call from any thread.
+		 */
+		void RequestDetail(float screenSize) override;
+
 		/**
 		 * @brief Compile the raw image data into a format that can be sampled by the GPU
+		 * @details The image is streamed to the GPU over as many frames as the upload budget (EngineConfig::textureUploadBudget) requires.
+		 * The texture counts as compiled right away and can be bound, but it samples as black until the future resolves.
+		 * Once it does, the decoded image (or cooked texture file mapping) is let go of, and is loaded again if the texture is recompiled after being released.
+		 * Cooked textures upload their precomputed mip chain, while decoded images have their mipmaps generated by the GPU.
+		 * Large cooked textures only upload their smallest levels here, with the more detailed ones streamed in later as RequestDetail asks for them.
 		 *
-		 * @return A future that will resolve when compilation is done
+		 * @return A future that will resolve when the whole image, including mipmaps, is on the GPU
 		 *
 		 * @throws Exception If the texture was already compiled
 		 */
@@ -64,11 +80,20 @@ namespace Cacao {
 
 		/**
 		 * @brief Delete the compiled data
+		 * @details If the image was still streaming to the GPU, the future returned by Compile is given an exception.
 		 *
 		 * @throws Exception If the texture was not compiled or is bound
 		 */
 		void Release() override;
 
+		/**
+		 * @brief Estimate how much memory the texture takes up
+		 * @details Counts the decoded image while it is held for uploading, and the mip levels allocated on the GPU (including streamed ones).
+		 *
+		 * @return The memory usage
+		 */
+		AssetMemoryUsage GetMemoryUsage() override;
+
 		///@brief Gets the type of this asset. Needed for safe downcasting from Asset
 		std::string GetType() override {
 			return "2DTEX";
@@ -78,7 +103,6 @@ namespace Cacao {
 		//Backend-implemented data type
 		struct Tex2DData;
 
-		unsigned char* dataBuffer;
 		glm::ivec2 imgSize;
 		int numImgChannels;
 
@@ -1,8 +1,21 @@
 #pragma once
 
 #include "World/Component.hpp"
+#include "World/ComponentStore.hpp"
+
+#include <vector>
 
 namespace Cacao {
+	/**
+	 * @brief Phases of a tick
+	 * @details Every script in a phase finishes running before any script in the next phase starts
+	 */
+	enum class TickPhase {
+		Early, ///<Runs first (e.g. gathering input)
+		Update,///<The default phase
+		Late   ///<Runs last (e.g. following other entities after they've moved)
+	};
+
 	/**
 	 * @brief Base class for a script
 	 */
@@ -17,7 +30,9 @@ namespace Cacao {
 
 		/**
 		 * @brief Runs every fixed tick
-		 * @warning Fixed ticks are not yet implemented in the engine
+		 * @details Fixed ticks happen at a constant rate (see EngineConfig::fixedTickRate) regardless of how long dynamic ticks take, so the timestep is always 1 / fixedTickRate seconds
+		 *
+		 * @note Fixed ticks run on the same thread as dynamic ticks, before OnTick
 		 */
 		virtual void OnFixedTick() {}
 
@@ -37,6 +52,7 @@ namespace Cacao {
 		void SetActive(bool val) override final {
 			bool prevActive = this->IsActive();
 			_SetActiveInternal(val);
+			ComponentStore::BumpVersion();
 			if(this->IsActive() && !prevActive) {
 				OnActivate();
 				return;
@@ -47,9 +63,12 @@ namespace Cacao {
 			}
 		}
 
+		///@brief Component kind of all scripts (used for World::Each queries)
+		static constexpr const char* kind = "SCRIPT";
+
 		///@brief Gets the type of this componet. Needed for safe downcasting from Component
 		std::string GetKind() override final {
-			return "SCRIPT";
+			return kind;
 		}
 
 		/**
@@ -62,5 +81,62 @@ namespace Cacao {
 
 		//Virtual destructor
 		virtual ~Script() {}
+
+	  protected:
+		/**
+		 * @brief Allow this script to run at the same time as other scripts
+		 * @details Parallel scripts are spread over the engine thread pool.
+		 * A parallel script always has exclusive access to its own entity (scripts on the same entity never run at the same time), but any components or transforms of other entities it uses must be declared with DeclareRead and DeclareWrite.
+		 * Scripts that declare a kind never run alongside parallel scripts on entities with a component of that kind, and every entity has a Transform.
+		 * An entity's world transform depends on its parents' transforms, so reading it counts as reading Transform.
+		 *
+		 * @note Call this from the constructor
+		 *
+		 * @param value Whether this script may run in parallel
+		 */
+		void SetParallel(bool value) {
+			parallel = value;
+		}
+
+		/**
+		 * @brief Set the phase of the tick that this script runs in
+		 *
+		 * @note Call this from the constructor
+		 *
+		 * @param value The new tick phase
+		 */
+		void SetTickPhase(TickPhase value) {
+			phase = value;
+		}
+
+		/**
+		 * @brief Declare that this script reads components of a type on other entities
+		 * @details The type can be a component type with a static "kind" member or Transform
+		 *
+		 * @note Call this from the constructor
+		 */
+		template<typename T>
+		void DeclareRead() {
+			reads.push_back(KindIDOf<T>());
+		}
+
+		/**
+		 * @brief Declare that this script modifies components of a type on other entities
+		 * @details The type can be a component type with a static "kind" member or Transform
+		 *
+		 * @note Call this from the constructor
+		 */
+		template<typename T>
+		void DeclareWrite() {
+			writes.push_back(KindIDOf<T>());
+		}
+
+	  private:
+		//Scheduling information
+		bool parallel = false;
+		TickPhase phase = TickPhase::Update;
+		std::vector<uint32_t> reads, writes;
+
+		friend class DynTickController;
 	};
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/Asset.hpp"
+#include "Utilities/MappedFile.hpp"
 
 #include "hb.h"
 #include "ft2build.h"
@@ -53,6 +54,9 @@ namespace Cacao {
 		//Path to font file
 		std::string filePath;
 
+		//Font file contents (FreeType reads from these for as long as the face exists)
+		std::shared_ptr<MappedFile> file;
+
 		//FreeType font face
 		FT_Face face;
 
@@ -5,8 +5,15 @@
 #include <memory>
 #include <string>
 #include <future>
+#include <cstddef>
 
 namespace Cacao {
+	///@brief How much memory an asset takes up
+	struct AssetMemoryUsage {
+		std::size_t cpu;///<Bytes of system memory
+		std::size_t gpu;///<Bytes of GPU memory
+	};
+
 	/**
 	 * @brief Base asset type
 	 */
@@ -42,6 +49,17 @@ namespace Cacao {
 			return compiled;
 		}
 
+		/**
+		 * @brief Estimate how much memory the asset takes up
+		 * @details Counts the asset's own data (e.g. decoded pixels or GPU buffers), not anything the driver or other libraries allocate behind it.
+		 * Safe to call from any thread, including while the asset is compiling.
+		 *
+		 * @return The memory usage (none for the base asset)
+		 */
+		virtual AssetMemoryUsage GetMemoryUsage() {
+			return {0, 0};
+		}
+
 		///@brief Get the asset type (not useful here because this is the base asset)
 		virtual std::string GetType() {
 			return "N/A";
@@ -58,13 +76,9 @@ namespace Cacao {
 		  : compiled(initiallyCompiled) {}
 	};
 
-	//Actually runs the uncaching, can't be implemented here due to cyclical references
-	namespace _AH {
-		void _AM_Uncache_AHID(std::string id);
-	}
-
 	/**
 	 * @brief Reference-counted handle to an asset
+	 * @details The asset manager notices when the last handle (or shared_ptr) to one of its assets goes away, so handles don't need to tell it
 	 */
 	template<typename T>
 	class AssetHandle {
@@ -89,16 +103,6 @@ namespace Cacao {
 		AssetHandle()
 		  : asset(nullptr), id("nullptr_HANDLE_DONT_USE_ME"), isNullHandle(true) {}
 
-		/**
-		 * @brief Destroy the asset handle
-		 * @details If this was the last reference to the asset, uncache it
-		 */
-		~AssetHandle() {
-			if(asset.use_count() == 1) {
-				_AH::_AM_Uncache_AHID(id);
-			}
-		}
-
 		/**
 		 * @brief Access the underlying shared_ptr
 		 * @details This is done so the AssetHandle can act in place of the shared_ptr
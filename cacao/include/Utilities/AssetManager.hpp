@@ -11,10 +11,43 @@
 #include "Asset.hpp"
 
 #include <future>
+#include <functional>
+#include <exception>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <map>
+#include <list>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 namespace Cacao {
+	///@brief Counters for how asset loads were served (not counting imports of model files, which the mesh loads are counted instead of)
+	struct AssetCacheStats {
+		uint64_t hits;	///<Loads of an asset that was already loaded
+		uint64_t misses;///<Loads that had to load the asset
+		uint64_t joins; ///<Loads that joined one already in progress for the same asset instead of loading it again
+	};
+
+	///@brief How much of one type of asset is in memory
+	struct AssetResidency {
+		std::size_t liveCount;	   ///<Assets that something still holds
+		AssetMemoryUsage live;	   ///<Memory taken up by those (as of when they finished loading)
+		std::size_t releasedCount; ///<Assets nothing holds anymore, kept in case they're loaded again
+		AssetMemoryUsage released; ///<Memory taken up by those (as of when they were released)
+		std::size_t budget;		   ///<Bytes (system and GPU memory together) this type may take up before released assets are evicted
+	};
+
 	/**
 	 * @brief Manages the loading of assets and the asset cache
+	 * @details Files are read and decoded on the engine thread pool and anything the GPU needs is uploaded on the render thread afterwards.
+	 * The futures returned by the loading methods resolve once the asset is fully ready, but no pool thread waits for the upload to happen.
+	 * Loading an asset that is already loading waits on that load rather than starting another.
+	 *
+	 * Assets that nothing holds anymore (through asset handles or plain shared_ptrs alike) aren't dropped right away. They are kept, least recently released first in line for eviction,
+	 * until their type takes up more than its memory budget, so loading them again shortly after (e.g. across a level change) is a cache hit.
 	 */
 	class AssetManager {
 	  public:
@@ -74,11 +107,29 @@ namespace Cacao {
 		 *
 		 * @param location The location to retrieve the mesh from
 		 *
+		 * @note Loads of meshes from the same model file share one import of it, which is kept around afterwards like a released asset (of type "MODEL") so that loading more of its meshes later doesn't import it again
+		 * @note If the model file has a cooked model file newer than it, that is mapped instead of importing the model file
+		 *
 		 * @throws Exception If the location parameter has the wrong format, the model file does not exist, the model fails to load, the model does not contain the requested mesh, or the mesh fails to compile
-		 * @see Model::Model,Mesh::Compile
+		 * @see Model::Model,Model::LoadCooked,Mesh::Compile,LoadModel
 		 */
 		std::future<AssetHandle<Mesh>> LoadMesh(std::string location);
 
+		/**
+		 * @brief Load every mesh in a model file
+		 * @details The file is imported once and each mesh is cached under the same ID LoadMesh would use ((model file path):(mesh name)), so meshes already loaded are reused.
+		 * Loads of the same file, including ones by LoadMesh, share one import, which is kept around afterwards like a released asset (of type "MODEL").
+		 * Like LoadMesh, an up-to-date cooked model file is used instead of the model file if there is one.
+		 *
+		 * @param path The path to a model file
+		 *
+		 * @return A future resolving to a handle to each mesh, by mesh name
+		 *
+		 * @throws Exception If the model file does not exist, the model fails to load, or a mesh fails to compile
+		 * @see Model::Model,Mesh::Compile
+		 */
+		std::future<std::map<std::string, AssetHandle<Mesh>>> LoadModel(std::string path);
+
 		/**
 		 * @brief Load a sound from a file
 		 * @details Supports MP3, WAV, Ogg Vorbis, and Ogg Opus files
@@ -100,20 +151,71 @@ namespace Cacao {
 		std::future<AssetHandle<Font>> LoadFont(std::string path);
 
 		/**
-		 * @brief Remove an asset from the cache
-		 *
-		 * @note For use by the engine only
+		 * @brief Remove an asset from the cache right away if nothing holds it anymore
+		 * @details Assets that are still loading or still held by something are kept
 		 *
 		 * @param assetID The ID of the asset to remove from the cache
+		 */
+		void UncacheAsset(std::string assetID);
+
+		/**
+		 * @brief Set how much memory an asset type may take up
+		 * @details Live and released assets of the type both count towards the budget, but only released ones are evicted to stay under it.
+		 * Assets are evicted right away if the new budget is lower.
 		 *
-		 * @throws Exception If the specified asset ID does not exist in the cache
+		 * @param type The asset type (as returned by Asset::GetType)
+		 * @param bytes The budget in bytes of system and GPU memory together
 		 */
-		void UncacheAsset(std::string assetID) {
-			if(!assetCache.contains(assetID)) {
-				Logging::EngineLog("Uncaching of asset not in asset cache requested, ignoring...");
-				return;
-			}
-			assetCache.erase(assetID);
+		void SetMemoryBudget(const std::string& type, std::size_t bytes);
+
+		/**
+		 * @brief Get how much memory an asset type may take up
+		 *
+		 * @param type The asset type (as returned by Asset::GetType)
+		 *
+		 * @return The budget in bytes, which is EngineConfig::assetMemoryBudget unless one was set for the type
+		 */
+		std::size_t GetMemoryBudget(const std::string& type);
+
+		/**
+		 * @brief Get how much of each type of asset is in memory
+		 *
+		 * @return The residency of each asset type that has been loaded, by type
+		 */
+		std::map<std::string, AssetResidency> GetResidency();
+
+		/**
+		 * @brief Drop every released asset right away
+		 * @details Useful before a memory-hungry stretch of a game, and done by the engine at shutdown
+		 */
+		void ClearReleased();
+
+		/**
+		 * @brief Set the vertex format meshes are loaded in
+		 * @details Meshes are packed into it on the thread pool before being compiled. Meshes that are already loaded keep the format they were loaded in.
+		 *
+		 * @param format The vertex format
+		 */
+		void SetVertexFormat(VertexFormat format) {
+			vertexFormat = format;
+		}
+
+		/**
+		 * @brief Get the vertex format meshes are loaded in
+		 *
+		 * @return The vertex format
+		 */
+		VertexFormat GetVertexFormat() const {
+			return vertexFormat;
+		}
+
+		/**
+		 * @brief Get the asset cache counters
+		 *
+		 * @return How loads have been served since the asset manager was created
+		 */
+		AssetCacheStats GetCacheStats() const {
+			return AssetCacheStats {.hits = hits.load(), .misses = misses.load(), .joins = joins.load()};
 		}
 
 	  private:
@@ -121,9 +223,146 @@ namespace Cacao {
 		static AssetManager* instance;
 		static bool instanceExists;
 
+		//Called with the asset (or the exception that stopped it) when a load finishes
+		using LoadCallback = std::function<void(std::shared_ptr<Asset>, std::exception_ptr)>;
+
+		//Cache entry for an asset that is loaded or still loading
+		struct CacheEntry {
+			//The asset itself, and the pointer to it that is handed out (which tells us when nothing holds the asset anymore instead of destroying it)
+			std::shared_ptr<Asset> owned;
+			std::weak_ptr<Asset> asset;
+			bool loading;
+
+			//Memory the asset took up when last counted, and whether that is in its type's live totals
+			AssetMemoryUsage usage;
+			bool counted;
+
+			//Everyone waiting on the load
+			std::vector<LoadCallback> waiters;
+		};
+
+		//Part of the asset cache with its own lock, so that loads of different assets rarely contend
+		//Entries are keyed by ID and type because the same file can be loaded as different asset types
+		struct CacheShard {
+			std::mutex mtx;
+			std::map<std::pair<std::string, std::string>, CacheEntry> entries;
+		};
+
 		//Asset cache
-		std::map<std::string, std::weak_ptr<Asset>> assetCache;
+		static constexpr std::size_t shardCount = 16;
+		std::array<CacheShard, shardCount> cache;
+
+		//An asset kept around after nothing held it anymore (its cache entry keeps it alive)
+		struct ReleasedAsset {
+			std::pair<std::string, std::string> key;
+			AssetMemoryUsage usage;
+		};
+
+		//Memory accounting for one asset type
+		struct TypeResidency {
+			std::size_t liveCount = 0;
+			AssetMemoryUsage live {0, 0};
+			AssetMemoryUsage released {0, 0};
+
+			//Released assets, least recently released first
+			std::list<ReleasedAsset> lru;
+
+			//Budget override, if one was set
+			std::size_t budget = 0;
+			bool hasBudget = false;
+		};
+
+		//Residency state
+		//Locked after (never before) a cache shard when both are needed
+		std::mutex residencyMtx;
+		std::map<std::string, TypeResidency> residency;
+		std::map<std::pair<std::string, std::string>, std::list<ReleasedAsset>::iterator> releasedIndex;
+
+		//Cache counters
+		std::atomic_uint64_t hits, misses, joins;
+
+		//Vertex format for loaded meshes
+		std::atomic<VertexFormat> vertexFormat;
+
+		AssetManager()
+		  : hits(0), misses(0), joins(0), vertexFormat(VertexFormat::Full) {}
+
+		CacheShard& GetShard(const std::string& id);
+
+		//Look up an asset, registering onLoaded to get it, and count how it was served unless told not to
+		//Returns true if the caller has to load it and call FinishLoad, or false if it was cached or is already being loaded
+		bool BeginLoad(const std::string& id, const std::string& type, LoadCallback onLoaded, bool tally = true);
+
+		//Cache the result of a load and hand it to everyone waiting on it
+		void FinishLoad(const std::string& id, const std::string& type, std::shared_ptr<Asset> asset, std::exception_ptr err);
+
+		//Add an asset to or remove it from its type's live totals (residencyMtx must be held)
+		void CountLive(const std::string& type, AssetMemoryUsage usage, bool add);
+
+		//Get a type's budget (residencyMtx must be held)
+		std::size_t GetBudgetLocked(const std::string& type);
+
+		//Get the pointer handed out for a loaded asset, making a new one and taking the asset back out of the released assets if nothing holds it (its shard's lock must be held)
+		//The caller must not drop the pointer until it has unlocked the shard
+		std::shared_ptr<Asset> Share(const std::pair<std::string, std::string>& key, CacheEntry& entry);
+
+		//Called once nothing holds an asset anymore to keep it around as a released asset (with no locks held)
+		void Release(const std::pair<std::string, std::string>& key);
+
+		//Evict released assets of a type until it is back under budget (with no locks held)
+		void Trim(const std::string& type);
+
+		//Drop evicted assets' cache entries and destroy them, skipping ones that were loaded again while being evicted (with no locks held)
+		void Evict(std::vector<ReleasedAsset>& evicted);
+
+		//Start a load, running the first stage on the thread pool if it isn't cached or already loading
+		template<typename T>
+		std::future<AssetHandle<T>> StartLoad(const std::string& id, const std::string& type, std::function<void()> load);
+
+		//Start compiling an asset and finish its load on the render thread once compiling is done
+		void UploadThen(const std::string& id, const std::string& type, std::shared_ptr<Asset> asset);
+
+		//An imported model file, cached like an asset so that loading more of its meshes later doesn't import it again
+		//Each mesh is handed out once, since it is compiled afterwards, and the file is imported again if a mesh that was already handed out is needed again
+		class CachedModel final : public Asset {
+		  public:
+			//Import the model file, or map its cooked model file if that is up to date
+			CachedModel(const std::string& path);
+
+			//List the meshes in the model, including ones already handed out
+			std::vector<std::string> ListMeshes() const {
+				return names;
+			}
+
+			//Check if the model contains a mesh
+			bool HasMesh(const std::string& name) const {
+				return std::find(names.cbegin(), names.cend(), name) != names.cend();
+			}
+
+			//Hand out a mesh, importing the file again first if it was already handed out
+			std::shared_ptr<Mesh> TakeMesh(const std::string& name);
+
+			//The meshes not yet handed out
+			AssetMemoryUsage GetMemoryUsage() override;
+
+			std::string GetType() override {
+				return "MODEL";
+			}
+
+		  private:
+			std::string path;
+			std::vector<std::string> names;
+
+			std::mutex mtx;
+			std::map<std::string, std::shared_ptr<Mesh>> meshes;
+
+			void Import();
+		};
+
+		//Called with the model (or the exception that stopped it) when an import finishes
+		using ImportCallback = std::function<void(std::shared_ptr<CachedModel>, std::exception_ptr)>;
 
-		AssetManager() {}
+		//Import a model on the calling thread, or reuse the cached import (or wait on the one in progress)
+		void ImportModel(const std::string& path, ImportCallback onImported);
 	};
 }
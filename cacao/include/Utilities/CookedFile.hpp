@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <cstddef>
+
+namespace Cacao {
+	///@brief Alignment of each block of data in a cooked file (cooked model and texture files), so that it can be used straight out of a mapping
+	constexpr std::size_t cookedAlignment = 16;
+
+	/**
+	 * @brief Round an offset in a cooked file up to the next aligned one
+	 *
+	 * @param offset The offset
+	 *
+	 * @return The aligned offset
+	 */
+	constexpr std::size_t AlignCooked(std::size_t offset) {
+		return (offset + cookedAlignment - 1) & ~(cookedAlignment - 1);
+	}
+
+	/**
+	 * @brief Check if a cooked file is up to date with the file it was cooked from
+	 * @details Cooked files in asset archives are always up to date, since stale ones are left out when packing.
+	 *
+	 * @param cookedPath The path of the cooked file
+	 * @param sourcePath The path of the file it was cooked from
+	 *
+	 * @return Whether the cooked file exists and is newer than its source file
+	 */
+	bool IsCookFresh(const std::string& cookedPath, const std::string& sourcePath);
+
+	/**
+	 * @brief Writes a cooked file
+	 * @details The file is written next to the destination first and moved into place by Finish, so nobody maps a half-written one.
+	 * If the writer is destroyed without finishing, the partial file is deleted.
+	 */
+	class CookedFileWriter {
+	  public:
+		/**
+		 * @brief Start writing a cooked file
+		 *
+		 * @param path The path to write to
+		 * @param kind What sort of cooked file this is, for error messages (e.g. "cooked model file")
+		 *
+		 * @throws Exception If the file could not be opened
+		 */
+		CookedFileWriter(const std::string& path, const std::string& kind);
+
+		/**
+		 * @brief Delete the partial file if the cooked file was not finished
+		 */
+		~CookedFileWriter();
+
+		/**
+		 * @brief Write data at the current position
+		 *
+		 * @param data The data
+		 * @param size The size of the data in bytes
+		 */
+		void Write(const void* data, std::size_t size);
+
+		/**
+		 * @brief Pad with zeros up to an offset
+		 *
+		 * @param offset The offset to pad to, which must be at most one alignment past the current position (as returned by AlignCooked)
+		 */
+		void PadTo(std::size_t offset);
+
+		/**
+		 * @brief Finish writing and move the file into place
+		 *
+		 * @throws Exception If anything failed to be written
+		 */
+		void Finish();
+
+	  private:
+		std::string path, tempPath, kind;
+		std::ofstream out;
+		bool finished;
+	};
+}
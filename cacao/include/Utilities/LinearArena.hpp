@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+namespace Cacao {
+	/**
+	 * @brief Bump allocator for short-lived data that is all thrown away at once
+	 * @details Allocations are carved out of one block and freed together by Reset.
+	 * If a round of allocations doesn't fit, the overflow goes to separate blocks and the main block grows on the next reset,
+	 * so once the arena has seen its largest round it stops touching the heap entirely.
+	 *
+	 * @note Not thread-safe
+	 */
+	class LinearArena {
+	  public:
+		LinearArena()
+		  : capacity(0), offset(0), overflowSize(0), allocations(0) {}
+
+		///@brief Copying is banned
+		LinearArena(const LinearArena&) = delete;
+
+		///@brief Copy-assignment is banned
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		/**
+		 * @brief Allocate and value-initialize an array
+		 *
+		 * @param count The number of elements
+		 *
+		 * @return The first element, valid until the next reset
+		 *
+		 * @note Destructors are never run, so only trivially destructible types are allowed
+		 */
+		template<typename T>
+		T* Allocate(std::size_t count) {
+			static_assert(std::is_trivially_destructible_v<T>, "Arena memory is never destroyed, so only trivially destructible types can live in it!");
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types can't be allocated from an arena!");
+			T* mem = static_cast<T*>(AllocateBytes(sizeof(T) * count, alignof(T)));
+			std::uninitialized_value_construct_n(mem, count);
+			return mem;
+		}
+
+		/**
+		 * @brief Free everything allocated since the last reset
+		 * @details If the last round overflowed, the main block is regrown to fit it
+		 */
+		void Reset();
+
+		/**
+		 * @brief Get how many times the arena has gone to the heap
+		 *
+		 * @return The number of heap allocations made since the arena was created
+		 */
+		std::size_t GetAllocationCount() const {
+			return allocations;
+		}
+
+	  private:
+		std::unique_ptr<std::byte[]> block;
+		std::size_t capacity, offset;
+
+		//Blocks for allocations that didn't fit in this round
+		std::vector<std::unique_ptr<std::byte[]>> overflow;
+		std::size_t overflowSize;
+
+		std::size_t allocations;
+
+		void* AllocateBytes(std::size_t size, std::size_t align);
+	};
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace Cacao {
+	/**
+	 * @brief A read-only view of a whole file mapped into memory
+	 * @details The operating system pages the file in as it is read, so nothing is copied up front and the contents are never duplicated on the heap.
+	 * The view stays valid for as long as the object lives.
+	 *
+	 * Files inside asset archives are views into the archive's mapping instead (or, for compressed ones, hold their inflated contents).
+	 * @see VFS
+	 */
+	class MappedFile {
+	  public:
+		/**
+		 * @brief Map a file
+		 *
+		 * @param path The path to the file
+		 *
+		 * @throws Exception If the file does not exist or could not be mapped
+		 */
+		MappedFile(const std::string& path);
+
+		/**
+		 * @brief View part of another mapped file, keeping it mapped
+		 *
+		 * @param parent The mapped file the view lies within
+		 * @param offset The byte offset of the view
+		 * @param size The size of the view in bytes
+		 */
+		MappedFile(std::shared_ptr<const MappedFile> parent, std::size_t offset, std::size_t size);
+
+		/**
+		 * @brief Hold file contents that were read into memory
+		 *
+		 * @param contents The contents
+		 */
+		MappedFile(std::vector<unsigned char>&& contents);
+
+		/**
+		 * @brief Unmap the file
+		 */
+		~MappedFile();
+
+		///@brief Copying is banned
+		MappedFile(const MappedFile&) = delete;
+
+		///@brief Copy-assignment is banned
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/**
+		 * @brief Get the file contents
+		 *
+		 * @return The first byte of the file (nullptr for an empty file)
+		 */
+		const unsigned char* GetData() const {
+			return data;
+		}
+
+		/**
+		 * @brief Get the size of the file
+		 *
+		 * @return The size in bytes
+		 */
+		std::size_t GetSize() const {
+			return size;
+		}
+
+	  private:
+		const unsigned char* data;
+		std::size_t size;
+
+		//Mapping object handle (only used on Windows)
+		void* mapping;
+
+		//What the data actually belongs to when it isn't our own mapping
+		std::shared_ptr<const MappedFile> parent;
+		std::vector<unsigned char> contents;
+		bool owned;
+	};
+}
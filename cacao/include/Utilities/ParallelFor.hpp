@@ -0,0 +1,21 @@
+#pragma once
+
+#include <functional>
+#include <cstddef>
+
+namespace Cacao {
+	/**
+	 * @brief Run a function over a range of indices using the engine thread pool
+	 * @details The range is split into chunks that pool threads and the calling thread pick up until none are left.
+	 * Because the calling thread also works through chunks, this is safe to call from a pool thread and never waits on a busy pool.
+	 *
+	 * @param count The number of indices (the range is [0, count))
+	 * @param body The function to run, called with the start (inclusive) and end (exclusive) of a chunk
+	 * @param grain The number of indices per chunk (0 to pick one based on the pool size)
+	 *
+	 * @note Blocks until the whole range has been processed
+	 *
+	 * @throws Exception Rethrows the first exception thrown by the body, after all chunks have finished
+	 */
+	void ParallelFor(std::size_t count, std::function<void(std::size_t, std::size_t)> body, std::size_t grain = 0);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+namespace Cacao {
+	/**
+	 * @brief Lock-free triple buffer for handing the latest value from one producer thread to one consumer thread
+	 * @details The producer always has a buffer to write into and the consumer always gets the most recently published one.
+	 * Values published while the consumer is busy replace each other, so the consumer never falls behind.
+	 * The three values are reused rather than reallocated, so containers inside them keep their capacity.
+	 *
+	 * @note Only one thread may write and only one thread may read
+	 */
+	template<typename T>
+	class TripleBuffer {
+	  public:
+		TripleBuffer()
+		  : writeIdx(0), readIdx(1), middle(2) {}
+
+		///@brief Copying is banned
+		TripleBuffer(const TripleBuffer&) = delete;
+
+		///@brief Copy-assignment is banned
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		/**
+		 * @brief Get the buffer for the producer to write into
+		 *
+		 * @return The write buffer, which still holds whatever was last written to it
+		 */
+		T& GetWriteBuffer() {
+			return buffers[writeIdx];
+		}
+
+		/**
+		 * @brief Publish the write buffer to the consumer
+		 * @details The producer gets a different buffer to write into afterwards
+		 */
+		void Publish() {
+			//Swap the write buffer into the middle, marking it as fresh
+			uint8_t old = middle.exchange(writeIdx | freshBit, std::memory_order_acq_rel);
+			writeIdx = old & indexMask;
+		}
+
+		/**
+		 * @brief Take the most recently published buffer for reading, if there is a new one
+		 *
+		 * @return If a new buffer was published since the last call
+		 */
+		bool Acquire() {
+			//Nothing new
+			if(!(middle.load(std::memory_order_acquire) & freshBit)) return false;
+
+			//Swap the read buffer into the middle (no longer fresh)
+			uint8_t old = middle.exchange(readIdx, std::memory_order_acq_rel);
+			readIdx = old & indexMask;
+			return true;
+		}
+
+		/**
+		 * @brief Check if a published buffer is waiting to be acquired
+		 *
+		 * @return If there is a new buffer
+		 */
+		bool HasNew() {
+			return middle.load(std::memory_order_acquire) & freshBit;
+		}
+
+		/**
+		 * @brief Drop any published buffer that hasn't been acquired yet
+		 */
+		void Discard() {
+			middle.fetch_and(indexMask, std::memory_order_acq_rel);
+		}
+
+		/**
+		 * @brief Get the buffer the consumer last acquired
+		 *
+		 * @return The read buffer
+		 */
+		T& GetReadBuffer() {
+			return buffers[readIdx];
+		}
+
+	  private:
+		static constexpr uint8_t indexMask = 0x3;
+		static constexpr uint8_t freshBit = 0x4;
+
+		std::array<T, 3> buffers;
+
+		//Indices owned by the producer and consumer respectively
+		uint8_t writeIdx, readIdx;
+
+		//Index of the buffer in between, plus whether it was published since the consumer last took it
+		std::atomic_uint8_t middle;
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <shared_mutex>
+
+namespace Cacao {
+	/**
+	 * @brief The virtual filesystem assets are read through
+	 * @details Asset archives can be mounted to serve files from one memory-mapped pack instead of opening each one from disk.
+	 * Paths are looked up in the mounted archives first (most recently mounted first), and fall back to the disk if no archive has them.
+	 * Archived paths are relative to the working directory, just like the loose files they replace, so asset paths work the same either way.
+	 *
+	 * Archives are made with scripts/pack.py. See the page "Bundles" in the manual for details.
+	 */
+	class VFS {
+	  public:
+		/**
+		 * @brief Get the instance and create one if there isn't one
+		 *
+		 * @return The instance
+		 */
+		static VFS* GetInstance();
+
+		/**
+		 * @brief Mount an asset archive
+		 * @details The archive is mapped into memory and its index is checked, but no file in it is read until it is opened
+		 *
+		 * @param archivePath The path to the archive on disk
+		 *
+		 * @throws Exception If the archive does not exist, could not be mapped, or is not a valid asset archive
+		 */
+		void Mount(const std::string& archivePath);
+
+		/**
+		 * @brief Unmount every asset archive
+		 * @details Files already opened from them stay valid
+		 */
+		void UnmountAll();
+
+		/**
+		 * @brief Check if a file exists in a mounted archive or on disk
+		 *
+		 * @param path The path to check
+		 *
+		 * @return Whether the file exists
+		 */
+		bool Exists(const std::string& path);
+
+		/**
+		 * @brief Check if a file comes from a mounted archive
+		 *
+		 * @param path The path to check
+		 *
+		 * @return Whether a mounted archive has the file
+		 */
+		bool IsArchived(const std::string& path);
+
+		/**
+		 * @brief Open a file
+		 * @details Files stored uncompressed in an archive and loose files are mapped, so nothing is copied.
+		 * Compressed files are inflated into memory.
+		 *
+		 * @param path The path to the file
+		 *
+		 * @return The file contents
+		 *
+		 * @throws Exception If the file does not exist, could not be mapped, or could not be inflated
+		 */
+		std::shared_ptr<MappedFile> Open(const std::string& path);
+
+		/**
+		 * @brief Read a whole file as text
+		 *
+		 * @param path The path to the file
+		 *
+		 * @return The file contents
+		 *
+		 * @throws Exception If the file could not be opened
+		 * @see Open
+		 */
+		std::string ReadText(const std::string& path);
+
+	  private:
+		//Singleton members
+		static VFS* instance;
+		static bool instanceExists;
+
+		//A mounted archive
+		struct Archive;
+
+		//Mounted archives, most recently mounted last
+		std::shared_mutex mtx;
+		std::vector<std::shared_ptr<Archive>> archives;
+
+		VFS() {}
+	};
+}
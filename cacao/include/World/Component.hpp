@@ -68,6 +68,11 @@ namespace Cacao {
 			this->owner = owner;
 		}
 
+		//Kind ID (resolved from GetKind when mounted) and index in the world's component store
+		uint32_t kindID;
+		std::size_t storeSlot;
+
 		friend Entity;
+		friend class ComponentStore;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "Component.hpp"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+namespace Cacao {
+	/**
+	 * @brief Get the numeric ID for a component kind
+	 * @details IDs are handed out the first time a kind is seen and stay the same for the lifetime of the program
+	 *
+	 * @param kind The kind string (as returned by Component::GetKind)
+	 *
+	 * @return The kind ID
+	 */
+	uint32_t GetComponentKindID(const std::string& kind);
+
+	/**
+	 * @brief Get the kind ID of a queryable type
+	 * @details Works for component types that declare a static "kind" member and for Transform
+	 *
+	 * @return The kind ID
+	 */
+	template<typename T>
+	uint32_t KindIDOf() {
+		if constexpr(std::is_same_v<T, Transform>) {
+			static const uint32_t id = GetComponentKindID("TRANSFORM");
+			return id;
+		} else {
+			static_assert(std::is_base_of<Component, T>(), "Can only get kind IDs of subclasses of Component or Transform!");
+			static const uint32_t id = GetComponentKindID(T::kind);
+			return id;
+		}
+	}
+
+	/**
+	 * @brief Per-kind contiguous storage of the components in a World
+	 * @details Every component kind gets a densely packed pool of components and their owning entities, so queries walk flat arrays instead of the entity tree
+	 *
+	 * @note Entities register and unregister their components here automatically as they enter and leave a world
+	 */
+	class ComponentStore {
+	  public:
+		/**
+		 * @brief Run a function on every functionally active component of a kind
+		 * @details The function is called as func(Entity&, T&, Others&...) and only for entities that also have every type in Others.
+		 * Others may be component types or Transform (which yields the entity's local transform).
+		 *
+		 * @note Component types used here must declare a static "kind" member matching what GetKind returns.
+		 * Subclasses that don't declare their own kind (such as individual scripts) can't be queried directly; query the declaring type (e.g. Script) instead.
+		 *
+		 * @note Components and entities mounted or deleted by the function are safe to use: new components aren't visited until the next query, and deleted ones are kept alive until the query finishes
+		 *
+		 * @note The store is locked while the function runs, so it must not wait on other threads that use the store
+		 *
+		 * @param func The function to run
+		 */
+		template<typename T, typename... Others, typename F>
+		void Each(F&& func) {
+			static_assert(std::is_base_of<Component, T>(), "The first queried type must be a subclass of Component!");
+			const uint32_t kindID = KindIDOf<T>();
+
+			std::lock_guard lk(mtx);
+			if(kindID >= pools.size()) return;
+
+			//Only visit what was in the pool when we started
+			PinGuard guard(this);
+			Pool& pool = pools[kindID];
+			std::size_t count = pool.components.size();
+			for(std::size_t i = 0; i < count; i++) {
+				//Skip slots emptied during this query
+				Component* c = pool.components[i];
+				if(!c) continue;
+
+				Entity* owner = pool.owners[i];
+				if(!owner->IsActiveInHierarchy() || !c->_GetActiveState()) continue;
+
+				if constexpr(sizeof...(Others) == 0) {
+					func(*owner, *static_cast<T*>(c));
+				} else {
+					std::tuple<Others*...> others {Find<Others>(*owner)...};
+					if(!std::apply([](auto*... o) { return (o && ...); }, others)) continue;
+					std::apply([&](auto*... o) { func(*owner, *static_cast<T*>(c), *o...); }, others);
+				}
+			}
+		}
+
+		/**
+		 * @brief Get the number of components of a kind in the store
+		 * @details This counts inactive components too, so it is an upper bound on how many times Each will call its function
+		 *
+		 * @return The number of components
+		 */
+		template<typename T>
+		std::size_t Count() {
+			const uint32_t kindID = KindIDOf<T>();
+			std::lock_guard lk(mtx);
+			return kindID < pools.size() ? pools[kindID].components.size() : 0;
+		}
+
+		/**
+		 * @brief Keep a component alive until the current query finishes
+		 * @details Used by entities when a component is deleted mid-query so that the code currently running on it doesn't lose its object
+		 *
+		 * @param comp The component to keep alive
+		 *
+		 * @return If the component was retained (false if the store isn't pinned)
+		 */
+		bool Retain(std::shared_ptr<Component> comp);
+
+		/**
+		 * @brief Keeps deleted components alive and pools unchanged while code works with components collected from a query
+		 * @details Each pins the store for its duration; pin it yourself to keep references from a query valid after it returns
+		 */
+		class PinGuard {
+		  public:
+			/**
+			 * @brief Pin a store
+			 *
+			 * @param s The store to pin
+			 */
+			PinGuard(ComponentStore* s)
+			  : store(s) {
+				store->Pin();
+			}
+
+			///@brief Unpin the store, releasing deleted components if this was the last pin
+			~PinGuard() {
+				store->Unpin();
+			}
+
+			PinGuard(const PinGuard&) = delete;
+			PinGuard& operator=(const PinGuard&) = delete;
+
+		  private:
+			ComponentStore* store;
+		};
+
+		/**
+		 * @brief Get the structure version
+		 * @details The version changes whenever a component is added to or removed from any store, or an entity or script is activated or deactivated, so anything derived from which components exist can be rebuilt only when it has to be
+		 *
+		 * @return The current structure version
+		 */
+		static uint64_t GetVersion() {
+			return version.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Recalculate outdated world transforms
+		 * @details Only entities that moved since the last update (and their children) are visited, top-down
+		 */
+		void UpdateTransforms();
+
+		ComponentStore()
+		  : iterationDepth(0) {}
+
+		//Stores are tied to their world
+		ComponentStore(const ComponentStore&) = delete;
+		ComponentStore& operator=(const ComponentStore&) = delete;
+
+	  private:
+		struct Pool {
+			std::vector<Component*> components;
+			std::vector<Entity*> owners;
+			bool hasHoles = false;
+		};
+
+		//Pools indexed by kind ID (deque so pools don't move when a new kind shows up mid-query)
+		std::deque<Pool> pools;
+
+		//Guards all pools, recursive so that queried code can mount and delete components
+		std::recursive_mutex mtx;
+
+		//Structure version, shared by every store
+		static std::atomic<uint64_t> version;
+
+		//Note a structural change
+		static void BumpVersion() {
+			version.fetch_add(1, std::memory_order_acq_rel);
+		}
+
+		//Number of active pins (queries count as pins) and components deleted while pinned
+		unsigned int iterationDepth;
+		std::vector<std::shared_ptr<Component>> graveyard;
+
+		//Pin or unpin the store
+		void Pin();
+		void Unpin();
+
+		//Entities whose transforms changed since the last transform update
+		std::vector<Entity*> transformQueue;
+
+		//Add or remove a component
+		void Register(Entity* owner, Component* comp);
+		void Unregister(Component* comp);
+
+		//Add or remove an entity from the transform update queue
+		void QueueTransformUpdate(Entity* e);
+		void DequeueTransformUpdate(Entity* e);
+
+		//Remove holes left by mid-query removals and release retained components
+		void Settle();
+
+		//Find a component of a type on an entity for multi-type queries
+		template<typename U>
+		U* Find(Entity& e) {
+			if constexpr(std::is_same_v<U, Transform>) {
+				return &e.GetLocalTransform();
+			} else {
+				return static_cast<U*>(e.FindActiveComponentOfKind(KindIDOf<U>()));
+			}
+		}
+
+		friend class Entity;
+		friend class Script;
+	};
+}
@@ -16,6 +16,7 @@
 #include <map>
 #include <vector>
 #include <mutex>
+#include <atomic>
 
 //This is required for uint64_t used by crossguid (but that doesn't include it for some reason)
 #include <stdint.h>
@@ -30,6 +31,10 @@ namespace Cacao {
 	//Forward declaration of Entity for the fake deleter
 	class Entity;
 
+	//Forward declarations of world storage types
+	class ComponentStore;
+	class World;
+
 	/**
 	 * @brief An object in the world
 	 *
@@ -54,8 +59,15 @@ namespace Cacao {
 		 *
 		 * @param val The new activation state
 		 */
-		void SetActive(bool val) {
-			active = val;
+		void SetActive(bool val);
+
+		/**
+		 * @brief Check if this entity and all of its parents are active
+		 *
+		 * @return If the entity is active in the hierarchy
+		 */
+		const bool IsActiveInHierarchy() {
+			return hierarchyActive;
 		}
 
 		/**
@@ -70,26 +82,11 @@ namespace Cacao {
 
 		/**
 		 * @brief Get the world-space transformation matrix
+		 * @details The matrix is cached by the world's transform update every tick. If this entity or one of its parents moved since then, it is calculated without being cached.
 		 *
 		 * @return A matrix representing all transformations on this entity
 		 */
-		glm::mat4 GetWorldTransformMatrix() {
-			//Calculate the transformation matrix
-			std::shared_ptr<Entity> curParent = parent.lock();
-			glm::mat4 transMat = transform.GetTransformationMatrix();
-			while(true) {
-				//If the next parent's parent is itself (so orphaned or world root), we stop
-				if(curParent->parent.lock() == curParent) break;
-
-				//Apply this transformation
-				transMat = curParent->GetLocalTransform().GetTransformationMatrix() * transMat;
-
-				//Otherwise, move on to the next parent
-				curParent = curParent->parent.lock();
-			}
-
-			return transMat;
-		}
+		glm::mat4 GetWorldTransformMatrix();
 
 		/**
 		 * @brief Get the list of child entities
@@ -109,7 +106,9 @@ namespace Cacao {
 		 * @param name The name of this entity
 		 */
 		Entity(std::string name)
-		  : guid(xg::newGuid()), name(name), transform(glm::vec3 {0}, glm::vec3 {0}, glm::vec3 {1}), self(this, FakeDeleter<Entity> {}), parent(self), active(true) {}
+		  : guid(xg::newGuid()), name(name), transform(glm::vec3 {0}, glm::vec3 {0}, glm::vec3 {1}), self(this, FakeDeleter<Entity> {}), parent(self), active(true), hierarchyActive(true), store(nullptr), worldTransform(1.0), worldTransformDirty(true), transformQueued(false) {
+			transform.owner = this;
+		}
 
 
 		/**
@@ -129,15 +128,8 @@ namespace Cacao {
 			std::shared_ptr<T> cptr = std::make_shared<T>(std::forward<Args>(args)...);
 			cptr->SetOwner(self);
 
-			{
-				std::lock_guard lk(componentsMtx);
-
-				//Add this component to the list
-				auto mapValue = components.emplace(std::make_pair<xg::Guid, std::shared_ptr<Component>>(xg::newGuid(), std::static_pointer_cast<Component>(cptr)));
-
-				//Return the GUID
-				return mapValue.first->first;
-			}
+			//Add it to this entity (and the world's component store if we are in one)
+			return AddComponent(std::static_pointer_cast<Component>(cptr));
 		}
 
 		/**
@@ -181,13 +173,7 @@ namespace Cacao {
 		 *
 		 * @throws Exception If no component with the provided GUID exists
 		 */
-		void DeleteComponent(xg::Guid guid) {
-			std::lock_guard lk(componentsMtx);
-			CheckException(components.contains(guid), Exception::GetExceptionCodeFromMeaning("ContainerValue"), "No component with the provided GUID exists in this entity!");
-
-			components[guid].reset();
-			components.erase(guid);
-		}
+		void DeleteComponent(xg::Guid guid);
 
 		/**
 		 * @brief Set the parent of this entity
@@ -196,44 +182,21 @@ namespace Cacao {
 		 *
 		 * @param newParent The new parent of the entity
 		 */
-		void SetParent(std::shared_ptr<Entity> newParent) {
-			//If we aren't orphaned, remove ourselves from the current parent
-			if(parent.lock() != self) {
-				std::shared_ptr<Entity> parentLk = parent.lock();
-				auto it = std::find(parentLk->children.begin(), parentLk->children.end(), self);
-				if(it != parentLk->children.end()) parentLk->children.erase(it);
-			}
-
-			//Add ourselves as a child to the new parent
-			newParent->children.push_back(self);
-
-			//Set parent pointer
-			parent = newParent;
-		}
+		void SetParent(std::shared_ptr<Entity> newParent);
 
 		/**
 		 * @brief Destroy the entity and release references to components and child entities
 		 */
-		~Entity() {
-			//Release ownership of all components
-			{
-				std::lock_guard lk(componentsMtx);
-				for(auto comp : components) {
-					comp.second.reset();
-				}
-			}
-
-			//Release ownership of all children
-			for(auto child : children) {
-				child.reset();
-			}
-		}
+		~Entity();
 
 	  private:
 		//Components on this entity
 		std::map<xg::Guid, std::shared_ptr<Component>> components;
 		std::mutex componentsMtx;
 
+		//Flat list of the components above for quick lookup by kind
+		std::vector<Component*> componentList;
+
 		//Child entities
 		std::vector<std::shared_ptr<Entity>> children;
 
@@ -249,6 +212,49 @@ namespace Cacao {
 		//Is this entity active?
 		bool active;
 
+		//Are this entity and all of its parents active?
+		bool hierarchyActive;
+
+		//Component store of the world this entity is in (null if not in a world)
+		ComponentStore* store;
+
+		//Add a mounted component
+		xg::Guid AddComponent(std::shared_ptr<Component> comp);
+
+		//Move this entity and its children to a different component store
+		void SetStore(ComponentStore* newStore);
+
+		//Recalculate the hierarchy active state of this entity and its children
+		void UpdateHierarchyActive();
+
+		//Find a functionally active component of a kind on this entity
+		Component* FindActiveComponentOfKind(uint32_t kindID);
+
+		//Add the kind of each component on this entity to a list
+		void AppendComponentKinds(std::vector<uint32_t>& kinds);
+
+		//Cached world transform
+		//If this is dirty, so is every child (children are always clean after their parent)
+		//The flags are atomic because parallel scripts may move parents and children at the same time
+		glm::mat4 worldTransform;
+		std::atomic_bool worldTransformDirty;
+
+		//Is this entity waiting in its store's transform update queue?
+		std::atomic_bool transformQueued;
+
+		//Mark the world transform of this entity and its children as outdated
+		void InvalidateWorldTransform();
+		void InvalidateChildTransforms();
+
+		//Recalculate the world transform of this entity and its children if outdated
+		void UpdateWorldTransform();
+
+		//Calculate the world transform from the parent's without touching the cache
+		glm::mat4 CalculateWorldTransform();
+
+		friend class ComponentStore;
+		friend class World;
 		friend class DynTickController;
+		friend Transform;
 	};
 }
\ No newline at end of file
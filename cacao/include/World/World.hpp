@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Entity.hpp"
+#include "ComponentStore.hpp"
 #include "3D/Skybox.hpp"
 #include "Graphics/Cameras/Camera.hpp"
 
@@ -19,6 +20,47 @@ namespace Cacao {
 
 		std::shared_ptr<Entity> rootEntity;///<Root entity (set this as an Entity's parent to add it to the world)
 
+		/**
+		 * @brief Run a function on every functionally active component of a type in this world
+		 * @details See ComponentStore::Each for details
+		 *
+		 * @param func The function to run, called as func(Entity&, T&, Others&...)
+		 */
+		template<typename T, typename... Others, typename F>
+		void Each(F&& func) {
+			components.Each<T, Others...>(std::forward<F>(func));
+		}
+
+		/**
+		 * @brief Get the number of components of a type in this world
+		 * @details See ComponentStore::Count for details
+		 *
+		 * @return The number of components
+		 */
+		template<typename T>
+		std::size_t Count() {
+			return components.Count<T>();
+		}
+
+		/**
+		 * @brief Pin this world's component store
+		 * @details While the returned guard is alive, components collected with Each stay valid even if they are deleted
+		 *
+		 * @return The pin guard
+		 */
+		[[nodiscard]] ComponentStore::PinGuard PinComponents() {
+			return ComponentStore::PinGuard(&components);
+		}
+
+		/**
+		 * @brief Recalculate the world transforms of entities that moved since the last call
+		 *
+		 * @note This is called every dynamic tick before the frame is built
+		 */
+		void UpdateTransforms() {
+			components.UpdateTransforms();
+		}
+
 		/**
 		 * @brief Find an Entity by its GUID
 		 *
@@ -49,9 +91,26 @@ namespace Cacao {
 			rootEntity->GetLocalTransform().SetPosition({0, 0, 0});
 			rootEntity->GetLocalTransform().SetRotation({0, 0, 0});
 			rootEntity->GetLocalTransform().SetScale({1, 1, 1});
+			rootEntity->SetStore(&components);
+		}
+
+		//Worlds own their component store, so they can't be copied or moved
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		/**
+		 * @brief Destroy the world
+		 *
+		 * @note Entities still referenced elsewhere are taken out of the world but not destroyed
+		 */
+		~World() {
+			rootEntity->SetStore(nullptr);
 		}
 
 	  private:
+		//Contiguous component storage
+		ComponentStore components;
+
 		//Recursive function for actually running a entity search
 		template<typename P>
 		std::optional<std::shared_ptr<Entity>> entitySearchRunner(std::vector<std::shared_ptr<Entity>> target, P predicate) {
@@ -33,7 +33,7 @@ namespace Cacao {
 			static_assert(std::is_base_of<Camera, T>(), "You must create a world with a camera type extending Camera!");
 			CheckException(!worlds.contains(name), Exception::GetExceptionCodeFromMeaning("ContainerValue"), "A world with the provided name already exists!")
 
-			worlds.insert_or_assign(name, World {new T()});
+			worlds.try_emplace(name, new T());
 		}
 
 		/**
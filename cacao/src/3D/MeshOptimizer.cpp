@@ -0,0 +1,288 @@
+#include "3D/MeshOptimizer.hpp"
+
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+
+namespace Cacao {
+	//Vertex cache simulated by OptimizeVertexCache (an LRU cache a bit bigger than real ones, as the original algorithm suggests)
+	constexpr std::size_t forsythCacheSize = 32;
+
+	//Forsyth's scoring parameters
+	constexpr float cacheDecayPower = 1.5f, lastTriangleScore = 0.75f, valenceBoostScale = 2.0f, valenceBoostPower = 0.5f;
+
+	//Score a vertex by its cache position (-1 if not in the cache) and how many triangles still need it
+	static float VertexScore(int cachePosition, uint32_t remaining) {
+		//Vertices no triangle needs anymore shouldn't pull anything towards them
+		if(remaining == 0) return -1.0f;
+
+		float score = 0.0f;
+		if(cachePosition >= 0) {
+			if(cachePosition < 3) {
+				//Vertices of the last triangle get a fixed score so that strips aren't favored too much over fans
+				score = lastTriangleScore;
+			} else {
+				float scaler = 1.0f / (forsythCacheSize - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scaler, cacheDecayPower);
+			}
+		}
+
+		//Boost vertices with few triangles left so that they get finished off instead of leaving lone triangles behind
+		return score + valenceBoostScale * std::pow(float(remaining), -valenceBoostPower);
+	}
+
+	void OptimizeVertexCache(std::vector<glm::uvec3>& indices, std::size_t vertexCount) {
+		std::size_t triangleCount = indices.size();
+		if(triangleCount == 0) return;
+		constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+		//Build the list of triangles using each vertex
+		std::vector<uint32_t> remaining(vertexCount, 0), offsets(vertexCount + 1, 0), adjacency(triangleCount * 3);
+		for(const glm::uvec3& tri : indices) {
+			for(int k = 0; k < 3; k++) remaining[tri[k]]++;
+		}
+		for(std::size_t v = 0; v < vertexCount; v++) {
+			offsets[v + 1] = offsets[v] + remaining[v];
+		}
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for(std::size_t t = 0; t < triangleCount; t++) {
+				for(int k = 0; k < 3; k++) adjacency[fill[indices[t][k]]++] = t;
+			}
+		}
+
+		//Score everything
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount), triangleScores(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+		for(std::size_t v = 0; v < vertexCount; v++) {
+			vertexScores[v] = VertexScore(-1, remaining[v]);
+		}
+		std::size_t best = 0;
+		for(std::size_t t = 0; t < triangleCount; t++) {
+			const glm::uvec3& tri = indices[t];
+			triangleScores[t] = vertexScores[tri.x] + vertexScores[tri.y] + vertexScores[tri.z];
+			if(triangleScores[t] > triangleScores[best]) best = t;
+		}
+
+		std::vector<glm::uvec3> out;
+		out.reserve(triangleCount);
+		std::array<uint32_t, forsythCacheSize> cache;
+		std::size_t cacheCount = 0, cursor = 0;
+		while(out.size() < triangleCount) {
+			//If nothing near the cache is left, carry on from the first triangle that hasn't been emitted
+			if(best == none) {
+				while(emitted[cursor]) cursor++;
+				best = cursor;
+			}
+
+			//Emit the best triangle and take it out of its vertices' lists
+			const glm::uvec3 tri = indices[best];
+			emitted[best] = true;
+			out.push_back(tri);
+			for(int k = 0; k < 3; k++) {
+				uint32_t v = tri[k];
+				uint32_t* list = &adjacency[offsets[v]];
+				uint32_t* found = std::find(list, list + remaining[v], uint32_t(best));
+				if(found != list + remaining[v]) {
+					std::swap(*found, list[remaining[v] - 1]);
+					remaining[v]--;
+				}
+			}
+
+			//Move the triangle's vertices to the front of the cache
+			std::array<uint32_t, forsythCacheSize + 3> newCache;
+			std::size_t newCount = 0;
+			for(int k = 0; k < 3; k++) {
+				if(std::find(newCache.begin(), newCache.begin() + newCount, tri[k]) == newCache.begin() + newCount) newCache[newCount++] = tri[k];
+			}
+			for(std::size_t i = 0; i < cacheCount; i++) {
+				if(cache[i] != tri.x && cache[i] != tri.y && cache[i] != tri.z) newCache[newCount++] = cache[i];
+			}
+
+			//Rescore every vertex whose position changed (ones pushed past the end are evicted)
+			for(std::size_t i = 0; i < newCount; i++) {
+				uint32_t v = newCache[i];
+				cachePosition[v] = (i < forsythCacheSize ? int(i) : -1);
+				vertexScores[v] = VertexScore(cachePosition[v], remaining[v]);
+			}
+
+			//Rescore the triangles using those vertices and pick the best one next
+			best = none;
+			float bestScore = -1.0f;
+			for(std::size_t i = 0; i < newCount; i++) {
+				uint32_t v = newCache[i];
+				for(uint32_t j = 0; j < remaining[v]; j++) {
+					uint32_t t = adjacency[offsets[v] + j];
+					const glm::uvec3& adj = indices[t];
+					triangleScores[t] = vertexScores[adj.x] + vertexScores[adj.y] + vertexScores[adj.z];
+					if(triangleScores[t] > bestScore) {
+						bestScore = triangleScores[t];
+						best = t;
+					}
+				}
+			}
+
+			cacheCount = std::min(newCount, forsythCacheSize);
+			std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+		}
+
+		indices = std::move(out);
+	}
+
+	//FIFO vertex cache simulated with timestamps: a vertex is cached if it was added less than cacheSize misses ago
+	class FIFOCacheSimulator {
+	  public:
+		FIFOCacheSimulator(std::size_t vertexCount, std::size_t cacheSize)
+		  : stamps(vertexCount, 0), time(cacheSize + 1), cacheSize(cacheSize) {}
+
+		//Process a triangle, returning how many of its vertices missed
+		unsigned int Process(const glm::uvec3& tri) {
+			unsigned int misses = 0;
+			for(int k = 0; k < 3; k++) {
+				if(time - stamps[tri[k]] > cacheSize) {
+					stamps[tri[k]] = time++;
+					misses++;
+				}
+			}
+			return misses;
+		}
+
+		//Empty the cache
+		void Flush() {
+			time += cacheSize + 1;
+		}
+
+	  private:
+		std::vector<std::size_t> stamps;
+		std::size_t time, cacheSize;
+	};
+
+	float ComputeACMR(std::span<const glm::uvec3> indices, std::size_t vertexCount, std::size_t cacheSize) {
+		if(indices.empty()) return 0.0f;
+		FIFOCacheSimulator cache(vertexCount, cacheSize);
+		std::size_t misses = 0;
+		for(const glm::uvec3& tri : indices) {
+			misses += cache.Process(tri);
+		}
+		return float(misses) / indices.size();
+	}
+
+	void OptimizeOverdraw(std::vector<glm::uvec3>& indices, std::span<const Vertex> vertices, float threshold) {
+		std::size_t triangleCount = indices.size();
+		if(triangleCount < 2) return;
+		constexpr std::size_t cacheSize = 16;
+
+		//Split where every vertex of a triangle misses, as the cache is cold there no matter what was drawn before
+		std::vector<std::size_t> hardStarts;
+		{
+			FIFOCacheSimulator cache(vertices.size(), cacheSize);
+			for(std::size_t t = 0; t < triangleCount; t++) {
+				if(cache.Process(indices[t]) == 3 || t == 0) hardStarts.push_back(t);
+			}
+		}
+		hardStarts.push_back(triangleCount);
+
+		//Split big clusters further wherever the part before the split is within the threshold of the whole cluster's cache miss ratio
+		std::vector<std::size_t> starts;
+		FIFOCacheSimulator cache(vertices.size(), cacheSize);
+		for(std::size_t c = 0; c + 1 < hardStarts.size(); c++) {
+			std::size_t begin = hardStarts[c], end = hardStarts[c + 1];
+			cache.Flush();
+			std::size_t misses = 0;
+			for(std::size_t t = begin; t < end; t++) {
+				misses += cache.Process(indices[t]);
+			}
+			float target = threshold * float(misses) / (end - begin);
+
+			cache.Flush();
+			starts.push_back(begin);
+			misses = 0;
+			std::size_t clusterStart = begin;
+			for(std::size_t t = begin; t < end; t++) {
+				misses += cache.Process(indices[t]);
+				if(t + 1 < end && float(misses) / (t + 1 - clusterStart) <= target) {
+					starts.push_back(t + 1);
+					clusterStart = t + 1;
+					misses = 0;
+					cache.Flush();
+				}
+			}
+		}
+		starts.push_back(triangleCount);
+
+		//Find where each cluster is and which way it faces
+		struct Cluster {
+			std::size_t begin, end;
+			glm::vec3 centroid, normal;
+			float sortKey;
+		};
+		std::vector<Cluster> clusters;
+		glm::vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+		for(std::size_t c = 0; c + 1 < starts.size(); c++) {
+			Cluster cluster {.begin = starts[c], .end = starts[c + 1], .centroid = glm::vec3(0.0f), .normal = glm::vec3(0.0f), .sortKey = 0.0f};
+			float area = 0.0f;
+			for(std::size_t t = cluster.begin; t < cluster.end; t++) {
+				const glm::vec3& a = vertices[indices[t].x].position;
+				const glm::vec3& b = vertices[indices[t].y].position;
+				const glm::vec3& d = vertices[indices[t].z].position;
+
+				//The cross product is the normal scaled by twice the area, so summing it weights by area
+				glm::vec3 cross = glm::cross(b - a, d - a);
+				float triArea = glm::length(cross);
+				cluster.centroid += (a + b + d) * (triArea / 3.0f);
+				cluster.normal += cross;
+				area += triArea;
+			}
+			meshCentroid += cluster.centroid;
+			meshArea += area;
+			if(area > 0.0f) cluster.centroid /= area;
+			clusters.push_back(cluster);
+		}
+		if(meshArea > 0.0f) meshCentroid /= meshArea;
+
+		//Clusters facing away from the middle of the mesh are likely in front of the rest of it, so they go first
+		for(Cluster& cluster : clusters) {
+			float length = glm::length(cluster.normal);
+			cluster.sortKey = (length > 0.0f ? glm::dot(cluster.centroid - meshCentroid, cluster.normal / length) : 0.0f);
+		}
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+			return a.sortKey > b.sortKey;
+		});
+
+		std::vector<glm::uvec3> out;
+		out.reserve(triangleCount);
+		for(const Cluster& cluster : clusters) {
+			out.insert(out.end(), indices.begin() + cluster.begin, indices.begin() + cluster.end);
+		}
+		indices = std::move(out);
+	}
+
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<glm::uvec3>& indices) {
+		constexpr uint32_t unmapped = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> remap(vertices.size(), unmapped);
+		std::vector<Vertex> out;
+		out.reserve(vertices.size());
+		for(glm::uvec3& tri : indices) {
+			for(int k = 0; k < 3; k++) {
+				uint32_t& mapped = remap[tri[k]];
+				if(mapped == unmapped) {
+					mapped = out.size();
+					out.push_back(vertices[tri[k]]);
+				}
+				tri[k] = mapped;
+			}
+		}
+		vertices = std::move(out);
+	}
+
+	void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<glm::uvec3>& indices) {
+		OptimizeVertexCache(indices, vertices.size());
+		OptimizeOverdraw(indices, vertices);
+		OptimizeVertexFetch(vertices, indices);
+	}
+}
@@ -0,0 +1,187 @@
+#include "3D/MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+
+namespace Cacao {
+	//Sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+	//The total weight of the planes is kept alongside so that errors can be turned back into distances
+	struct Quadric {
+		double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33, weight;
+
+		//Quadric of a plane (n.p + d = 0 with n of unit length)
+		static Quadric FromPlane(double nx, double ny, double nz, double d, double w) {
+			return Quadric {w * nx * nx, w * nx * ny, w * nx * nz, w * nx * d, w * ny * ny, w * ny * nz, w * ny * d, w * nz * nz, w * nz * d, w * d * d, w};
+		}
+
+		Quadric& operator+=(const Quadric& o) {
+			a00 += o.a00, a01 += o.a01, a02 += o.a02, a03 += o.a03, a11 += o.a11, a12 += o.a12, a13 += o.a13, a22 += o.a22, a23 += o.a23, a33 += o.a33, weight += o.weight;
+			return *this;
+		}
+
+		Quadric operator+(const Quadric& o) const {
+			Quadric sum = *this;
+			return sum += o;
+		}
+
+		//Root mean square distance of a point from the planes
+		float Distance(const glm::vec3& p) const {
+			if(weight <= 0.0) return 0.0f;
+			double x = p.x, y = p.y, z = p.z;
+			double error = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x + a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y + a22 * z * z + 2.0 * a23 * z + a33;
+			return float(std::sqrt(std::max(0.0, error / weight)));
+		}
+	};
+
+	//Find vertices that must not move: ones on a texture seam (sharing a position with another vertex) or on a border (an edge only one triangle uses)
+	static std::vector<bool> FindLockedVertices(std::span<const Vertex> vertices, std::span<const glm::uvec3> indices) {
+		std::vector<bool> locked(vertices.size(), false);
+
+		//Group vertices by position
+		std::vector<uint32_t> order(vertices.size());
+		std::iota(order.begin(), order.end(), 0);
+		auto positionLess = [&vertices](uint32_t a, uint32_t b) {
+			const glm::vec3 &pa = vertices[a].position, &pb = vertices[b].position;
+			if(pa.x != pb.x) return pa.x < pb.x;
+			if(pa.y != pb.y) return pa.y < pb.y;
+			return pa.z < pb.z;
+		};
+		std::sort(order.begin(), order.end(), positionLess);
+		std::vector<uint32_t> canonical(vertices.size());
+		for(std::size_t i = 0; i < order.size(); i++) {
+			bool sameAsLast = (i > 0 && !positionLess(order[i - 1], order[i]));
+			canonical[order[i]] = (sameAsLast ? canonical[order[i - 1]] : order[i]);
+			if(sameAsLast) locked[order[i]] = locked[order[i - 1]] = locked[canonical[order[i]]] = true;
+		}
+
+		//Count how many triangles use each edge (between positions, so that seams don't look like borders)
+		std::unordered_map<uint64_t, uint32_t> edgeUses;
+		auto edgeKey = [&canonical](uint32_t a, uint32_t b) {
+			uint64_t ca = canonical[a], cb = canonical[b];
+			return (std::min(ca, cb) << 32) | std::max(ca, cb);
+		};
+		for(const glm::uvec3& tri : indices) {
+			for(int k = 0; k < 3; k++) edgeUses[edgeKey(tri[k], tri[(k + 1) % 3])]++;
+		}
+		for(const glm::uvec3& tri : indices) {
+			for(int k = 0; k < 3; k++) {
+				if(edgeUses[edgeKey(tri[k], tri[(k + 1) % 3])] == 1) locked[tri[k]] = locked[tri[(k + 1) % 3]] = true;
+			}
+		}
+		return locked;
+	}
+
+	std::vector<glm::uvec3> SimplifyMesh(std::span<const Vertex> vertices, std::span<const glm::uvec3> indices, std::size_t targetTriangles, float maxError, float* resultError) {
+		std::vector<glm::uvec3> tris(indices.begin(), indices.end());
+		float worstError = 0.0f;
+		if(resultError) *resultError = 0.0f;
+		if(tris.size() <= targetTriangles) return tris;
+
+		std::vector<bool> locked = FindLockedVertices(vertices, indices);
+
+		//Start each vertex off with the planes of the triangles around it, weighted by area
+		std::vector<Quadric> quadrics(vertices.size(), Quadric {});
+		for(const glm::uvec3& tri : tris) {
+			glm::vec3 a = vertices[tri.x].position, b = vertices[tri.y].position, c = vertices[tri.z].position;
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			float length = glm::length(normal);
+			if(length == 0.0f) continue;
+			normal /= length;
+			Quadric q = Quadric::FromPlane(normal.x, normal.y, normal.z, -glm::dot(normal, a), length * 0.5);
+			for(int k = 0; k < 3; k++) quadrics[tri[k]] += q;
+		}
+
+		struct Collapse {
+			uint32_t from, to;
+			float error;
+		};
+		std::vector<uint32_t> offsets(vertices.size() + 1), adjacency;
+		std::vector<Collapse> candidates;
+		std::vector<uint32_t> remap(vertices.size());
+		std::vector<bool> touched(vertices.size());
+
+		//Collapse in passes, each doing the cheapest collapses that don't touch the same triangles
+		while(tris.size() > targetTriangles) {
+			//List the triangles around each vertex
+			std::fill(offsets.begin(), offsets.end(), 0);
+			for(const glm::uvec3& tri : tris) {
+				for(int k = 0; k < 3; k++) offsets[tri[k] + 1]++;
+			}
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+			adjacency.resize(tris.size() * 3);
+			{
+				std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+				for(std::size_t t = 0; t < tris.size(); t++) {
+					for(int k = 0; k < 3; k++) adjacency[fill[tris[t][k]]++] = t;
+				}
+			}
+
+			//Cost every way of collapsing every edge
+			candidates.clear();
+			for(const glm::uvec3& tri : tris) {
+				for(int k = 0; k < 3; k++) {
+					uint32_t a = tri[k], b = tri[(k + 1) % 3];
+					if(!locked[a]) candidates.push_back(Collapse {a, b, (quadrics[a] + quadrics[b]).Distance(vertices[b].position)});
+					if(!locked[b]) candidates.push_back(Collapse {b, a, (quadrics[a] + quadrics[b]).Distance(vertices[a].position)});
+				}
+			}
+			std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) {
+				return a.error < b.error;
+			});
+
+			std::iota(remap.begin(), remap.end(), 0);
+			std::fill(touched.begin(), touched.end(), false);
+			std::size_t removed = 0, toRemove = tris.size() - targetTriangles;
+			for(const Collapse& collapse : candidates) {
+				if(collapse.error > maxError || removed >= toRemove) break;
+				if(touched[collapse.from] || touched[collapse.to]) continue;
+
+				//Skip collapses that would flip a triangle around the moving vertex, and count the ones that would disappear
+				bool flips = false;
+				std::size_t disappearing = 0;
+				for(uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1] && !flips; i++) {
+					const glm::uvec3& tri = tris[adjacency[i]];
+					if(tri.x == collapse.to || tri.y == collapse.to || tri.z == collapse.to) {
+						disappearing++;
+						continue;
+					}
+					glm::vec3 before[3], after[3];
+					for(int k = 0; k < 3; k++) {
+						before[k] = vertices[tri[k]].position;
+						after[k] = (tri[k] == collapse.from ? vertices[collapse.to].position : before[k]);
+					}
+					glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+					glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+					flips = (glm::dot(normalBefore, normalAfter) <= 0.0f);
+				}
+				if(flips) continue;
+
+				//Collapse, keeping everything around it from being changed again this pass so that the flip checks stay valid
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to] += quadrics[collapse.from];
+				worstError = std::max(worstError, collapse.error);
+				removed += disappearing;
+				touched[collapse.to] = true;
+				for(uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1]; i++) {
+					for(int k = 0; k < 3; k++) touched[tris[adjacency[i]][k]] = true;
+				}
+			}
+			if(removed == 0) break;
+
+			//Apply the collapses and drop the triangles that disappeared
+			std::size_t kept = 0;
+			for(const glm::uvec3& tri : tris) {
+				glm::uvec3 moved(remap[tri.x], remap[tri.y], remap[tri.z]);
+				if(moved.x == moved.y || moved.y == moved.z || moved.z == moved.x) continue;
+				tris[kept++] = moved;
+			}
+			tris.resize(kept);
+		}
+
+		if(resultError) *resultError = worstError;
+		return tris;
+	}
+}
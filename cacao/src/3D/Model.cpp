@@ -3,23 +3,148 @@
 #include "assimp/Importer.hpp"
 #include "assimp/scene.h"
 #include "assimp/postprocess.h"
+#include "assimp/IOSystem.hpp"
+#include "assimp/IOStream.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/rotate_vector.hpp"
 
 #include "Core/Exception.hpp"
+#include "Utilities/ParallelFor.hpp"
+#include "Utilities/MappedFile.hpp"
+#include "Utilities/VFS.hpp"
+#include "Utilities/CookedFile.hpp"
+#include "3D/MeshOptimizer.hpp"
+#include "3D/MeshSimplifier.hpp"
 
-#include <filesystem>
 #include <ranges>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
 
 namespace Cacao {
+	//Cooked model file layout
+	//A header, then a table entry per mesh, then the mesh names, then each mesh's vertices and indices (each aligned to cookedAlignment)
+	//LODs get unnamed entries of their own, right after the entry of the mesh they belong to
+	//Everything is stored in the byte order and vertex layout of the machine that cooked it, which are checked on load
+	struct CookedHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t vertexSize, meshCount;
+	};
+	struct CookedMeshEntry {
+		uint64_t nameOffset, nameLength;
+		uint64_t vertexOffset, vertexCount;
+		uint64_t indexOffset, triangleCount;
+		float boundsMin[3], boundsMax[3];
+		int32_t parent;//Entry of the mesh this is a LOD of (-1 if it isn't a LOD)
+		float lodError;
+	};
+	constexpr char cookedMagic[4] = {'C', 'M', 'S', 'H'};
+	constexpr uint32_t cookedVersion = 3;
+	static_assert(std::is_trivially_copyable_v<Vertex>, "Vertices must be trivially copyable to be stored in cooked model files!");
 
-	Model::Model(std::string filePath) {
+	//LOD generation settings
+	//Each LOD aims for half the triangles of the one before it, stopping once simplifying stops paying off or the error gets too big
+	constexpr std::size_t maxLODs = 4, minLODTriangles = 64;
+	constexpr float maxLODError = 0.05f;//Relative to the radius of the mesh's bounds
+
+	static void BuildLODs(Mesh& mesh) {
+		std::span<const Vertex> vertices = mesh.GetVertices();
+		std::span<const glm::uvec3> indices = mesh.GetIndices();
+		const BoundingBox& bounds = mesh.GetBounds();
+		float maxError = maxLODError * glm::length(bounds.max - bounds.min) * 0.5f;
+
+		std::size_t previous = indices.size();
+		for(std::size_t level = 0; level < maxLODs && previous / 2 >= minLODTriangles; level++) {
+			//Always simplify the original so that errors don't pile up between levels
+			float error = 0.0f;
+			std::vector<glm::uvec3> lodIndices = SimplifyMesh(vertices, indices, previous / 2, maxError, &error);
+			if(lodIndices.size() * 4 > previous * 3) break;
+			previous = lodIndices.size();
+
+			std::vector<Vertex> lodVertices(vertices.begin(), vertices.end());
+			OptimizeMesh(lodVertices, lodIndices);
+			mesh.AddLOD(std::make_shared<Mesh>(std::move(lodVertices), std::move(lodIndices)), error);
+		}
+	}
+
+	//Assimp stream over a file opened through the VFS
+	class VFSIOStream : public Assimp::IOStream {
+	  public:
+		VFSIOStream(std::shared_ptr<MappedFile> file)
+		  : file(file), position(0) {}
+
+		std::size_t Read(void* buffer, std::size_t size, std::size_t count) override {
+			if(size == 0) return 0;
+			count = std::min(count, (file->GetSize() - position) / size);
+			if(count > 0) std::memcpy(buffer, file->GetData() + position, size * count);
+			position += size * count;
+			return count;
+		}
+
+		std::size_t Write(const void* buffer, std::size_t size, std::size_t count) override {
+			return 0;
+		}
+
+		aiReturn Seek(std::size_t offset, aiOrigin origin) override {
+			std::size_t target = (origin == aiOrigin_SET ? offset : origin == aiOrigin_CUR ? position + offset : file->GetSize() + offset);
+			if(target > file->GetSize()) return aiReturn_FAILURE;
+			position = target;
+			return aiReturn_SUCCESS;
+		}
+
+		std::size_t Tell() const override {
+			return position;
+		}
+
+		std::size_t FileSize() const override {
+			return file->GetSize();
+		}
+
+		void Flush() override {}
+
+	  private:
+		std::shared_ptr<MappedFile> file;
+		std::size_t position;
+	};
+
+	//Assimp file system that reads through the VFS, so models (and the files they reference) can come from asset archives
+	class VFSIOSystem : public Assimp::IOSystem {
+	  public:
+		bool Exists(const char* path) const override {
+			return VFS::GetInstance()->Exists(path);
+		}
+
+		char getOsSeparator() const override {
+			return '/';
+		}
+
+		Assimp::IOStream* Open(const char* path, const char* mode) override {
+			//Archives are read-only
+			if(std::string_view(mode).find_first_of("wa+") != std::string_view::npos) return nullptr;
+			try {
+				return new VFSIOStream(VFS::GetInstance()->Open(path));
+			} catch(...) {
+				return nullptr;
+			}
+		}
+
+		void Close(Assimp::IOStream* stream) override {
+			delete stream;
+		}
+	};
+
+	Model::Model(std::string filePath, bool optimize) {
 		//Confirm that provided file path exists
-		CheckException(std::filesystem::exists(filePath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), ("Cannot load nonexistent model file \"" + filePath + "\"!"))
+		CheckException(VFS::GetInstance()->Exists(filePath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), ("Cannot load nonexistent model file \"" + filePath + "\"!"))
 
-		//Create Assimp importer
+		//Create Assimp importer, reading through the VFS (the importer owns the file system object)
 		Assimp::Importer importer;
+		importer.SetIOHandler(new VFSIOSystem());
 
 		//Set importer to strip standalone lines and points from models (usually not needed)
 		importer.SetPropertyInteger("AI_CONFIG_SBP_REMOVE", aiPrimitiveType_LINE | aiPrimitiveType_POINT);
@@ -38,113 +163,242 @@ namespace Cacao {
 		CheckException(scene != nullptr, Exception::GetExceptionCodeFromMeaning("NullValue"), (std::string("Model loading failed, Assimp error: ") + importer.GetErrorString()))
 		CheckException(scene->HasMeshes(), Exception::GetExceptionCodeFromMeaning("ContainerValue"), "Model file does not contain any meshes!")
 
+		//Find model orientation (the same for every mesh)
+		int upAxis = 1, upAxisSign = 1;
+		if(scene->mMetaData) {
+			scene->mMetaData->Get<int>("UpAxis", upAxis);
+			scene->mMetaData->Get<int>("UpAxisSign", upAxisSign);
+		}
+		ModelOrientation modelOrientation = ModelOrientation::PosY;
+		if(upAxis == 0) {
+			modelOrientation = (upAxisSign < 1 ? ModelOrientation::NegX : ModelOrientation::PosX);
+		} else if(upAxis == 1) {
+			modelOrientation = (upAxisSign < 1 ? ModelOrientation::NegY : ModelOrientation::PosY);
+		} else if(upAxis == 2) {
+			modelOrientation = (upAxisSign < 1 ? ModelOrientation::NegZ : ModelOrientation::PosZ);
+		}
+
 		//Load meshes data
-		for(int i = 0; i < scene->mNumMeshes; i++) {
-			aiMesh* assimpMesh = scene->mMeshes[i];
+		//Meshes don't depend on each other, so they are converted in parallel (one mesh per chunk as their sizes vary a lot)
+		std::vector<std::shared_ptr<Mesh>> converted(scene->mNumMeshes);
+		ParallelFor(
+			scene->mNumMeshes, [scene, modelOrientation, optimize, &converted](std::size_t start, std::size_t end) {
+				for(std::size_t i = start; i < end; i++) {
+					aiMesh* assimpMesh = scene->mMeshes[i];
 
-			std::vector<Vertex> vertices;
-			std::vector<glm::uvec3> indices;
+					std::vector<Vertex> vertices;
+					std::vector<glm::uvec3> indices;
+					vertices.reserve(assimpMesh->mNumVertices);
+					indices.reserve(assimpMesh->mNumFaces);
 
-			int upAxis = 1, upAxisSign = 1;
-			if(scene->mMetaData) {
-				scene->mMetaData->Get<int>("UpAxis", upAxis);
-				scene->mMetaData->Get<int>("UpAxisSign", upAxisSign);
-			}
+					bool containsTexCoords = assimpMesh->HasTextureCoords(0);
+					bool containsTangentsAndBitangents = assimpMesh->HasTangentsAndBitangents();
+					bool containsNormals = assimpMesh->HasNormals();
 
-			ModelOrientation modelOrientation;
-			//Find model orientation
-			if(upAxis == 0) {
-				modelOrientation = (upAxisSign < 1 ? ModelOrientation::NegX : ModelOrientation::PosX);
-			} else if(upAxis == 1) {
-				modelOrientation = (upAxisSign < 1 ? ModelOrientation::NegY : ModelOrientation::PosY);
-			} else if(upAxis == 2) {
-				modelOrientation = (upAxisSign < 1 ? ModelOrientation::NegZ : ModelOrientation::PosZ);
-			}
+					for(int j = 0; j < assimpMesh->mNumVertices; j++) {
+						aiVector3D vert = assimpMesh->mVertices[j];
 
-			bool containsTexCoords = assimpMesh->HasTextureCoords(0);
-			bool containsTangentsAndBitangents = assimpMesh->HasTangentsAndBitangents();
-			bool containsNormals = assimpMesh->HasNormals();
+						glm::vec3 position = {vert.x, vert.y, vert.z};
+						glm::vec2 texCoords = glm::vec2(0.0f);
+						glm::vec3 tangent = glm::vec3(0.0f);
+						glm::vec3 bitangent = glm::vec3(0.0f);
+						glm::vec3 normal = glm::vec3(0.0f);
 
-			for(int j = 0; j < assimpMesh->mNumVertices; j++) {
-				aiVector3D vert = assimpMesh->mVertices[j];
+						if(containsTexCoords) {
+							aiVector3D tc = assimpMesh->mTextureCoords[0][j];
+							texCoords = {tc.x, tc.y};
+						}
 
-				glm::vec3 position = {vert.x, vert.y, vert.z};
-				glm::vec2 texCoords = glm::vec2(0.0f);
-				glm::vec3 tangent = glm::vec3(0.0f);
-				glm::vec3 bitangent = glm::vec3(0.0f);
-				glm::vec3 normal = glm::vec3(0.0f);
+						if(containsTangentsAndBitangents) {
+							aiVector3D tan = assimpMesh->mTangents[j];
+							aiVector3D bitan = assimpMesh->mBitangents[j];
+							tangent = {tan.x, tan.y, tan.z};
+							bitangent = {bitan.x, bitan.y, bitan.z};
+						}
 
-				if(containsTexCoords) {
-					aiVector3D tc = assimpMesh->mTextureCoords[0][j];
-					texCoords = {tc.x, tc.y};
-				}
+						if(containsNormals) {
+							aiVector3D norm = assimpMesh->mNormals[j];
+							normal = {norm.x, norm.y, norm.z};
+						}
 
-				if(containsTangentsAndBitangents) {
-					aiVector3D tan = assimpMesh->mTangents[j];
-					aiVector3D bitan = assimpMesh->mBitangents[j];
-					tangent = {tan.x, tan.y, tan.z};
-					bitangent = {bitan.x, bitan.y, bitan.z};
-				}
+						//Apply axis correction
+						switch(modelOrientation) {
+							case ModelOrientation::PosY:
+								break;
+							case ModelOrientation::NegY:
+								position = glm::rotateZ(position, glm::radians(180.0f));
+								break;
+							case ModelOrientation::PosX:
+								position = glm::rotateZ(position, glm::radians(-90.0f));
+								break;
+							case ModelOrientation::NegX:
+								position = glm::rotateZ(position, glm::radians(90.0f));
+								break;
+							case ModelOrientation::PosZ:
+								position = glm::rotateX(position, glm::radians(-90.0f));
+								break;
+							case ModelOrientation::NegZ:
+								position = glm::rotateX(position, glm::radians(90.0f));
+								break;
+						}
 
-				if(containsNormals) {
-					aiVector3D norm = assimpMesh->mNormals[j];
-					normal = {norm.x, norm.y, norm.z};
-				}
+						vertices.emplace_back(position, texCoords, tangent, bitangent, normal);
+					}
 
-				//Apply axis correction
-				switch(modelOrientation) {
-					case ModelOrientation::PosY:
-						break;
-					case ModelOrientation::NegY:
-						position = glm::rotateZ(position, glm::radians(180.0f));
-						break;
-					case ModelOrientation::PosX:
-						position = glm::rotateZ(position, glm::radians(-90.0f));
-						break;
-					case ModelOrientation::NegX:
-						position = glm::rotateZ(position, glm::radians(90.0f));
-						break;
-					case ModelOrientation::PosZ:
-						position = glm::rotateX(position, glm::radians(-90.0f));
-						break;
-					case ModelOrientation::NegZ:
-						position = glm::rotateX(position, glm::radians(90.0f));
-						break;
-				}
+					for(int j = 0; j < assimpMesh->mNumFaces; j++) {
+						aiFace face = assimpMesh->mFaces[j];
+						indices.push_back({face.mIndices[0], face.mIndices[1], face.mIndices[2]});
+					}
 
-				Vertex vertex {position, texCoords, tangent, bitangent, normal};
-				vertices.push_back(vertex);
-			}
+					//Reorder for the vertex cache, overdraw and vertex fetches
+					if(optimize) OptimizeMesh(vertices, indices);
 
-			for(int j = 0; j < assimpMesh->mNumFaces; j++) {
-				aiFace face = assimpMesh->mFaces[j];
-				indices.push_back({face.mIndices[0], face.mIndices[1], face.mIndices[2]});
-			}
+					converted[i] = std::make_shared<Mesh>(std::move(vertices), std::move(indices));
 
-			meshes.insert_or_assign(assimpMesh->mName.length == 0 ? ("Mesh" + std::to_string(i)) : std::string(assimpMesh->mName.C_Str()), new Mesh(vertices, indices));
-		}
-	}
+					//Simplify it into its LOD chain
+					if(optimize) BuildLODs(*converted[i]);
+				}
+			},
+			1);
 
-	Model::~Model() {
-		meshes.clear();
+		//Name meshes in file order so that later duplicate names win like they always have
+		for(unsigned int i = 0; i < scene->mNumMeshes; i++) {
+			aiMesh* assimpMesh = scene->mMeshes[i];
+			meshes.insert_or_assign(assimpMesh->mName.length == 0 ? ("Mesh" + std::to_string(i)) : std::string(assimpMesh->mName.C_Str()), converted[i]);
+		}
 	}
 
 	std::vector<std::string> Model::ListMeshes() {
 		std::vector<std::string> keys;
-		for(std::map<std::string, Mesh*>::iterator it = meshes.begin(); it != meshes.end(); ++it) {
+		for(std::map<std::string, std::shared_ptr<Mesh>>::iterator it = meshes.begin(); it != meshes.end(); ++it) {
 			keys.push_back(it->first);
 		}
 		return keys;
 	}
 
-	Mesh* Model::ExtractMesh(std::string id) {
+	std::shared_ptr<Mesh> Model::ExtractMesh(std::string id) {
 		CheckException(meshes.contains(id), Exception::GetExceptionCodeFromMeaning("ContainerValue"), "Cannot extract mesh that model does not contain!")
 
-		Mesh* mesh = meshes.at(id);
-		return mesh;
+		return meshes.at(id);
 	}
 
 	bool Model::HasMesh(std::string id) {
 		return meshes.contains(id);
 	}
-}
+
+	bool Model::HasFreshCook(const std::string& filePath) {
+		return IsCookFresh(GetCookedPath(filePath), filePath);
+	}
+
+	std::shared_ptr<Model> Model::LoadCooked(const std::string& filePath) {
+		std::string cookedPath = GetCookedPath(filePath);
+		std::shared_ptr<MappedFile> file = VFS::GetInstance()->Open(cookedPath);
+		const unsigned char* data = file->GetData();
+		std::size_t size = file->GetSize();
+
+		//Validate header
+		CookedHeader header;
+		CheckException(size >= sizeof(CookedHeader), Exception::GetExceptionCodeFromMeaning("IO"), "Cooked model file \"" + cookedPath + "\" is truncated!")
+		std::memcpy(&header, data, sizeof(CookedHeader));
+		CheckException(std::memcmp(header.magic, cookedMagic, sizeof(cookedMagic)) == 0, Exception::GetExceptionCodeFromMeaning("IO"), "File \"" + cookedPath + "\" is not a cooked model file!")
+		CheckException(header.version == cookedVersion && header.vertexSize == sizeof(Vertex), Exception::GetExceptionCodeFromMeaning("IO"), "Cooked model file \"" + cookedPath + "\" was cooked for a different engine version and must be cooked again!")
+		CheckException(header.meshCount <= (size - sizeof(CookedHeader)) / sizeof(CookedMeshEntry), Exception::GetExceptionCodeFromMeaning("IO"), "Cooked model file \"" + cookedPath + "\" is truncated!")
+
+		//Check that a range lies within the file and is aligned for what it holds
+		auto inFile = [size](uint64_t offset, uint64_t count, std::size_t elementSize, std::size_t alignment) {
+			return offset <= size && count <= (size - offset) / elementSize && offset % alignment == 0;
+		};
+
+		//Point a mesh at each table entry's data
+		std::shared_ptr<Model> model(new Model());
+		std::vector<std::shared_ptr<Mesh>> loaded;
+		std::vector<bool> isLOD;
+		for(uint32_t i = 0; i < header.meshCount; i++) {
+			CookedMeshEntry entry;
+			std::memcpy(&entry, data + sizeof(CookedHeader) + (i * sizeof(CookedMeshEntry)), sizeof(CookedMeshEntry));
+			CheckException(inFile(entry.nameOffset, entry.nameLength, 1, 1) && inFile(entry.vertexOffset, entry.vertexCount, sizeof(Vertex), alignof(Vertex)) && inFile(entry.indexOffset, entry.triangleCount, sizeof(glm::uvec3), alignof(glm::uvec3)),
+				Exception::GetExceptionCodeFromMeaning("IO"), "Cooked model file \"" + cookedPath + "\" has a mesh outside of the file!")
+			CheckException(entry.parent < int64_t(i) && (entry.parent < 0 || !isLOD[entry.parent]), Exception::GetExceptionCodeFromMeaning("IO"), "Cooked model file \"" + cookedPath + "\" has a LOD without a mesh to belong to!")
+
+			std::span<const Vertex> vertices(reinterpret_cast<const Vertex*>(data + entry.vertexOffset), entry.vertexCount);
+			std::span<const glm::uvec3> indices(reinterpret_cast<const glm::uvec3*>(data + entry.indexOffset), entry.triangleCount);
+			BoundingBox bounds {{entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]}, {entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]}};
+			std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(file, vertices, indices, bounds);
+			loaded.push_back(mesh);
+			isLOD.push_back(entry.parent >= 0);
+
+			if(entry.parent >= 0) {
+				loaded[entry.parent]->AddLOD(mesh, entry.lodError);
+			} else {
+				model->meshes.insert_or_assign(std::string(reinterpret_cast<const char*>(data + entry.nameOffset), entry.nameLength), mesh);
+			}
+		}
+		return model;
+	}
+
+	void Model::Cook(const std::string& cookedPath) {
+		//Lay out the file
+		CookedHeader header {};
+		std::memcpy(header.magic, cookedMagic, sizeof(cookedMagic));
+		header.version = cookedVersion;
+		header.vertexSize = sizeof(Vertex);
+
+		std::vector<CookedMeshEntry> entries;
+		std::vector<std::shared_ptr<Mesh>> order;
+		std::string names;
+		auto addEntry = [&entries, &order](const std::shared_ptr<Mesh>& mesh, int32_t parent, float lodError) {
+			CookedMeshEntry entry {};
+			const BoundingBox& bounds = mesh->GetBounds();
+			for(int axis = 0; axis < 3; axis++) {
+				entry.boundsMin[axis] = bounds.min[axis];
+				entry.boundsMax[axis] = bounds.max[axis];
+			}
+			entry.parent = parent;
+			entry.lodError = lodError;
+			entries.push_back(entry);
+			order.push_back(mesh);
+		};
+		for(const auto& [name, mesh] : meshes) {
+			int32_t parent = entries.size();
+			addEntry(mesh, -1, 0.0f);
+			entries.back().nameLength = name.size();
+			entries.back().nameOffset = names.size();
+			names += name;
+			for(const MeshLOD& lod : mesh->GetLODs()) {
+				addEntry(lod.mesh, parent, lod.error);
+			}
+		}
+		header.meshCount = entries.size();
+
+		//Names go after the table
+		std::size_t namesStart = sizeof(CookedHeader) + (entries.size() * sizeof(CookedMeshEntry));
+		for(CookedMeshEntry& entry : entries) {
+			entry.nameOffset += namesStart;
+		}
+		std::size_t offset = namesStart + names.size();
+		for(std::size_t i = 0; i < entries.size(); i++) {
+			CookedMeshEntry& entry = entries[i];
+			const std::shared_ptr<Mesh>& mesh = order[i];
+			entry.vertexOffset = AlignCooked(offset);
+			entry.vertexCount = mesh->GetVertices().size();
+			entry.indexOffset = AlignCooked(entry.vertexOffset + mesh->GetVertices().size_bytes());
+			entry.triangleCount = mesh->GetIndices().size();
+			offset = entry.indexOffset + mesh->GetIndices().size_bytes();
+		}
+
+		//Write the file
+		CookedFileWriter out(cookedPath, "cooked model file");
+		out.Write(&header, sizeof(CookedHeader));
+		out.Write(entries.data(), entries.size() * sizeof(CookedMeshEntry));
+		out.Write(names.data(), names.size());
+		for(std::size_t i = 0; i < entries.size(); i++) {
+			const CookedMeshEntry& entry = entries[i];
+			const std::shared_ptr<Mesh>& mesh = order[i];
+			out.PadTo(entry.vertexOffset);
+			out.Write(mesh->GetVertices().data(), mesh->GetVertices().size_bytes());
+			out.PadTo(entry.indexOffset);
+			out.Write(mesh->GetIndices().data(), mesh->GetIndices().size_bytes());
+		}
+		out.Finish();
+	}
+}
\ No newline at end of file
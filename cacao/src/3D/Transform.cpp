@@ -1,5 +1,7 @@
 #include "3D/Transform.hpp"
 
+#include "World/Entity.hpp"
+
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/rotate_vector.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -23,4 +25,8 @@ namespace Cacao {
 		//Scale
 		transMat = glm::scale(transMat, scale);
 	}
+
+	void Transform::MarkDirty() {
+		if(owner) owner->InvalidateWorldTransform();
+	}
 }
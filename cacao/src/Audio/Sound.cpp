@@ -2,6 +2,7 @@
 
 #include "Core/Exception.hpp"
 #include "Audio/AudioSystem.hpp"
+#include "Utilities/VFS.hpp"
 
 #define DR_MP3_IMPLEMENTATION
 #define DR_WAV_IMPLEMENTATION
@@ -11,8 +12,8 @@
 #include "vorbis/vorbisfile.h"
 #include "opusfile.h"
 
-#include <filesystem>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 
 #define RETHROW_EXCEPTION(x)                              \
 	try {                                                 \
@@ -27,17 +28,21 @@
 namespace Cacao {
 	Sound::Sound(std::string filePath)
 	  : Asset(false), filePath(filePath) {
-		CheckException(std::filesystem::exists(filePath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load sound from nonexistent file!")
+		CheckException(VFS::GetInstance()->Exists(filePath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load sound from nonexistent file!")
+
+		//Open the file (the decoders read it straight from memory)
+		std::shared_ptr<MappedFile> file = VFS::GetInstance()->Open(filePath);
 
 		//Determine audio file format by reading header
+		//Reads past the end of the file come back empty
+		auto readHeader = [&file](std::size_t offset, std::size_t length) {
+			if(offset >= file->GetSize()) return std::string();
+			return std::string(reinterpret_cast<const char*>(file->GetData()) + offset, std::min(length, file->GetSize() - offset));
+		};
 
 		//Read the first four bytes of the file
-		std::string header(4, '\0');
-		std::ifstream file(filePath, std::ios::binary);
-		if(!file.is_open()) {
-			CheckException(false, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open the sound file!");
-		}
-		file.read(header.data(), header.size());
+		std::string header = readHeader(0, 4);
+		header.resize(4, '\0');
 
 		bool goodFormat = false;
 
@@ -49,43 +54,34 @@ namespace Cacao {
 			//The weird binary bit is checking for the sync instruction that all MP3 frames start with
 			if(mp3.compare("ID3") == 0 || (static_cast<unsigned char>(header[0]) == 0xFF && (static_cast<unsigned char>(header[1]) & 0xE0) == 0xE0)) {
 				goodFormat = true;
-				RETHROW_EXCEPTION(_InitMP3();)
+				RETHROW_EXCEPTION(_InitMP3(*file);)
 			}
 		}
 
 		//Check for WAV
 		if(header.compare("RIFF") == 0) {
 			//Read a bit more to confirm WAV
-			std::string waveHeader(4, '\0');
-			file.seekg(8, std::ios::beg);
-			file.read(&waveHeader[0], waveHeader.size());
-			if(waveHeader == "WAVE") {
+			if(readHeader(8, 4) == "WAVE") {
 				goodFormat = true;
-				RETHROW_EXCEPTION(_InitWAV();)
+				RETHROW_EXCEPTION(_InitWAV(*file);)
 			}
 		}
 
 		//Check for Ogg stream (Vorbis/Opus)
 		if(header.compare("OggS") == 0) {
 			//Read the Ogg Header
-			std::string oggHeader(64, '\0');
-			file.seekg(0, std::ios::beg);
-			file.read(&oggHeader[0], oggHeader.size());
-			file.close();
+			std::string oggHeader = readHeader(0, 64);
 
 			if(oggHeader.find("vorbis") != std::string::npos) {
 				goodFormat = true;
-				RETHROW_EXCEPTION(_InitVorbis();)
+				RETHROW_EXCEPTION(_InitVorbis(*file);)
 			} else if(oggHeader.find("OpusHead") != std::string::npos) {
 				goodFormat = true;
-				RETHROW_EXCEPTION(_InitOpus();)
+				RETHROW_EXCEPTION(_InitOpus(*file);)
 			}
 		}
 
-		//Close the file
-		file.close();
-
-		//Now we handle the potential bad header circumstance because we have closed the file
+		//Now we handle the potential bad header circumstance
 		CheckException(goodFormat, Exception::GetExceptionCodeFromMeaning("WrongType"), "The provided sound file is of an unsupported format!")
 	}
 
@@ -132,10 +128,10 @@ namespace Cacao {
 		compiled = false;
 	}
 
-	void Sound::_InitMP3() {
+	void Sound::_InitMP3(const MappedFile& file) {
 		//Open the MP3
 		drmp3 mp3;
-		CheckException(drmp3_init_file(&mp3, filePath.c_str(), nullptr), Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load MP3 sound file!");
+		CheckException(drmp3_init_memory(&mp3, file.GetData(), file.GetSize(), nullptr), Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load MP3 sound file!");
 
 		//Get file info
 		sampleRate = mp3.sampleRate;
@@ -152,10 +148,10 @@ namespace Cacao {
 		drmp3_uninit(&mp3);
 	}
 
-	void Sound::_InitWAV() {
+	void Sound::_InitWAV(const MappedFile& file) {
 		//Open the WAV
 		drwav wave;
-		CheckException(drwav_init_file(&wave, filePath.c_str(), nullptr), Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load WAV sound file!");
+		CheckException(drwav_init_memory(&wave, file.GetData(), file.GetSize(), nullptr), Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load WAV sound file!");
 
 		//Get file info
 		sampleRate = wave.sampleRate;
@@ -172,14 +168,43 @@ namespace Cacao {
 		drwav_uninit(&wave);
 	}
 
-	void Sound::_InitVorbis() {
+	//Where libvorbisfile is in a sound file being read from memory
+	struct VorbisMemoryCursor {
+		const unsigned char* data;
+		std::size_t size;
+		std::size_t pos;
+	};
+
+	void Sound::_InitVorbis(const MappedFile& file) {
 		//Define some variables for reading the file
 		OggVorbis_File vf;
 		int currentSection;
 
+		//Callbacks for reading the file from memory
+		VorbisMemoryCursor cursor {.data = file.GetData(), .size = file.GetSize(), .pos = 0};
+		ov_callbacks callbacks;
+		callbacks.read_func = [](void* ptr, size_t size, size_t nmemb, void* datasource) -> size_t {
+			VorbisMemoryCursor* c = static_cast<VorbisMemoryCursor*>(datasource);
+			if(size == 0) return 0;
+			std::size_t count = std::min(nmemb, (c->size - c->pos) / size);
+			std::memcpy(ptr, c->data + c->pos, count * size);
+			c->pos += count * size;
+			return count;
+		};
+		callbacks.seek_func = [](void* datasource, ogg_int64_t offset, int whence) -> int {
+			VorbisMemoryCursor* c = static_cast<VorbisMemoryCursor*>(datasource);
+			ogg_int64_t base = (whence == SEEK_SET ? 0 : (whence == SEEK_CUR ? ogg_int64_t(c->pos) : ogg_int64_t(c->size)));
+			if(base + offset < 0 || base + offset > ogg_int64_t(c->size)) return -1;
+			c->pos = std::size_t(base + offset);
+			return 0;
+		};
+		callbacks.close_func = nullptr;
+		callbacks.tell_func = [](void* datasource) -> long {
+			return long(static_cast<VorbisMemoryCursor*>(datasource)->pos);
+		};
+
 		//Open the file
-		FILE* f = fopen(filePath.c_str(), "rb");
-		CheckException(ov_open(f, &vf, nullptr, 0) >= 0, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open Ogg Vorbis sound file!");
+		CheckException(ov_open_callbacks(&cursor, &vf, nullptr, 0, callbacks) >= 0, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open Ogg Vorbis sound file!");
 
 		//Get file info
 		vorbis_info* info = ov_info(&vf, -1);
@@ -209,10 +234,11 @@ namespace Cacao {
 		ov_clear(&vf);
 	}
 
-	void Sound::_InitOpus() {
+	void Sound::_InitOpus(const MappedFile& file) {
 		//Open the file
 		int openError;
-		OggOpusFile* opus = op_open_file(filePath.c_str(), &openError);
+		OggOpusFile* opus = op_open_memory(file.GetData(), file.GetSize(), &openError);
+		CheckException(opus, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open Opus sound file!")
 
 		//Get file info
 		sampleRate = OPUS_SAMPLE_RATE;
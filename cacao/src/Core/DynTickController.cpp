@@ -8,7 +8,15 @@
 #include "World/WorldManager.hpp"
 #include "Graphics/Rendering/RenderController.hpp"
 #include "Graphics/Rendering/MeshComponent.hpp"
+#include "Graphics/Window.hpp"
 #include "Utilities/MultiFuture.hpp"
+#include "Utilities/ParallelFor.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <span>
 
 namespace Cacao {
 	//Required static variable initialization
@@ -27,6 +35,39 @@ namespace Cacao {
 		return instance;
 	}
 
+	namespace {
+		//Open-addressed map from resource to frame table index, allocated from the frame arena
+		//Used to list each mesh and material once per frame no matter how many objects share it
+		struct FrameLookup {
+			const void** keys;
+			uint32_t* indices;
+			std::size_t mask;
+
+			FrameLookup(LinearArena& arena, std::size_t maxEntries) {
+				//Keep the load factor at or below one half
+				std::size_t size = 16;
+				while(size < maxEntries * 2) size <<= 1;
+				keys = arena.Allocate<const void*>(size);
+				indices = arena.Allocate<uint32_t>(size);
+				mask = size - 1;
+			}
+
+			//Get the index of an item in a table, calling add to put it at the end of the table on first use
+			template<typename T, typename F>
+			uint32_t IndexOf(const std::vector<T>& table, const void* item, F&& add) {
+				std::size_t slot = (std::size_t)(((uintptr_t)item >> 4) * 0x9E3779B97F4A7C15ull) & mask;
+				while(keys[slot]) {
+					if(keys[slot] == item) return indices[slot];
+					slot = (slot + 1) & mask;
+				}
+				keys[slot] = item;
+				indices[slot] = (uint32_t)table.size();
+				add();
+				return indices[slot];
+			}
+		};
+	}
+
 	void DynTickController::Start() {
 		CheckException(!isRunning, Exception::GetExceptionCodeFromMeaning("BadInitState"), "Cannot start the already started dynamic tick controller!")
 		isRunning = true;
@@ -48,25 +89,111 @@ namespace Cacao {
 		isRunning = false;
 	}
 
-	void DynTickController::LocateComponents(std::shared_ptr<Entity> e, std::function<void(std::shared_ptr<Component>)> maybeMatch) {
-		//Stop if this component is inactive
-		if(!e->IsActive()) return;
+	bool DynTickController::BuildSchedule(World& world) {
+		//Only rebuild when the scripts in the world might have changed (declarations are fixed once a script is constructed)
+		uint64_t version = ComponentStore::GetVersion();
+		if(&world == scheduledWorld && version == scheduledVersion) return false;
+		scheduledWorld = &world;
+		scheduledVersion = version;
+		schedule.clear();
+
+		//Gather scripts by phase, along with the kinds on their entities (read now, while the store lock guards the component lists)
+		struct ScheduledScript {
+			Entity* owner;
+			Script* script;
+			std::size_t firstOwnKind, ownKindCount;
+		};
+		std::array<std::vector<ScheduledScript>, 3> phases;
+		std::vector<uint32_t> ownKinds;
+		const uint32_t transformKind = KindIDOf<Transform>();
+		world.Each<Script>([&phases, &ownKinds, transformKind](Entity& owner, Script& script) {
+			std::size_t first = ownKinds.size();
+			ownKinds.push_back(transformKind);
+			owner.AppendComponentKinds(ownKinds);
+			phases[(int)script.phase].push_back({&owner, &script, first, ownKinds.size() - first});
+		});
+
+		for(auto& phase : phases) {
+			//Waves before this index are closed off by a serial script
+			std::size_t firstWave = schedule.size();
+
+			//Last waves (plus one, zero meaning none) that touched each kind and entity
+			//Parallel scripts implicitly write every kind on their own entity, which is tracked separately since those writes never overlap each other
+			std::unordered_map<uint32_t, std::size_t> lastRead, lastWrite, lastOwn;
+			std::unordered_map<Entity*, std::size_t> lastEntity;
 
-		//Check for components
-		for(auto& it : e->components) {
-			std::shared_ptr<Component> c = e->GetComponent<Component>(it.first);
-			if(c && c->IsActive()) maybeMatch(c);
+			for(const ScheduledScript& entry : phase) {
+				Entity* owner = entry.owner;
+				Script* script = entry.script;
+				std::span<const uint32_t> own(ownKinds.data() + entry.firstOwnKind, entry.ownKindCount);
+
+				//Serial scripts get a wave to themselves after everything before them
+				if(!script->parallel) {
+					schedule.push_back({{script}, false});
+					firstWave = schedule.size();
+					continue;
+				}
+
+				//Find the earliest wave after everything this script conflicts with
+				std::size_t wave = firstWave;
+				auto after = [&wave](std::unordered_map<uint32_t, std::size_t>& last, uint32_t kind) {
+					auto it = last.find(kind);
+					if(it != last.end()) wave = std::max(wave, it->second);
+				};
+				auto entityIt = lastEntity.find(owner);
+				if(entityIt != lastEntity.end()) wave = std::max(wave, entityIt->second);
+				for(uint32_t kind : script->reads) {
+					after(lastWrite, kind);
+					after(lastOwn, kind);
+				}
+				for(uint32_t kind : script->writes) {
+					after(lastWrite, kind);
+					after(lastRead, kind);
+					after(lastOwn, kind);
+				}
+				for(uint32_t kind : own) {
+					after(lastWrite, kind);
+					after(lastRead, kind);
+				}
+
+				//Add to that wave
+				if(wave == schedule.size()) schedule.push_back({{}, true});
+				schedule[wave].scripts.push_back(script);
+
+				//Record what this wave now touches
+				lastEntity.insert_or_assign(owner, wave + 1);
+				for(uint32_t kind : script->reads) lastRead[kind] = std::max(lastRead[kind], wave + 1);
+				for(uint32_t kind : script->writes) lastWrite[kind] = std::max(lastWrite[kind], wave + 1);
+				for(uint32_t kind : own) lastOwn[kind] = std::max(lastOwn[kind], wave + 1);
+			}
 		}
+		return true;
+	}
+
+	template<typename F>
+	void DynTickController::RunSchedule(F&& func) {
+		for(TickWave& wave : schedule) {
+			//Small or serial waves aren't worth handing out
+			if(!wave.parallel || wave.scripts.size() == 1) {
+				for(Script* script : wave.scripts) {
+					func(*script);
+				}
+				continue;
+			}
 
-		//Recurse through children
-		for(std::shared_ptr<Entity> child : e->GetChildrenAsList()) {
-			LocateComponents(child, maybeMatch);
+			ParallelFor(wave.scripts.size(), [&wave, &func](std::size_t start, std::size_t end) {
+				for(std::size_t i = start; i < end; i++) {
+					func(*wave.scripts[i]);
+				}
+			});
 		}
 	}
 
 	void DynTickController::Run(std::stop_token stopTkn) {
 		//Run while we haven't been asked to stop
 		timestep = 0.0;
+		fixedAccumulator = 0.0;
+		std::chrono::steady_clock::time_point lastTickStart = std::chrono::steady_clock::now();
 		while(!stopTkn.stop_requested()) {
 			//Get time at tick start and calculate ideal run time
 			std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
@@ -75,52 +202,176 @@ namespace Cacao {
 			//Freeze input state
 			Input::GetInstance()->FreezeFrameInputState();
 
-			//Find all scripts that need to be run
-			tickScriptList.clear();
+			//Work out which scripts can run at the same time (only if the world's scripts changed)
+			//The world stays pinned so scripts deleted during the tick aren't freed while scheduled
 			World& activeWorld = WorldManager::GetInstance()->GetActiveWorld();
-			for(std::shared_ptr<Entity> ent : activeWorld.rootEntity->GetChildrenAsList()) {
-				//Execute the script locator
-				LocateComponents(ent, [this](std::shared_ptr<Component> c) {
-					if(c->GetKind() == "SCRIPT") {
-						//Add to list
-						this->tickScriptList.push_back(c);
-					}
+			ComponentStore::PinGuard pin = activeWorld.PinComponents();
+			bool rescheduled = BuildSchedule(activeWorld);
+
+			//Run as many fixed ticks as fit in the time that has passed
+			const double fixedStep = 1.0 / Engine::GetInstance()->cfg.fixedTickRate;
+			fixedAccumulator += std::chrono::duration<double>(tickStart - lastTickStart).count();
+			lastTickStart = tickStart;
+			int fixedTicks = 0;
+			while(fixedAccumulator >= fixedStep) {
+				//If we're too far behind, drop the remaining time rather than spiraling into ever longer ticks
+				if(fixedTicks == Engine::GetInstance()->cfg.maxFixedTicks) {
+					std::stringstream dropped;
+					dropped << "Dropping " << (int)(fixedAccumulator / fixedStep) << " fixed ticks to catch up";
+					Logging::EngineLog(dropped.str(), LogLevel::Trace);
+					fixedAccumulator = std::fmod(fixedAccumulator, fixedStep);
+					break;
+				}
+
+				RunSchedule([](Script& script) {
+					script.OnFixedTick();
 				});
+				fixedAccumulator -= fixedStep;
+				fixedTicks++;
 			}
 
 			//Execute scripts
-			for(std::shared_ptr<Component>& s : tickScriptList) {
-				Script* script = static_cast<Script*>(s.get());
-				script->OnTick(timestep);
+			RunSchedule([this](Script& script) {
+				script.OnTick(timestep);
+			});
+
+			//Fill in the next frame (reused, so clear out the last contents while keeping their storage)
+			Frame& f = RenderController::GetInstance()->BeginFrame();
+			std::size_t arenaAllocs = f.arena.GetAllocationCount();
+			f.arena.Reset();
+			f.meshes.clear();
+			f.materials.clear();
+			f.textures.clear();
+			f.allocations = (rescheduled ? 1 : 0);
+			f.projection = activeWorld.cam->GetProjectionMatrix();
+			f.view = activeWorld.cam->GetViewMatrix();
+			f.skybox = activeWorld.skybox;
+			f.fixedTickAlpha = fixedAccumulator / fixedStep;
+
+			//Bring moved entities' world transforms up to date
+			activeWorld.UpdateTransforms();
+
+			//Make room for every mesh component up front so that nothing grows while we gather
+			std::size_t maxObjects = activeWorld.Count<MeshComponent>();
+			RenderObject* objects = f.arena.Allocate<RenderObject>(maxObjects);
+			FrameLookup meshLookup(f.arena, maxObjects), materialLookup(f.arena, maxObjects);
+			if(f.meshes.capacity() < maxObjects) {
+				f.meshes.reserve(maxObjects);
+				f.allocations++;
+			}
+			if(f.materials.capacity() < maxObjects) {
+				f.materials.reserve(maxObjects);
+				f.allocations++;
 			}
 
-			//Create frame object
-			std::shared_ptr<Frame> f = std::make_shared<Frame>();
-			f->projection = activeWorld.cam->GetProjectionMatrix();
-			f->view = activeWorld.cam->GetViewMatrix();
-			f->skybox = activeWorld.skybox;
+			//Largest on-screen size (in pixels) of anything drawn with each material, so textures can stream in the detail they need
+			float* materialScreenSize = f.arena.Allocate<float>(maxObjects);
+			std::fill(materialScreenSize, materialScreenSize + maxObjects, 0.0f);
+
+			//LODs are picked by how many pixels their error covers on screen
+			//Their errors are estimates (root mean square distances), so this keeps typical error under the threshold rather than guaranteeing it
+			//Coarser LODs have to beat the threshold by a margin before being switched to, so objects near the threshold don't keep popping between LODs
+			constexpr float lodHysteresis = 0.25f;
+			const float lodThreshold = Engine::GetInstance()->cfg.lodErrorPixels;
+			const glm::vec3 camPos = activeWorld.cam->GetPosition();
+			const float pixelsPerUnitAtOne = f.projection[1][1] * Window::GetInstance()->GetSize().y * 0.5f;
+
+			//View frustum planes (facing inwards and normalized), pulled out of the combined view and projection matrix
+			const glm::mat4 viewProjection = f.projection * f.view;
+			const glm::vec4 wRow(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+			std::array<glm::vec4, 6> frustum;
+			for(int axis = 0; axis < 3; axis++) {
+				glm::vec4 row(viewProjection[0][axis], viewProjection[1][axis], viewProjection[2][axis], viewProjection[3][axis]);
+				frustum[axis * 2] = wRow + row;
+				frustum[axis * 2 + 1] = wRow - row;
+			}
+			for(glm::vec4& plane : frustum) {
+				plane /= glm::length(glm::vec3(plane));
+			}
 
 			//Accumulate things to render
-			for(std::shared_ptr<Entity> ent : activeWorld.rootEntity->GetChildrenAsList()) {
-				//Execute the mesh locator
-				LocateComponents(ent, [&f](std::shared_ptr<Component> c) {
-					if(c->GetKind() == "MESH") {
-						//Add to list
-						MeshComponent* mc = std::dynamic_pointer_cast<MeshComponent>(c).get();
-						f->objects.emplace_back(c->GetOwner().lock()->GetWorldTransformMatrix(), mc->mesh, *(mc->mat));
+			std::size_t objectCount = 0;
+			activeWorld.Each<MeshComponent>([&](Entity& owner, MeshComponent& mc) {
+				//Components added since we counted wait for the next frame
+				if(objectCount == maxObjects) return;
+
+				RenderObject& obj = objects[objectCount++];
+				obj.transformMatrix = owner.GetWorldTransformMatrix();
+
+				//Pick the LOD to draw
+				std::shared_ptr<Mesh>& fullMesh = mc.mesh.GetManagedAsset();
+				const std::vector<MeshLOD>& lods = fullMesh->GetLODs();
+				mc.lod = std::min<unsigned int>(mc.lod, lods.size());
+
+				//Find how many pixels a unit covers at the nearest point of the mesh's bounds, and how many the whole mesh covers
+				const BoundingBox& bounds = fullMesh->GetBounds();
+				float worldScale = std::max({glm::length(glm::vec3(obj.transformMatrix[0])), glm::length(glm::vec3(obj.transformMatrix[1])), glm::length(glm::vec3(obj.transformMatrix[2]))});
+				glm::vec3 center = obj.transformMatrix * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f);
+				float radius = glm::length(bounds.max - bounds.min) * 0.5f * worldScale;
+				float distance = std::max(glm::length(center - camPos) - radius, 0.001f);
+				float pixelsPerUnit = worldScale * pixelsPerUnitAtOne / distance;
+				float screenSize = 2.0f * radius * pixelsPerUnitAtOne / distance;
+
+				//Nothing entirely out of view (including behind the camera) needs any texture detail
+				for(const glm::vec4& plane : frustum) {
+					if(glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+						screenSize = 0.0f;
+						break;
 					}
+				}
+				if(!lods.empty()) {
+					auto errorPixels = [&lods, pixelsPerUnit](unsigned int lod) {
+						return lods[lod - 1].error * pixelsPerUnit;
+					};
+
+					while(mc.lod < lods.size() && errorPixels(mc.lod + 1) <= lodThreshold * (1.0f - lodHysteresis)) mc.lod++;
+					while(mc.lod > 0 && errorPixels(mc.lod) > lodThreshold) mc.lod--;
+				}
+				const std::shared_ptr<Mesh>& mesh = (mc.lod == 0 ? fullMesh : lods[mc.lod - 1].mesh);
+				obj.mesh = meshLookup.IndexOf(f.meshes, mesh.get(), [&f, &mesh]() {
+					f.meshes.push_back(mesh);
 				});
+
+				//Capture each material the first time it's used, so the renderer draws it as it is now
+				obj.material = materialLookup.IndexOf(f.materials, mc.mat.get(), [&f, &mc]() {
+					std::size_t textureCapacity = f.textures.capacity();
+					f.materials.push_back(mc.mat->Capture(f.arena, f.textures));
+					if(f.textures.capacity() != textureCapacity) f.allocations++;
+				});
+				materialScreenSize[obj.material] = std::max(materialScreenSize[obj.material], screenSize);
+
+				//Quantized meshes need their positions scaled back up
+				if(mesh->GetVertexFormat() == VertexFormat::Quantized) obj.transformMatrix *= mesh->GetPositionTransform();
+			});
+
+			//Let textures know how much detail they're about to be drawn with
+			for(std::size_t i = 0; i < f.materials.size(); i++) {
+				const MaterialSnapshot& mat = f.materials[i];
+				for(std::size_t t = mat.firstTexture; t < mat.firstTexture + mat.textureCount; t++) {
+					if(f.textures[t].texture) f.textures[t].texture->RequestDetail(materialScreenSize[i]);
+				}
 			}
 
+			//Sort by shader, then material, then mesh so that the renderer can skip redundant binds
+			std::sort(objects, objects + objectCount, [&f](const RenderObject& a, const RenderObject& b) {
+				Shader* shaderA = f.materials[a.material].shader.get();
+				Shader* shaderB = f.materials[b.material].shader.get();
+				if(shaderA != shaderB) return std::less<Shader*> {}(shaderA, shaderB);
+				if(a.material != b.material) return a.material < b.material;
+				return a.mesh < b.mesh;
+			});
+			f.objects = std::span<RenderObject>(objects, objectCount);
+			f.allocations += f.arena.GetAllocationCount() - arenaAllocs;
+
 			//Send frame to render controller
-			RenderController::GetInstance()->EnqueueFrame(f);
+			RenderController::GetInstance()->SubmitFrame();
 
 			//Check elapsed time and set timestep
 			std::chrono::steady_clock::time_point tickEnd = std::chrono::steady_clock::now();
-			timestep = (((double)std::chrono::duration_cast<std::chrono::milliseconds>((tickEnd - tickStart) + (tickEnd < idealStopTime ? (idealStopTime - tickEnd) : std::chrono::seconds(0))).count()) / 1000);
+			timestep = std::chrono::duration<double>((tickEnd - tickStart) + (tickEnd < idealStopTime ? (idealStopTime - tickEnd) : std::chrono::steady_clock::duration::zero())).count();
 
 			std::stringstream loggo;
-			loggo << "Tick took " << std::chrono::duration_cast<std::chrono::microseconds>(tickEnd - tickStart);
+			loggo << "Tick took " << std::chrono::duration_cast<std::chrono::microseconds>(tickEnd - tickStart) << " (" << f.allocations << " frame allocations)";
 			Logging::EngineLog(loggo.str(), LogLevel::Trace);
 
 			//If we stopped before the ideal max time, wait until that point
@@ -8,6 +8,8 @@
 #include "Audio/AudioPlayer.hpp"
 #include "Graphics/Rendering/RenderController.hpp"
 #include "UI/FreetypeOwner.hpp"
+#include "Utilities/AssetManager.hpp"
+#include "Utilities/VFS.hpp"
 
 #include "yaml-cpp/yaml.h"
 
@@ -57,14 +59,29 @@ namespace Cacao {
 		//Load game module and module config
 		gameLib.reset(new dynalo::library(launchRoot["launch"].Scalar() + "/launch." + dynalo::native::name::extension()));
 		cfg.fixedTickRate = (launchRoot["fixedTickRate"].IsScalar() ? std::stoi(launchRoot["fixedTickRate"].Scalar()) : cfg.fixedTickRate);
+		cfg.maxFixedTicks = (launchRoot["maxFixedTicks"].IsScalar() ? std::stoi(launchRoot["maxFixedTicks"].Scalar()) : cfg.maxFixedTicks);
+		cfg.lodErrorPixels = (launchRoot["lodErrorPixels"].IsScalar() ? std::stof(launchRoot["lodErrorPixels"].Scalar()) : cfg.lodErrorPixels);
+		cfg.shaderCacheDir = (launchRoot["shaderCacheDir"].IsScalar() ? launchRoot["shaderCacheDir"].Scalar() : cfg.shaderCacheDir);
+		cfg.textureUploadBudget = (launchRoot["textureUploadBudget"].IsScalar() ? std::stoull(launchRoot["textureUploadBudget"].Scalar()) : cfg.textureUploadBudget);
+		cfg.textureMemoryBudget = (launchRoot["textureMemoryBudget"].IsScalar() ? std::stoull(launchRoot["textureMemoryBudget"].Scalar()) : cfg.textureMemoryBudget);
+		cfg.assetMemoryBudget = (launchRoot["assetMemoryBudget"].IsScalar() ? std::stoull(launchRoot["assetMemoryBudget"].Scalar()) : cfg.assetMemoryBudget);
 		cfg.targetDynTPS = (launchRoot["dynamicTPS"].IsScalar() ? std::stoi(launchRoot["dynamicTPS"].Scalar()) : cfg.targetDynTPS);
-		cfg.maxFrameLag = (launchRoot["maxFrameLag"].IsScalar() ? std::stoi(launchRoot["maxFrameLag"].Scalar()) : cfg.maxFrameLag);
 		if(launchRoot["title"].IsScalar()) Window::GetInstance()->SetTitle(launchRoot["title"].Scalar());
 		if(launchRoot["dimensions"].IsMap() && launchRoot["dimensions"]["x"].IsScalar() && launchRoot["dimensions"]["y"].IsScalar()) {
 			Window::GetInstance()->SetSize({std::stoi(launchRoot["dimensions"]["x"].Scalar()), std::stoi(launchRoot["dimensions"]["y"].Scalar())});
 		}
 		if(launchRoot["workingDir"].IsScalar() && std::filesystem::exists(launchRoot["workingDir"].Scalar())) std::filesystem::current_path(launchRoot["workingDir"].Scalar());
 
+		//Mount asset archives (relative to the working directory, in order so later ones override earlier ones)
+		if(launchRoot["archives"].IsSequence()) {
+			for(const YAML::Node& archive : launchRoot["archives"]) {
+				CheckException(archive.IsScalar(), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "Launch config \"archives\" parameter contains a non-scalar value!")
+				VFS::GetInstance()->Mount(archive.Scalar());
+			}
+		} else if(launchRoot["archives"].IsScalar()) {
+			VFS::GetInstance()->Mount(launchRoot["archives"].Scalar());
+		}
+
 		//Initialize FreeType
 		FreetypeOwner::GetInstance()->Init();
 
@@ -119,8 +136,13 @@ namespace Cacao {
 
 		//Set some default engine config values
 		cfg.fixedTickRate = 50;
+		cfg.maxFixedTicks = 5;
+		cfg.lodErrorPixels = 1.0f;
+		cfg.shaderCacheDir = "shadercache";
+		cfg.textureUploadBudget = 8 * 1024 * 1024;
+		cfg.textureMemoryBudget = 256 * 1024 * 1024;
+		cfg.assetMemoryBudget = 512 * 1024 * 1024;
 		cfg.targetDynTPS = 60;
-		cfg.maxFrameLag = 10;
 
 		//Open the window
 		Window::GetInstance()->Open("Cacao Engine", {1280, 720}, false, WindowMode::Window);
@@ -147,6 +169,9 @@ namespace Cacao {
 
 	void Engine::Stop() {
 		run.store(false);
+
+		//Make sure the render thread notices
+		RenderController::GetInstance()->WakeUp();
 	}
 
 	void Engine::CoreShutdown() {
@@ -165,6 +190,10 @@ namespace Cacao {
 		auto exitFunc = gameLib->get_function<void(void)>("_CacaoExiting");
 		exitFunc();
 
+		//Drop assets that were only being kept around in case they were needed again
+		Logging::EngineLog("Dropping released assets...");
+		AssetManager::GetInstance()->ClearReleased();
+
 		//Shut down the audio system
 		Logging::EngineLog("Shutting down audio system...");
 		AudioSystem::GetInstance()->Shutdown();
@@ -26,32 +26,20 @@ namespace Cacao {
 
 		//Run while the engine does
 		while(Engine::GetInstance()->IsRunning()) {
+			//Note the wakeup count before looking for work so that anything submitted after this point wakes us
+			uint32_t seenWakeups = wakeCounter.load();
+
 			//Update window and graphics state
 			Window::GetInstance()->Update();
 			UpdateGraphicsState();
 
-			//Acquire a lock on the queue
-			std::unique_lock<std::mutex> lock(fqMutex);
-
-			//Discard frames if we're too far behind
-			int maxFrameLag = Engine::GetInstance()->cfg.maxFrameLag;
-			if(frameQueue.size() > maxFrameLag) {
-				while(frameQueue.size() > 1) {
-					frameQueue.pop();
-				}
-			}
-
-			//Process frame if it exists
-			if(!frameQueue.empty()) {
-				//Acquire the next frame and pop it
-				std::shared_ptr<Frame> next = frameQueue.front();
-				frameQueue.pop();
+			//Process the latest frame if there is a new one
+			//Only the newest frame is ever kept, so there is no backlog to drop
+			if(frames.Acquire()) {
+				Frame& next = frames.GetReadBuffer();
 
 				std::chrono::steady_clock::time_point fb = std::chrono::steady_clock::now();
 
-				//Release lock
-				lock.unlock();
-
 				//If the global UI is dirty, re-render
 				if(Engine::GetInstance()->GetGlobalUIView()->GetScreen() && Engine::GetInstance()->GetGlobalUIView()->GetScreen()->IsDirty()) {
 					Engine::GetInstance()->GetGlobalUIView()->Render();
@@ -67,9 +55,16 @@ namespace Cacao {
 				loggo << "Render took " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - fb);
 				Logging::EngineLog(loggo.str(), LogLevel::Trace);
 			} else {
-				//Release lock and wait for a bit to avoid wasting CPU cycles
-				lock.unlock();
-				std::this_thread::sleep_for(std::chrono::microseconds(1));
+				//Sleep until there is new work
+				//The timeout keeps window events flowing when nothing is being submitted (e.g. while loading)
+				sleeping.store(true);
+				{
+					std::unique_lock<std::mutex> lk(wakeMtx);
+					wakeCV.wait_for(lk, std::chrono::milliseconds(10), [this, seenWakeups]() {
+						return wakeCounter.load() != seenWakeups || !Engine::GetInstance()->IsRunning();
+					});
+				}
+				sleeping.store(false);
 			}
 		}
 	}
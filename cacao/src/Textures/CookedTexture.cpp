@@ -0,0 +1,128 @@
+#include "Graphics/Textures/CookedTexture.hpp"
+#include "Graphics/Textures/MipChain.hpp"
+#include "Core/Exception.hpp"
+#include "Core/Log.hpp"
+#include "Utilities/VFS.hpp"
+#include "Utilities/CookedFile.hpp"
+
+#include "glm/common.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace Cacao {
+	//Cooked texture file layout
+	//A header, then a table entry per mip level (largest first), then each level's pixels (each aligned to cookedAlignment)
+	//The pixel format leaves room for block-compressed formats later, but for now pixels are always uncompressed with 8 bits per channel
+	struct CookedTextureHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t pixelFormat;
+		uint32_t channels;
+		uint32_t srgb;
+		uint32_t levelCount;
+	};
+	struct CookedLevelEntry {
+		uint32_t width, height;
+		uint64_t offset, size;
+	};
+	constexpr char cookedMagic[4] = {'C', 'T', 'E', 'X'};
+	constexpr uint32_t cookedVersion = 1;
+	constexpr uint32_t uncompressedFormat = 0;
+	constexpr uint32_t maxLevels = 32;
+
+	CookedTexture::CookedTexture(const std::string& path)
+	  : file(VFS::GetInstance()->Open(path)) {
+		const unsigned char* data = file->GetData();
+		std::size_t size = file->GetSize();
+
+		//Validate header
+		CookedTextureHeader header;
+		CheckException(size >= sizeof(CookedTextureHeader), Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" is truncated!")
+		std::memcpy(&header, data, sizeof(CookedTextureHeader));
+		CheckException(std::memcmp(header.magic, cookedMagic, sizeof(cookedMagic)) == 0, Exception::GetExceptionCodeFromMeaning("IO"), "File \"" + path + "\" is not a cooked texture file!")
+		CheckException(header.version == cookedVersion && header.pixelFormat == uncompressedFormat, Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" was cooked for a different engine version and must be cooked again!")
+		CheckException(header.channels == 1 || header.channels == 3 || header.channels == 4, Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" has an unsupported channel count!")
+		CheckException(header.levelCount > 0 && header.levelCount <= maxLevels, Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" has an invalid mip chain!")
+		CheckException(header.levelCount <= (size - sizeof(CookedTextureHeader)) / sizeof(CookedLevelEntry), Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" is truncated!")
+		channels = header.channels;
+		srgb = header.srgb != 0;
+
+		//Point each level at its pixels, checking that every level halves the one before it
+		for(uint32_t i = 0; i < header.levelCount; i++) {
+			CookedLevelEntry entry;
+			std::memcpy(&entry, data + sizeof(CookedTextureHeader) + (i * sizeof(CookedLevelEntry)), sizeof(CookedLevelEntry));
+			glm::ivec2 levelSize {int(std::min<uint32_t>(entry.width, INT32_MAX)), int(std::min<uint32_t>(entry.height, INT32_MAX))};
+			if(i == 0) {
+				CheckException(levelSize.x > 0 && levelSize.y > 0, Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" has an empty image!")
+			} else {
+				CheckException(levelSize == glm::max(levels.back().size / 2, glm::ivec2(1)) && levels.back().size != glm::ivec2(1), Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" has an invalid mip chain!")
+			}
+			CheckException(entry.size == uint64_t(levelSize.x) * uint64_t(levelSize.y) * channels && entry.offset <= size && entry.size <= size - entry.offset && entry.offset % cookedAlignment == 0,
+				Exception::GetExceptionCodeFromMeaning("IO"), "Cooked texture file \"" + path + "\" has a mip level outside of the file!")
+			levels.push_back({.size = levelSize, .data = data + entry.offset, .bytes = std::size_t(entry.size)});
+		}
+	}
+
+	bool CookedTexture::HasFreshCook(const std::string& filePath) {
+		return IsCookFresh(GetCookedPath(filePath), filePath);
+	}
+
+	std::shared_ptr<CookedTexture> CookedTexture::Find(const std::string& filePath) {
+		if(IsCookedPath(filePath)) return std::make_shared<CookedTexture>(filePath);
+		if(!HasFreshCook(filePath)) return nullptr;
+		try {
+			return std::make_shared<CookedTexture>(GetCookedPath(filePath));
+		} catch(...) {
+			Logging::EngineLog("Cooked texture file for \"" + filePath + "\" is unusable, decoding the image file instead", LogLevel::Warn);
+			return nullptr;
+		}
+	}
+
+	void CookedTexture::Cook(const unsigned char* pixels, glm::ivec2 size, int channels, bool srgb, const std::string& cookedPath) {
+		CheckException(channels == 1 || channels == 3 || channels == 4, Exception::GetExceptionCodeFromMeaning("WrongType"), "Cannot cook texture with an unsupported channel count!")
+		CheckException(size.x > 0 && size.y > 0, Exception::GetExceptionCodeFromMeaning("WrongType"), "Cannot cook empty texture!")
+		srgb = srgb && channels >= 3;
+
+		//Build the mip chain (in linear space for sRGB images, so mips don't get darker)
+		std::vector<MipLevel> mips = GenerateMipChain(pixels, size, channels, srgb);
+
+		//Lay out the file
+		CookedTextureHeader header {};
+		std::memcpy(header.magic, cookedMagic, sizeof(cookedMagic));
+		header.version = cookedVersion;
+		header.pixelFormat = uncompressedFormat;
+		header.channels = channels;
+		header.srgb = srgb;
+		header.levelCount = mips.size() + 1;
+
+		std::vector<CookedLevelEntry> entries;
+		std::vector<const unsigned char*> levelData;
+		std::size_t offset = sizeof(CookedTextureHeader) + (header.levelCount * sizeof(CookedLevelEntry));
+		auto addLevel = [&entries, &levelData, &offset, channels](glm::ivec2 levelSize, const unsigned char* data) {
+			CookedLevelEntry entry {};
+			entry.width = levelSize.x;
+			entry.height = levelSize.y;
+			entry.offset = AlignCooked(offset);
+			entry.size = std::size_t(levelSize.x) * levelSize.y * channels;
+			offset = entry.offset + entry.size;
+			entries.push_back(entry);
+			levelData.push_back(data);
+		};
+		addLevel(size, pixels);
+		for(const MipLevel& mip : mips) {
+			addLevel(mip.size, mip.data.data());
+		}
+
+		//Write the file
+		CookedFileWriter out(cookedPath, "cooked texture file");
+		out.Write(&header, sizeof(CookedTextureHeader));
+		out.Write(entries.data(), entries.size() * sizeof(CookedLevelEntry));
+		for(std::size_t i = 0; i < entries.size(); i++) {
+			out.PadTo(entries[i].offset);
+			out.Write(levelData[i], entries[i].size);
+		}
+		out.Finish();
+	}
+}
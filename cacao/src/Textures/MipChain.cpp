@@ -0,0 +1,70 @@
+#include "Graphics/Textures/MipChain.hpp"
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+namespace Cacao {
+	//sRGB to linear conversion for every 8-bit value
+	static const std::array<float, 256>& SRGBToLinearTable() {
+		static const std::array<float, 256> table = []() {
+			std::array<float, 256> t;
+			for(int i = 0; i < 256; i++) {
+				float c = i / 255.0f;
+				t[i] = (c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f));
+			}
+			return t;
+		}();
+		return table;
+	}
+
+	static unsigned char LinearToSRGB(float c) {
+		c = (c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f);
+		return (unsigned char)std::clamp(std::lround(c * 255.0f), 0l, 255l);
+	}
+
+	std::vector<MipLevel> GenerateMipChain(const unsigned char* data, glm::ivec2 size, int channels, bool srgb) {
+		const std::array<float, 256>& toLinear = SRGBToLinearTable();
+		std::vector<MipLevel> levels;
+		int levelCount = 0;
+		for(int largest = std::max(size.x, size.y); largest > 1; largest /= 2) levelCount++;
+		levels.reserve(levelCount);
+
+		const unsigned char* src = data;
+		glm::ivec2 srcSize = size;
+		while(srcSize.x > 1 || srcSize.y > 1) {
+			MipLevel& level = levels.emplace_back();
+			level.size = glm::max(srcSize / 2, glm::ivec2(1));
+			level.data.resize(std::size_t(level.size.x) * level.size.y * channels);
+
+			for(int y = 0; y < level.size.y; y++) {
+				//Odd sizes leave the last row or column out of the footprint, which is the usual box filter tradeoff
+				int y0 = std::min(y * 2, srcSize.y - 1), y1 = std::min(y * 2 + 1, srcSize.y - 1);
+				for(int x = 0; x < level.size.x; x++) {
+					int x0 = std::min(x * 2, srcSize.x - 1), x1 = std::min(x * 2 + 1, srcSize.x - 1);
+					const unsigned char* texels[4] = {
+						src + (std::size_t(y0) * srcSize.x + x0) * channels,
+						src + (std::size_t(y0) * srcSize.x + x1) * channels,
+						src + (std::size_t(y1) * srcSize.x + x0) * channels,
+						src + (std::size_t(y1) * srcSize.x + x1) * channels};
+					unsigned char* out = &level.data[(std::size_t(y) * level.size.x + x) * channels];
+
+					for(int c = 0; c < channels; c++) {
+						//Alpha is the fourth channel, and single and dual channel images are treated as data
+						bool color = srgb && channels >= 3 && c < 3;
+						if(color) {
+							float sum = toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] + toLinear[texels[3][c]];
+							out[c] = LinearToSRGB(sum * 0.25f);
+						} else {
+							out[c] = (unsigned char)((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2) / 4);
+						}
+					}
+				}
+			}
+
+			src = level.data.data();
+			srcSize = level.size;
+		}
+		return levels;
+	}
+}
@@ -0,0 +1,33 @@
+#include "Core/Log.hpp"
+#include "Core/Exception.hpp"
+#include "3D/Model.hpp"
+
+#include <iostream>
+#include <exception>
+
+//Offline model cooker
+//Imports each model file given with Assimp and writes its cooked model file next to it, which the engine will then load instead
+int main(int argc, char* argv[]) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << (argc > 0 ? argv[0] : "cacaocook") << " <model file>...\n";
+		return 1;
+	}
+
+	//Initialize logging (exceptions log themselves)
+	Cacao::Logging::Init();
+
+	int failures = 0;
+	for(int i = 1; i < argc; i++) {
+		std::string path = argv[i];
+		try {
+			Cacao::Model model(path);
+			model.Cook(Cacao::Model::GetCookedPath(path));
+			std::cout << "Cooked \"" << path << "\" -> \"" << Cacao::Model::GetCookedPath(path) << "\"\n";
+		} catch(std::exception& e) {
+			std::cerr << "Failed to cook \"" << path << "\": " << e.what() << "\n";
+			failures++;
+		}
+	}
+
+	return (failures > 0 ? 1 : 0);
+}
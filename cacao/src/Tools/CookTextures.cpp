@@ -0,0 +1,58 @@
+#include "Core/Log.hpp"
+#include "Core/Exception.hpp"
+#include "Graphics/Textures/CookedTexture.hpp"
+
+#include "stb_image.h"
+
+#include <iostream>
+#include <exception>
+#include <memory>
+#include <cstring>
+
+//Offline texture cooker
+//Decodes each image file given and writes its cooked texture file (with a full mip chain) next to it, which the engine will then load instead
+int main(int argc, char* argv[]) {
+	//Images are treated as sRGB color unless told otherwise (e.g. for normal maps and other data)
+	bool linear = false;
+	int first = 1;
+	if(argc > 1 && std::strcmp(argv[1], "--linear") == 0) {
+		linear = true;
+		first = 2;
+	}
+	if(argc <= first) {
+		std::cerr << "Usage: " << (argc > 0 ? argv[0] : "cacaotexcook") << " [--linear] <image file>...\n";
+		return 1;
+	}
+
+	//Initialize logging (exceptions log themselves)
+	Cacao::Logging::Init();
+
+	//Flip images the same way the engine does when it decodes them (because OpenGL)
+	stbi_set_flip_vertically_on_load(true);
+
+	int failures = 0;
+	for(int i = first; i < argc; i++) {
+		std::string path = argv[i];
+		try {
+			glm::ivec2 size;
+			int channels;
+			std::unique_ptr<unsigned char, void (*)(void*)> pixels(stbi_load(path.c_str(), &size.x, &size.y, &channels, 0), stbi_image_free);
+			if(!pixels) throw Cacao::Exception {"Failed to decode image file!", Cacao::Exception::GetExceptionCodeFromMeaning("IO")};
+
+			//Two-channel images aren't supported by textures, so they get expanded
+			if(channels == 2) {
+				pixels.reset(stbi_load(path.c_str(), &size.x, &size.y, &channels, 4));
+				if(!pixels) throw Cacao::Exception {"Failed to decode image file!", Cacao::Exception::GetExceptionCodeFromMeaning("IO")};
+				channels = 4;
+			}
+
+			Cacao::CookedTexture::Cook(pixels.get(), size, channels, !linear, Cacao::CookedTexture::GetCookedPath(path));
+			std::cout << "Cooked \"" << path << "\" -> \"" << Cacao::CookedTexture::GetCookedPath(path) << "\"\n";
+		} catch(std::exception& e) {
+			std::cerr << "Failed to cook \"" << path << "\": " << e.what() << "\n";
+			failures++;
+		}
+	}
+
+	return (failures > 0 ? 1 : 0);
+}
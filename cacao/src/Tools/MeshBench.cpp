@@ -0,0 +1,69 @@
+#include "Core/Log.hpp"
+#include "Core/Exception.hpp"
+#include "3D/Model.hpp"
+#include "3D/MeshOptimizer.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <exception>
+#include <chrono>
+
+//Mesh optimization benchmark
+//Imports each model file given without optimizing it, then runs every optimization stage on each mesh and reports the average cache miss ratio (ACMR) before and after along with how long each stage took
+int main(int argc, char* argv[]) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << (argc > 0 ? argv[0] : "cacaomeshbench") << " <model file>...\n";
+		return 1;
+	}
+
+	//Initialize logging (exceptions log themselves)
+	Cacao::Logging::Init();
+
+	//Time a stage in milliseconds
+	auto time = [](auto&& stage) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		stage();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	std::cout << std::fixed << std::setprecision(3);
+	int failures = 0;
+	std::size_t totalTriangles = 0;
+	double totalMissesBefore = 0.0, totalMissesAfter = 0.0;
+	for(int i = 1; i < argc; i++) {
+		std::string path = argv[i];
+		try {
+			Cacao::Model model(path, false);
+			for(const std::string& name : model.ListMeshes()) {
+				std::shared_ptr<Cacao::Mesh> mesh = model.ExtractMesh(name);
+				std::vector<Cacao::Vertex> vertices(mesh->GetVertices().begin(), mesh->GetVertices().end());
+				std::vector<glm::uvec3> indices(mesh->GetIndices().begin(), mesh->GetIndices().end());
+
+				float before = Cacao::ComputeACMR(indices, vertices.size());
+				double cacheTime = time([&]() { Cacao::OptimizeVertexCache(indices, vertices.size()); });
+				float afterCache = Cacao::ComputeACMR(indices, vertices.size());
+				double overdrawTime = time([&]() { Cacao::OptimizeOverdraw(indices, vertices); });
+				float afterOverdraw = Cacao::ComputeACMR(indices, vertices.size());
+				double fetchTime = time([&]() { Cacao::OptimizeVertexFetch(vertices, indices); });
+				float after = Cacao::ComputeACMR(indices, vertices.size());
+
+				std::cout << path << ":" << name << " (" << vertices.size() << " vertices, " << indices.size() << " triangles)\n"
+						  << "\tACMR " << before << " -> " << after << " (vertex cache " << afterCache << ", overdraw " << afterOverdraw << ")\n"
+						  << "\tvertex cache " << cacheTime << " ms, overdraw " << overdrawTime << " ms, vertex fetch " << fetchTime << " ms\n";
+
+				totalTriangles += indices.size();
+				totalMissesBefore += double(before) * indices.size();
+				totalMissesAfter += double(after) * indices.size();
+			}
+		} catch(std::exception& e) {
+			std::cerr << "Failed to benchmark \"" << path << "\": " << e.what() << "\n";
+			failures++;
+		}
+	}
+
+	if(totalTriangles > 0) {
+		std::cout << "Overall ACMR " << (totalMissesBefore / totalTriangles) << " -> " << (totalMissesAfter / totalTriangles) << " over " << totalTriangles << " triangles\n";
+	}
+
+	return (failures > 0 ? 1 : 0);
+}
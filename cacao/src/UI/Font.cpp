@@ -2,14 +2,13 @@
 
 #include "Core/Exception.hpp"
 #include "UI/FreetypeOwner.hpp"
-
-#include <filesystem>
+#include "Utilities/VFS.hpp"
 
 namespace Cacao {
 
 	Font::Font(std::string path)
 	  : Asset(false) {
-		CheckException(std::filesystem::exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load font from nonexistent file!")
+		CheckException(VFS::GetInstance()->Exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load font from nonexistent file!")
 		filePath = path;
 	}
 
@@ -17,7 +16,11 @@ namespace Cacao {
 		CheckException(!compiled, Exception::GetExceptionCodeFromMeaning("BadCompileState"), "Cannot compile compiled font!")
 
 		//Load FreeType font face
-		CheckException(!FT_New_Face(ftLib, filePath.c_str(), 0, &face), Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load font face!")
+		file = VFS::GetInstance()->Open(filePath);
+		if(FT_New_Memory_Face(ftLib, file->GetData(), FT_Long(file->GetSize()), 0, &face)) {
+			file.reset();
+			CheckException(false, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to load font face!")
+		}
 
 		compiled = true;
 
@@ -32,6 +35,7 @@ namespace Cacao {
 
 		//Destroy FreeType font face
 		FT_Done_Face(face);
+		file.reset();
 
 		compiled = false;
 	}
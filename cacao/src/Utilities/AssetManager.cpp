@@ -4,9 +4,14 @@
 #include "Core/Exception.hpp"
 #include "3D/Model.hpp"
 #include "Audio/AudioPlayer.hpp"
+#include "Graphics/Rendering/RenderController.hpp"
+#include "Utilities/VFS.hpp"
 
 #include "yaml-cpp/yaml.h"
 
+#include <functional>
+#include <iterator>
+
 namespace Cacao {
 	//Required static variable initialization
 	AssetManager* AssetManager::instance = nullptr;
@@ -24,23 +29,297 @@ namespace Cacao {
 		return instance;
 	}
 
-	void _AH::_AM_Uncache_AHID(std::string id) {
-		AssetManager::GetInstance()->UncacheAsset(id);
+	AssetManager::CacheShard& AssetManager::GetShard(const std::string& id) {
+		return cache[std::hash<std::string> {}(id) % shardCount];
+	}
+
+	bool AssetManager::BeginLoad(const std::string& id, const std::string& type, LoadCallback onLoaded, bool tally) {
+		CacheShard& shard = GetShard(id);
+		std::shared_ptr<Asset> cached;
+		{
+			std::lock_guard lk(shard.mtx);
+			CacheEntry& entry = shard.entries[{id, type}];
+
+			//Join the load in progress
+			if(entry.loading) {
+				entry.waiters.push_back(onLoaded);
+				if(tally) joins++;
+				return false;
+			}
+
+			//Load it if it isn't cached
+			if(!entry.owned) {
+				entry.loading = true;
+				entry.waiters.push_back(onLoaded);
+				if(tally) misses++;
+				return true;
+			}
+
+			//Hand out the cached asset, bringing it back if it was only being kept around
+			cached = Share({id, type}, entry);
+			if(tally) hits++;
+		}
+
+		//Outside of the lock, as it's the caller's code
+		onLoaded(cached, nullptr);
+		return false;
+	}
+
+	void AssetManager::FinishLoad(const std::string& id, const std::string& type, std::shared_ptr<Asset> asset, std::exception_ptr err) {
+		CacheShard& shard = GetShard(id);
+		std::vector<LoadCallback> waiters;
+		std::shared_ptr<Asset> shared;
+		{
+			std::lock_guard lk(shard.mtx);
+			auto it = shard.entries.find({id, type});
+			if(it == shard.entries.end()) return;
+			waiters = std::move(it->second.waiters);
+
+			//Failed loads aren't cached so that the next request tries again
+			if(err) {
+				shard.entries.erase(it);
+			} else {
+				it->second.owned = asset;
+				it->second.loading = false;
+				it->second.waiters.clear();
+
+				//Count it towards its type's budget
+				it->second.usage = asset->GetMemoryUsage();
+				it->second.counted = false;
+				shared = Share(it->first, it->second);
+			}
+		}
+
+		for(LoadCallback& waiter : waiters) {
+			waiter(shared, err);
+		}
+
+		//Make room for it if that put its type over budget
+		if(!err) Trim(type);
+	}
+
+	std::shared_ptr<Asset> AssetManager::Share(const std::pair<std::string, std::string>& key, CacheEntry& entry) {
+		std::shared_ptr<Asset> shared = entry.asset.lock();
+		if(shared) return shared;
+
+		//Rather than destroying the asset, the pointer we hand out lets us know once nothing holds it anymore
+		//That way assets are released whether the last thing holding them is an asset handle or a plain shared_ptr (e.g. in a material)
+		shared = std::shared_ptr<Asset>(entry.owned.get(), [this, key](Asset*) {
+			Release(key);
+		});
+		entry.asset = shared;
+		if(entry.counted) return shared;
+
+		//Take it back out of the released assets if it is there (it may have just been evicted, in which case Evict leaves it be)
+		std::lock_guard rlk(residencyMtx);
+		auto it = releasedIndex.find(key);
+		if(it != releasedIndex.end()) {
+			TypeResidency& res = residency[key.second];
+			res.released.cpu -= it->second->usage.cpu;
+			res.released.gpu -= it->second->usage.gpu;
+			res.lru.erase(it->second);
+			releasedIndex.erase(it);
+		}
+		CountLive(key.second, entry.usage, true);
+		entry.counted = true;
+		return shared;
+	}
+
+	void AssetManager::Release(const std::pair<std::string, std::string>& key) {
+		CacheShard& shard = GetShard(key.first);
+		{
+			std::lock_guard lk(shard.mtx);
+
+			//A load may have handed it out again since the last pointer to it went away
+			auto it = shard.entries.find(key);
+			if(it == shard.entries.end() || !it->second.counted || !it->second.asset.expired()) return;
+
+			//Recount it, since it may have changed size (e.g. textures streaming in detail) since it was loaded
+			AssetMemoryUsage usage = it->second.owned->GetMemoryUsage();
+			{
+				std::lock_guard rlk(residencyMtx);
+				CountLive(key.second, it->second.usage, false);
+				TypeResidency& res = residency[key.second];
+				res.released.cpu += usage.cpu;
+				res.released.gpu += usage.gpu;
+				res.lru.push_back({.key = key, .usage = usage});
+				releasedIndex[key] = std::prev(res.lru.end());
+			}
+			it->second.usage = usage;
+			it->second.counted = false;
+		}
+
+		//Keep it around until its type is over budget
+		Trim(key.second);
+	}
+
+	void AssetManager::UncacheAsset(std::string assetID) {
+		std::vector<ReleasedAsset> evicted;
+		{
+			std::lock_guard rlk(residencyMtx);
+			for(auto it = releasedIndex.lower_bound({assetID, ""}); it != releasedIndex.end() && it->first.first == assetID;) {
+				TypeResidency& res = residency[it->first.second];
+				res.released.cpu -= it->second->usage.cpu;
+				res.released.gpu -= it->second->usage.gpu;
+				evicted.push_back(std::move(*it->second));
+				res.lru.erase(it->second);
+				it = releasedIndex.erase(it);
+			}
+		}
+		Evict(evicted);
+	}
+
+	void AssetManager::CountLive(const std::string& type, AssetMemoryUsage usage, bool add) {
+		TypeResidency& res = residency[type];
+		if(add) {
+			res.liveCount++;
+			res.live.cpu += usage.cpu;
+			res.live.gpu += usage.gpu;
+		} else {
+			res.liveCount--;
+			res.live.cpu -= usage.cpu;
+			res.live.gpu -= usage.gpu;
+		}
+	}
+
+	std::size_t AssetManager::GetBudgetLocked(const std::string& type) {
+		TypeResidency& res = residency[type];
+		return (res.hasBudget ? res.budget : Engine::GetInstance()->cfg.assetMemoryBudget);
+	}
+
+	void AssetManager::Trim(const std::string& type) {
+		std::vector<ReleasedAsset> evicted;
+		{
+			std::lock_guard rlk(residencyMtx);
+			TypeResidency& res = residency[type];
+			std::size_t budget = GetBudgetLocked(type);
+			while(!res.lru.empty() && (res.live.cpu + res.live.gpu + res.released.cpu + res.released.gpu) > budget) {
+				ReleasedAsset& oldest = res.lru.front();
+				res.released.cpu -= oldest.usage.cpu;
+				res.released.gpu -= oldest.usage.gpu;
+				releasedIndex.erase(oldest.key);
+				evicted.push_back(std::move(oldest));
+				res.lru.pop_front();
+			}
+		}
+		Evict(evicted);
+	}
+
+	void AssetManager::Evict(std::vector<ReleasedAsset>& evicted) {
+		std::vector<std::shared_ptr<Asset>> doomed;
+		for(ReleasedAsset& victim : evicted) {
+			CacheShard& shard = GetShard(victim.key.first);
+			std::lock_guard lk(shard.mtx);
+			auto it = shard.entries.find(victim.key);
+			if(it == shard.entries.end() || it->second.loading) continue;
+
+			//A load may have picked it up between it leaving the released assets and now, in which case it's live again
+			if(it->second.counted) continue;
+			doomed.push_back(std::move(it->second.owned));
+			shard.entries.erase(it);
+		}
+
+		//The assets themselves are destroyed here, once no locks are held
+	}
+
+	void AssetManager::SetMemoryBudget(const std::string& type, std::size_t bytes) {
+		{
+			std::lock_guard rlk(residencyMtx);
+			TypeResidency& res = residency[type];
+			res.budget = bytes;
+			res.hasBudget = true;
+		}
+		Trim(type);
+	}
+
+	std::size_t AssetManager::GetMemoryBudget(const std::string& type) {
+		std::lock_guard rlk(residencyMtx);
+		return GetBudgetLocked(type);
+	}
+
+	std::map<std::string, AssetResidency> AssetManager::GetResidency() {
+		std::lock_guard rlk(residencyMtx);
+		std::map<std::string, AssetResidency> out;
+		for(auto& [type, res] : residency) {
+			out[type] = AssetResidency {.liveCount = res.liveCount, .live = res.live, .releasedCount = res.lru.size(), .released = res.released, .budget = GetBudgetLocked(type)};
+		}
+		return out;
+	}
+
+	void AssetManager::ClearReleased() {
+		std::vector<ReleasedAsset> evicted;
+		{
+			std::lock_guard rlk(residencyMtx);
+			for(auto& [type, res] : residency) {
+				for(ReleasedAsset& asset : res.lru) {
+					evicted.push_back(std::move(asset));
+				}
+				res.lru.clear();
+				res.released = {0, 0};
+			}
+			releasedIndex.clear();
+		}
+		Evict(evicted);
+	}
+
+	//Loads run in stages: reading and decoding on a pool worker, then uploading on the render thread
+	//Each stage hands off to the next instead of waiting on it, so workers never sit blocked while the render thread catches up
+	//Whichever stage finishes the load calls FinishLoad, which hands the asset (or the exception that stopped it) to everyone waiting on it
+	template<typename T>
+	std::future<AssetHandle<T>> AssetManager::StartLoad(const std::string& id, const std::string& type, std::function<void()> load) {
+		std::shared_ptr<std::promise<AssetHandle<T>>> result = std::make_shared<std::promise<AssetHandle<T>>>();
+		std::future<AssetHandle<T>> future = result->get_future();
+		bool first = BeginLoad(id, type, [result, id](std::shared_ptr<Asset> asset, std::exception_ptr err) {
+			if(err) {
+				result->set_exception(err);
+			} else {
+				result->set_value(AssetHandle<T>(id, std::static_pointer_cast<T>(asset)));
+			}
+		});
+		if(!first) return future;
+
+		Engine::GetInstance()->GetThreadPool()->enqueue([this, id, type, load]() {
+			try {
+				load();
+			} catch(...) {
+				FinishLoad(id, type, nullptr, std::current_exception());
+			}
+		});
+		return future;
+	}
+
+	void AssetManager::UploadThen(const std::string& id, const std::string& type, std::shared_ptr<Asset> asset) {
+		//Compiling from here queues the work for the render thread instead of doing it there
+		//Some assets keep compiling over later frames (e.g. textures streaming in), so the load finishes once the returned future is ready
+		std::shared_future<void> compiling;
+		try {
+			compiling = asset->Compile();
+		} catch(...) {
+			FinishLoad(id, type, nullptr, std::current_exception());
+			return;
+		}
+		RenderController::GetInstance()->RunWhenReady(compiling, [this, id, type, asset, compiling]() {
+			try {
+				if(compiling.valid()) compiling.get();
+			} catch(...) {
+				FinishLoad(id, type, nullptr, std::current_exception());
+				return;
+			}
+			FinishLoad(id, type, asset, nullptr);
+		});
 	}
 
 	std::future<AssetHandle<Shader>> AssetManager::LoadShader(std::string definitionPath) {
-		return Engine::GetInstance()->GetThreadPool()->enqueue([this, definitionPath]() {
-			CheckException(std::filesystem::exists(definitionPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load shader from nonexistent definition file!")
-			//First check if asset is already cached and return the cached one if so
-			if(this->assetCache.contains(definitionPath) && this->assetCache[definitionPath].lock()->GetType().compare("SHADER") == 0) return AssetHandle<Shader>(definitionPath, std::dynamic_pointer_cast<Shader>(this->assetCache[definitionPath].lock()));
+		return StartLoad<Shader>(definitionPath, "SHADER", [this, definitionPath]() {
+			CheckException(VFS::GetInstance()->Exists(definitionPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load shader from nonexistent definition file!")
 
 			//Load and validate definition file
-			YAML::Node dfNode = YAML::LoadFile(definitionPath);
+			YAML::Node dfNode = YAML::Load(VFS::GetInstance()->ReadText(definitionPath));
 			CheckException(dfNode.IsMap(), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: File is not a map!")
 			CheckException(dfNode["vertex"].IsScalar(), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: File does not contain required 'vertex' attribute or it is not a scalar!")
 			CheckException(dfNode["fragment"].IsScalar(), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: File does not contain required 'fragment' attribute or it is not a scalar!")
-			CheckException(std::filesystem::exists(dfNode["vertex"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: 'vertex' attribute references nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["fragment"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: 'fragment' attribute references nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["vertex"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: 'vertex' attribute references nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["fragment"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: 'fragment' attribute references nonexistent file!")
 			CheckException(!dfNode["spec"] || (dfNode["spec"] && dfNode["spec"].IsSequence()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing shader definition: 'spec' attribute is not a sequence!")
 
 			//Validate and try to build spec
@@ -96,12 +375,12 @@ namespace Cacao {
 					case 4://uint64
 						inf.type = SpvType::UInt64;
 						break;
-					case 5://float
-						inf.type = SpvType::Float;
-						break;
-					case 6://double
+					case 5://double
 						inf.type = SpvType::Double;
 						break;
+					case 6://float
+						inf.type = SpvType::Float;
+						break;
 					case 7://image
 						inf.type = SpvType::SampledImage;
 						break;
@@ -114,40 +393,32 @@ namespace Cacao {
 				spec.push_back(inf);
 			}
 
-			//Construct shader
+			//Construct shader (translating it happens here, on the worker)
 			std::shared_ptr<Shader> asset = std::make_shared<Shader>(dfNode["vertex"].Scalar(), dfNode["fragment"].Scalar(), spec);
-			asset->Compile().get();
 
-			//Add asset to cache
-			this->assetCache.insert_or_assign(definitionPath, std::weak_ptr<Shader> {asset});
-
-			//Construct and return asset handle
-			return AssetHandle<Shader>(definitionPath, asset);
+			//Compile it on the render thread, which finishes the load
+			UploadThen(definitionPath, "SHADER", asset);
 		});
 	}
 
 	std::future<AssetHandle<Texture2D>> AssetManager::LoadTexture2D(std::string path) {
-		return Engine::GetInstance()->GetThreadPool()->enqueue([this, path]() {
-			CheckException(std::filesystem::exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load 2D texture from nonexistent file!")
-			//First check if asset is already cached and return the cached one if so
-			if(this->assetCache.contains(path) && this->assetCache[path].lock()->GetType().compare("2DTEX") == 0) return AssetHandle<Texture2D>(path, std::dynamic_pointer_cast<Texture2D>(this->assetCache[path].lock()));
+		return StartLoad<Texture2D>(path, "2DTEX", [this, path]() {
+			CheckException(VFS::GetInstance()->Exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load 2D texture from nonexistent file!")
 
-			//Construct an asset, add it to cache, and return a handle
+			//Construct an asset (decoding the image here, on the worker)
 			std::shared_ptr<Texture2D> tex = std::make_shared<Texture2D>(path);
-			tex->Compile().get();
-			this->assetCache.insert_or_assign(path, std::weak_ptr<Texture2D> {tex});
-			return AssetHandle<Texture2D>(path, tex);
+
+			//Upload it on the render thread, which finishes the load
+			UploadThen(path, "2DTEX", tex);
 		});
 	}
 
 	std::future<AssetHandle<Cubemap>> AssetManager::LoadCubemap(std::string definitionPath) {
-		return Engine::GetInstance()->GetThreadPool()->enqueue([this, definitionPath]() {
-			CheckException(std::filesystem::exists(definitionPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load cubemap from nonexistent definition file!")
-			//First check if asset is already cached and return the cached one if so
-			if(this->assetCache.contains(definitionPath) && this->assetCache[definitionPath].lock()->GetType().compare("CUBEMAP") == 0) return AssetHandle<Cubemap>(definitionPath, std::dynamic_pointer_cast<Cubemap>(this->assetCache[definitionPath].lock()));
+		return StartLoad<Cubemap>(definitionPath, "CUBEMAP", [this, definitionPath]() {
+			CheckException(VFS::GetInstance()->Exists(definitionPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load cubemap from nonexistent definition file!")
 
 			//Load and validate definition file
-			YAML::Node dfNode = YAML::LoadFile(definitionPath);
+			YAML::Node dfNode = YAML::Load(VFS::GetInstance()->ReadText(definitionPath));
 			CheckException(dfNode.IsMap(), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: File is not a map!")
 			CheckException((dfNode["x+"] && dfNode["x+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'x+' field is nonexistent or not a scalar!")
 			CheckException((dfNode["x-"] && dfNode["x+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'x-' field is nonexistent or not a scalar!")
@@ -155,31 +426,28 @@ namespace Cacao {
 			CheckException((dfNode["y-"] && dfNode["y+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'y-' field is nonexistent or not a scalar!")
 			CheckException((dfNode["z+"] && dfNode["z+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'z+' field is nonexistent or not a scalar!")
 			CheckException((dfNode["z-"] && dfNode["z+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'z-' field is nonexistent or not a scalar!")
-			CheckException(std::filesystem::exists(dfNode["x+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'x+' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["x-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'x-' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["y+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'y+' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["y-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'y-' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["z+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'z+' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["z-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'z-' field refers to a nonexistent file!")
-
-			//Create and compile cubemap
-			std::shared_ptr<Cubemap> asset = std::make_shared<Cubemap>(std::vector<std::string> {dfNode["x+"].Scalar(), dfNode["x-"].Scalar(), dfNode["y+"].Scalar(), dfNode["y-"].Scalar(), dfNode["z+"].Scalar(), dfNode["z-"].Scalar()});
-			asset->Compile().get();
-
-			//Add asset to cache and return handle
-			this->assetCache.insert_or_assign(definitionPath, std::weak_ptr<Cubemap> {asset});
-			return AssetHandle<Cubemap>(definitionPath, asset);
+			CheckException(VFS::GetInstance()->Exists(dfNode["x+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'x+' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["x-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'x-' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["y+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'y+' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["y-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'y-' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["z+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'z+' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["z-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'z-' field refers to a nonexistent file!")
+			CheckException(!dfNode["mipmaps"] || dfNode["mipmaps"].IsScalar(), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing cubemap definition: 'mipmaps' field is not a scalar!")
+
+			//Create cubemap (decoding the faces here, on the worker and its helpers)
+			std::shared_ptr<Cubemap> asset = std::make_shared<Cubemap>(std::vector<std::string> {dfNode["x+"].Scalar(), dfNode["x-"].Scalar(), dfNode["y+"].Scalar(), dfNode["y-"].Scalar(), dfNode["z+"].Scalar(), dfNode["z-"].Scalar()}, dfNode["mipmaps"] && dfNode["mipmaps"].as<bool>());
+
+			//Compile it on the render thread, which finishes the load
+			UploadThen(definitionPath, "CUBEMAP", asset);
 		});
 	}
 
 	std::future<AssetHandle<Skybox>> AssetManager::LoadSkybox(std::string definitionPath) {
-		return Engine::GetInstance()->GetThreadPool()->enqueue([this, definitionPath]() {
-			CheckException(std::filesystem::exists(definitionPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load skybox from nonexistent definition file!")
-			//First check if asset is already cached and return the cached one if so
-			if(this->assetCache.contains(definitionPath) && this->assetCache[definitionPath].lock()->GetType().compare("SKYBOX") == 0) return AssetHandle<Skybox>(definitionPath, std::dynamic_pointer_cast<Skybox>(this->assetCache[definitionPath].lock()));
+		return StartLoad<Skybox>(definitionPath, "SKYBOX", [this, definitionPath]() {
+			CheckException(VFS::GetInstance()->Exists(definitionPath), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load skybox from nonexistent definition file!")
 
 			//Load and validate definition file
-			YAML::Node dfNode = YAML::LoadFile(definitionPath);
+			YAML::Node dfNode = YAML::Load(VFS::GetInstance()->ReadText(definitionPath));
 			CheckException(dfNode.IsMap(), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: File is not a map!")
 			CheckException((dfNode["x+"] && dfNode["x+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'x+' field is nonexistent or not a scalar!")
 			CheckException((dfNode["x-"] && dfNode["x+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'x-' field is nonexistent or not a scalar!")
@@ -187,85 +455,193 @@ namespace Cacao {
 			CheckException((dfNode["y-"] && dfNode["y+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'y-' field is nonexistent or not a scalar!")
 			CheckException((dfNode["z+"] && dfNode["z+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'z+' field is nonexistent or not a scalar!")
 			CheckException((dfNode["z-"] && dfNode["z+"].IsScalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'z-' field is nonexistent or not a scalar!")
-			CheckException(std::filesystem::exists(dfNode["x+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'x+' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["x-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'x-' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["y+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'y+' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["y-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'y-' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["z+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'z+' field refers to a nonexistent file!")
-			CheckException(std::filesystem::exists(dfNode["z-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'z-' field refers to a nonexistent file!")
-
-			//Create and compile skybox texture
+			CheckException(VFS::GetInstance()->Exists(dfNode["x+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'x+' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["x-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'x-' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["y+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'y+' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["y-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'y-' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["z+"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'z+' field refers to a nonexistent file!")
+			CheckException(VFS::GetInstance()->Exists(dfNode["z-"].Scalar()), Exception::GetExceptionCodeFromMeaning("InvalidYAML"), "While parsing skybox definition: 'z-' field refers to a nonexistent file!")
+
+			//Create skybox asset and its texture (decoding the faces here, on the worker and its helpers)
 			Cubemap* cube = new Cubemap(std::vector<std::string> {dfNode["x+"].Scalar(), dfNode["x-"].Scalar(), dfNode["y+"].Scalar(), dfNode["y-"].Scalar(), dfNode["z+"].Scalar(), dfNode["z-"].Scalar()});
-			;
-			cube->Compile();
-
-			//Create skybox asset
 			std::shared_ptr<Skybox> asset = std::make_shared<Skybox>(cube);
 
-			//Add asset to cache and return handle
-			this->assetCache.insert_or_assign(definitionPath, std::weak_ptr<Skybox> {asset});
-			return AssetHandle<Skybox>(definitionPath, asset);
+			//Compile the texture on the render thread, which finishes the load
+			UploadThen(definitionPath, "SKYBOX", asset);
 		});
 	}
 
-	std::future<AssetHandle<Mesh>> AssetManager::LoadMesh(std::string location) {
-		return Engine::GetInstance()->GetThreadPool()->enqueue([this, location]() {
-			//First check if asset is already cached and return the cached one if so
-			if(this->assetCache.contains(location) && this->assetCache[location].lock()->GetType().compare("MESH") == 0) return AssetHandle<Mesh>(location, std::dynamic_pointer_cast<Mesh>(this->assetCache[location].lock()));
+	AssetManager::CachedModel::CachedModel(const std::string& path)
+	  : Asset(true), path(path) {
+		Import();
+		for(auto& [name, mesh] : meshes) {
+			names.push_back(name);
+		}
+	}
 
+	void AssetManager::CachedModel::Import() {
+		//Map the cooked model file if it's up to date, and fall back to importing the source with Assimp
+		std::shared_ptr<Model> model;
+		if(Model::HasFreshCook(path)) {
+			try {
+				model = Model::LoadCooked(path);
+			} catch(...) {
+				Logging::EngineLog("Cooked model file for \"" + path + "\" is unusable, importing the source file instead", LogLevel::Warn);
+			}
+		}
+		if(!model) model = std::make_shared<Model>(path);
+
+		for(const std::string& name : model->ListMeshes()) {
+			meshes.insert_or_assign(name, model->ExtractMesh(name));
+		}
+	}
+
+	std::shared_ptr<Mesh> AssetManager::CachedModel::TakeMesh(const std::string& name) {
+		std::lock_guard lk(mtx);
+		if(!meshes.contains(name)) Import();
+		std::shared_ptr<Mesh> mesh = std::move(meshes.at(name));
+		meshes.erase(name);
+		return mesh;
+	}
+
+	AssetMemoryUsage AssetManager::CachedModel::GetMemoryUsage() {
+		std::lock_guard lk(mtx);
+		AssetMemoryUsage usage {0, 0};
+		for(auto& [name, mesh] : meshes) {
+			AssetMemoryUsage meshUsage = mesh->GetMemoryUsage();
+			usage.cpu += meshUsage.cpu;
+			usage.gpu += meshUsage.gpu;
+		}
+		return usage;
+	}
+
+	void AssetManager::ImportModel(const std::string& path, ImportCallback onImported) {
+		//Imports are cached like assets (but not counted as loads), so once nobody holds this one anymore it's kept until models are over budget
+		bool first = BeginLoad(path, "MODEL", [onImported](std::shared_ptr<Asset> asset, std::exception_ptr err) {
+			onImported(std::static_pointer_cast<CachedModel>(asset), err);
+		}, false);
+		if(!first) return;
+
+		std::shared_ptr<CachedModel> model;
+		try {
+			model = std::make_shared<CachedModel>(path);
+		} catch(...) {
+			FinishLoad(path, "MODEL", nullptr, std::current_exception());
+			return;
+		}
+		FinishLoad(path, "MODEL", model, nullptr);
+	}
+
+	std::future<AssetHandle<Mesh>> AssetManager::LoadMesh(std::string location) {
+		return StartLoad<Mesh>(location, "MESH", [this, location]() {
 			//Split location parameter
 			std::size_t pos = location.find(':');
 			std::string model = location.substr(0, pos);
 			std::string mesh = location.substr(pos + 1, location.size());
 
 			//Confirm existence of model file
-			CheckException(std::filesystem::exists(model), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load mesh from nonexistent model file!")
+			CheckException(VFS::GetInstance()->Exists(model), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load mesh from nonexistent model file!")
 
-			//Load model
-			Model mod {model};
+			//Import the model (or reuse an import of it) and compile our mesh from it on the render thread
+			ImportModel(model, [this, location, mesh](std::shared_ptr<CachedModel> mod, std::exception_ptr err) {
+				try {
+					if(err) std::rethrow_exception(err);
 
-			//Check that mesh is in model
-			std::vector<std::string> meshList = mod.ListMeshes();
-			CheckException(std::find(meshList.cbegin(), meshList.cend(), mesh) != meshList.cend(), Exception::GetExceptionCodeFromMeaning("ContainerValue"), "While loading mesh from model: Mesh does not exist in loaded model!")
+					//Check that mesh is in model
+					CheckException(mod->HasMesh(mesh), Exception::GetExceptionCodeFromMeaning("ContainerValue"), "While loading mesh from model: Mesh does not exist in loaded model!")
 
-			//Extract mesh, compile it, and add it to asset cache
-			std::shared_ptr<Mesh> asset;
-			asset.reset(mod.ExtractMesh(mesh));
-			asset->Compile().get();
-			this->assetCache.insert_or_assign(location, std::weak_ptr<Mesh> {asset});
+					std::shared_ptr<Mesh> asset = mod->TakeMesh(mesh);
+					if(vertexFormat != VertexFormat::Full) asset->SetVertexFormat(vertexFormat);
+					UploadThen(location, "MESH", asset);
+				} catch(...) {
+					FinishLoad(location, "MESH", nullptr, std::current_exception());
+				}
+			});
+		});
+	}
+
+	std::future<std::map<std::string, AssetHandle<Mesh>>> AssetManager::LoadModel(std::string path) {
+		using MeshMap = std::map<std::string, AssetHandle<Mesh>>;
+		std::shared_ptr<std::promise<MeshMap>> result = std::make_shared<std::promise<MeshMap>>();
+		std::future<MeshMap> future = result->get_future();
+
+		Engine::GetInstance()->GetThreadPool()->enqueue([this, path, result]() {
+			try {
+				CheckException(VFS::GetInstance()->Exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load model from nonexistent file!")
+			} catch(...) {
+				result->set_exception(std::current_exception());
+				return;
+			}
 
-			//Return asset handle
-			return AssetHandle<Mesh>(location, asset);
+			ImportModel(path, [this, path, result](std::shared_ptr<CachedModel> model, std::exception_ptr err) {
+				if(err) {
+					result->set_exception(err);
+					return;
+				}
+
+				//Handles for the meshes as their loads finish
+				struct Gather {
+					std::mutex mtx;
+					MeshMap handles;
+					std::size_t remaining;
+					std::exception_ptr err;
+				};
+				std::vector<std::string> names = model->ListMeshes();
+				std::shared_ptr<Gather> gather = std::make_shared<Gather>();
+				gather->remaining = names.size();
+
+				//Load each mesh through the cache so that ones already loaded (or loading) are reused
+				for(const std::string& name : names) {
+					std::string id = path + ":" + name;
+					bool first = BeginLoad(id, "MESH", [gather, result, id, name](std::shared_ptr<Asset> asset, std::exception_ptr err) {
+						std::lock_guard lk(gather->mtx);
+						if(err) {
+							if(!gather->err) gather->err = err;
+						} else {
+							gather->handles.insert_or_assign(name, AssetHandle<Mesh>(id, std::static_pointer_cast<Mesh>(asset)));
+						}
+
+						//Resolve once every mesh is done
+						if(--gather->remaining > 0) return;
+						if(gather->err) {
+							result->set_exception(gather->err);
+						} else {
+							result->set_value(std::move(gather->handles));
+						}
+					});
+					if(!first) continue;
+					try {
+						std::shared_ptr<Mesh> mesh = model->TakeMesh(name);
+						if(vertexFormat != VertexFormat::Full) mesh->SetVertexFormat(vertexFormat);
+						UploadThen(id, "MESH", mesh);
+					} catch(...) {
+						FinishLoad(id, "MESH", nullptr, std::current_exception());
+					}
+				}
+			});
 		});
+		return future;
 	}
 
 	std::future<AssetHandle<Sound>> AssetManager::LoadSound(std::string path) {
-		return Engine::GetInstance()->GetThreadPool()->enqueue([this, path]() {
-			CheckException(std::filesystem::exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load sound from nonexistent file!")
-			//First check if asset is already cached and return the cached one if so
-			if(this->assetCache.contains(path) && this->assetCache[path].lock()->GetType().compare("SOUND") == 0) return AssetHandle<Sound>(path, std::dynamic_pointer_cast<Sound>(this->assetCache[path].lock()));
+		return StartLoad<Sound>(path, "SOUND", [this, path]() {
+			CheckException(VFS::GetInstance()->Exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load sound from nonexistent file!")
 
-			//Construct an asset, add it to cache, and return a handle
+			//Construct and compile an asset (nothing here needs the render thread), which finishes the load
 			std::shared_ptr<Sound> snd = std::make_shared<Sound>(path);
-			snd->Compile().get();
-			this->assetCache.insert_or_assign(path, std::weak_ptr<Sound> {snd});
-
-			return AssetHandle<Sound>(path, snd);
+			snd->Compile();
+			FinishLoad(path, "SOUND", snd, nullptr);
 		});
 	}
 
 	std::future<AssetHandle<Font>> AssetManager::LoadFont(std::string path) {
-		return Engine::GetInstance()->GetThreadPool()->enqueue([this, path]() {
-			CheckException(std::filesystem::exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load font from nonexistent file!")
-			//First check if asset is already cached and return the cached one if so
-			if(this->assetCache.contains(path) && this->assetCache[path].lock()->GetType().compare("FONT") == 0) return AssetHandle<Font>(path, std::dynamic_pointer_cast<Font>(this->assetCache[path].lock()));
+		return StartLoad<Font>(path, "FONT", [this, path]() {
+			CheckException(VFS::GetInstance()->Exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot load font from nonexistent file!")
 
-			//Construct an asset, add it to cache, and return a handle
+			//Construct and compile an asset (nothing here needs the render thread), which finishes the load
 			std::shared_ptr<Font> font = std::make_shared<Font>(path);
-			font->Compile().get();
-			this->assetCache.insert_or_assign(path, std::weak_ptr<Font> {font});
-
-			return AssetHandle<Font>(path, font);
+			font->Compile();
+			FinishLoad(path, "FONT", font, nullptr);
 		});
 	}
 }
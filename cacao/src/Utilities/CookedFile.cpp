@@ -0,0 +1,46 @@
+#include "Utilities/CookedFile.hpp"
+
+#include "Core/Exception.hpp"
+#include "Utilities/VFS.hpp"
+
+#include <filesystem>
+
+namespace Cacao {
+	bool IsCookFresh(const std::string& cookedPath, const std::string& sourcePath) {
+		if(VFS::GetInstance()->IsArchived(cookedPath)) return true;
+		std::error_code ec;
+		std::filesystem::file_time_type cooked = std::filesystem::last_write_time(cookedPath, ec);
+		if(ec) return false;
+		std::filesystem::file_time_type source = std::filesystem::last_write_time(sourcePath, ec);
+		return !ec && cooked > source;
+	}
+
+	CookedFileWriter::CookedFileWriter(const std::string& path, const std::string& kind)
+	  : path(path), tempPath(path + ".tmp"), kind(kind), finished(false) {
+		out.open(tempPath, std::ios::binary | std::ios::trunc);
+		CheckException(out.is_open(), Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open \"" + tempPath + "\" to write " + kind + "!")
+	}
+
+	CookedFileWriter::~CookedFileWriter() {
+		if(finished) return;
+		out.close();
+		std::error_code ec;
+		std::filesystem::remove(tempPath, ec);
+	}
+
+	void CookedFileWriter::Write(const void* data, std::size_t size) {
+		out.write(reinterpret_cast<const char*>(data), size);
+	}
+
+	void CookedFileWriter::PadTo(std::size_t offset) {
+		static const char zeros[cookedAlignment] = {};
+		out.write(zeros, offset - std::size_t(out.tellp()));
+	}
+
+	void CookedFileWriter::Finish() {
+		out.close();
+		CheckException(out.good(), Exception::GetExceptionCodeFromMeaning("IO"), "Failed to write " + kind + " \"" + tempPath + "\"!")
+		std::filesystem::rename(tempPath, path);
+		finished = true;
+	}
+}
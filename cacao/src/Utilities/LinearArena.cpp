@@ -0,0 +1,31 @@
+#include "Utilities/LinearArena.hpp"
+
+namespace Cacao {
+	void* LinearArena::AllocateBytes(std::size_t size, std::size_t align) {
+		//Blocks come from new[], which is aligned for anything up to max_align_t, so aligning the offset is enough
+		std::size_t start = (offset + align - 1) & ~(align - 1);
+		if(start + size <= capacity) {
+			offset = start + size;
+			return block.get() + start;
+		}
+
+		//Doesn't fit, give this allocation its own block and remember to grow
+		overflow.emplace_back(new std::byte[size]);
+		overflowSize += size + align;
+		allocations++;
+		return overflow.back().get();
+	}
+
+	void LinearArena::Reset() {
+		offset = 0;
+		if(overflow.empty()) return;
+
+		//Grow with some headroom so that slowly increasing usage doesn't regrow every time
+		capacity = (capacity + overflowSize) * 3 / 2;
+		block.reset(new std::byte[capacity]);
+		allocations++;
+
+		overflow.clear();
+		overflowSize = 0;
+	}
+}
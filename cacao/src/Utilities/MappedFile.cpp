@@ -0,0 +1,66 @@
+#include "Utilities/MappedFile.hpp"
+#include "Core/Exception.hpp"
+
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Cacao {
+	MappedFile::MappedFile(const std::string& path)
+	  : data(nullptr), size(0), mapping(nullptr), owned(true) {
+		CheckException(std::filesystem::exists(path), Exception::GetExceptionCodeFromMeaning("FileNotFound"), "Cannot map nonexistent file \"" + path + "\"!")
+		size = std::filesystem::file_size(path);
+
+		//Empty files can't be mapped, but there's nothing to map anyway
+		if(size == 0) return;
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		CheckException(file != INVALID_HANDLE_VALUE, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open file \"" + path + "\" for mapping!")
+
+		//The mapping keeps the file open, so we can close our handle to it right away
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		CheckException(mapping != nullptr, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to map file \"" + path + "\"!")
+
+		data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if(data == nullptr) CloseHandle(mapping);
+		CheckException(data != nullptr, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to map view of file \"" + path + "\"!")
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		CheckException(fd != -1, Exception::GetExceptionCodeFromMeaning("FileOpenFailure"), "Failed to open file \"" + path + "\" for mapping!")
+
+		//The mapping keeps the file open, so we can close our descriptor right away
+		void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		CheckException(view != MAP_FAILED, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to map file \"" + path + "\"!")
+		data = static_cast<const unsigned char*>(view);
+#endif
+	}
+
+	MappedFile::MappedFile(std::shared_ptr<const MappedFile> parent, std::size_t offset, std::size_t size)
+	  : data(parent->GetData() + offset), size(size), mapping(nullptr), parent(parent), owned(false) {}
+
+	MappedFile::MappedFile(std::vector<unsigned char>&& contents)
+	  : data(nullptr), size(contents.size()), mapping(nullptr), contents(std::move(contents)), owned(false) {
+		data = (size > 0 ? this->contents.data() : nullptr);
+	}
+
+	MappedFile::~MappedFile() {
+		if(data == nullptr || !owned) return;
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+#else
+		munmap(const_cast<unsigned char*>(data), size);
+#endif
+	}
+}
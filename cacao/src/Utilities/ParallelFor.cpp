@@ -0,0 +1,78 @@
+#include "Utilities/ParallelFor.hpp"
+
+#include "Core/Engine.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+
+namespace Cacao {
+	void ParallelFor(std::size_t count, std::function<void(std::size_t, std::size_t)> body, std::size_t grain) {
+		if(count == 0) return;
+		std::shared_ptr<thread_pool> pool = Engine::GetInstance()->GetThreadPool();
+		std::size_t workers = (pool ? pool->size() : 0);
+
+		//Aim for a few chunks per thread so uneven work still balances out
+		if(grain == 0) grain = std::max<std::size_t>(1, count / ((workers + 1) * 4));
+		std::size_t numChunks = (count + grain - 1) / grain;
+
+		//Not worth involving other threads
+		if(numChunks == 1 || workers == 0) {
+			body(0, count);
+			return;
+		}
+
+		//Shared so that pool threads which start late don't outlive it
+		struct State {
+			std::function<void(std::size_t, std::size_t)> body;
+			std::size_t count, grain, numChunks;
+			std::atomic<std::size_t> nextChunk, doneChunks;
+			std::exception_ptr error;
+			std::mutex errorMtx;
+		};
+		std::shared_ptr<State> state = std::make_shared<State>();
+		state->body = body;
+		state->count = count;
+		state->grain = grain;
+		state->numChunks = numChunks;
+		state->nextChunk.store(0);
+		state->doneChunks.store(0);
+
+		auto work = [state]() {
+			while(true) {
+				//Claim the next chunk
+				std::size_t chunk = state->nextChunk.fetch_add(1);
+				if(chunk >= state->numChunks) return;
+
+				std::size_t start = chunk * state->grain;
+				std::size_t end = std::min(start + state->grain, state->count);
+				try {
+					state->body(start, end);
+				} catch(...) {
+					std::lock_guard lk(state->errorMtx);
+					if(!state->error) state->error = std::current_exception();
+				}
+
+				//Wake the caller when the last chunk is done
+				if(state->doneChunks.fetch_add(1) + 1 == state->numChunks) state->doneChunks.notify_all();
+			}
+		};
+
+		//Start helpers and work alongside them
+		std::size_t helpers = std::min(workers, numChunks - 1);
+		for(std::size_t i = 0; i < helpers; i++) {
+			pool->enqueue_detach(work);
+		}
+		work();
+
+		//Wait for chunks still being finished by other threads
+		std::size_t done = state->doneChunks.load();
+		while(done != numChunks) {
+			state->doneChunks.wait(done);
+			done = state->doneChunks.load();
+		}
+
+		if(state->error) std::rethrow_exception(state->error);
+	}
+}
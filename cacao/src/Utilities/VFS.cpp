@@ -0,0 +1,183 @@
+#include "Utilities/VFS.hpp"
+#include "Core/Exception.hpp"
+#include "Core/Log.hpp"
+
+#include "zlib.h"
+
+#include <filesystem>
+#include <algorithm>
+#include <string_view>
+#include <mutex>
+#include <climits>
+#include <cstring>
+#include <cstdint>
+
+namespace Cacao {
+	//Asset archive layout (written by scripts/pack.py, little-endian)
+	//A header, then the index (one entry per file, sorted by path hash), then the paths, then each file's data (each aligned to the header's alignment)
+	//Paths are stored normalized (see NormalizePath) and hashed with 64-bit FNV-1a
+	struct ArchiveHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t alignment;
+		uint64_t indexOffset;
+		uint64_t pathsOffset;
+	};
+	struct ArchiveEntry {
+		uint64_t pathHash;
+		uint32_t pathOffset, pathLength;//Relative to the start of the paths
+		uint64_t dataOffset;
+		uint64_t storedSize;//Size in the archive
+		uint64_t size;		//Size once inflated (the same as the stored size if it isn't compressed)
+		uint32_t compression;
+		uint32_t reserved;
+	};
+	static_assert(sizeof(ArchiveHeader) == 32 && sizeof(ArchiveEntry) == 48, "Asset archive structures must not be padded!");
+	constexpr char archiveMagic[4] = {'C', 'P', 'A', 'K'};
+	constexpr uint32_t archiveVersion = 1;
+	enum ArchiveCompression : uint32_t {
+		Stored = 0,
+		Zlib = 1
+	};
+
+	struct VFS::Archive {
+		std::string path;
+		std::shared_ptr<const MappedFile> file;
+		const ArchiveEntry* entries;
+		uint32_t entryCount;
+		const char* paths;
+
+		//Find a file's entry, or nullptr if the archive doesn't have it
+		const ArchiveEntry* Find(const std::string& normalized) const {
+			uint64_t hash = HashPath(normalized);
+			const ArchiveEntry* end = entries + entryCount;
+			const ArchiveEntry* it = std::lower_bound(entries, end, hash, [](const ArchiveEntry& entry, uint64_t hash) {
+				return entry.pathHash < hash;
+			});
+			for(; it != end && it->pathHash == hash; it++) {
+				if(std::string_view(paths + it->pathOffset, it->pathLength) == normalized) return it;
+			}
+			return nullptr;
+		}
+
+		static uint64_t HashPath(const std::string& normalized) {
+			uint64_t hash = 0xcbf29ce484222325ull;
+			for(char c : normalized) {
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}
+	};
+
+	//Required static variable initialization
+	VFS* VFS::instance = nullptr;
+	bool VFS::instanceExists = false;
+
+	//Singleton accessor
+	VFS* VFS::GetInstance() {
+		//Do we have an instance yet?
+		if(!instanceExists || instance == nullptr) {
+			//Create instance
+			instance = new VFS();
+			instanceExists = true;
+		}
+
+		return instance;
+	}
+
+	//Put a path in the form archives store it in: relative, with forward slashes and no "." or ".." parts
+	//Returns an empty string for paths that can't be archived (absolute ones and ones leaving the working directory)
+	static std::string NormalizePath(const std::string& path) {
+		std::filesystem::path p = std::filesystem::path(path).lexically_normal();
+		if(p.is_absolute() || p.has_root_name()) return "";
+		std::string normalized = p.generic_string();
+		if(normalized.starts_with("..")) return "";
+		return normalized;
+	}
+
+	void VFS::Mount(const std::string& archivePath) {
+		std::shared_ptr<Archive> archive = std::make_shared<Archive>();
+		archive->path = archivePath;
+		archive->file = std::make_shared<MappedFile>(archivePath);
+		const unsigned char* data = archive->file->GetData();
+		std::size_t size = archive->file->GetSize();
+
+		//Validate header
+		ArchiveHeader header;
+		CheckException(size >= sizeof(ArchiveHeader), Exception::GetExceptionCodeFromMeaning("IO"), "Asset archive \"" + archivePath + "\" is truncated!")
+		std::memcpy(&header, data, sizeof(ArchiveHeader));
+		CheckException(std::memcmp(header.magic, archiveMagic, sizeof(archiveMagic)) == 0, Exception::GetExceptionCodeFromMeaning("IO"), "File \"" + archivePath + "\" is not an asset archive!")
+		CheckException(header.version == archiveVersion, Exception::GetExceptionCodeFromMeaning("IO"), "Asset archive \"" + archivePath + "\" was packed for a different engine version and must be packed again!")
+		CheckException(header.indexOffset <= size && header.entryCount <= (size - header.indexOffset) / sizeof(ArchiveEntry) && header.indexOffset % alignof(ArchiveEntry) == 0 && header.pathsOffset <= size,
+			Exception::GetExceptionCodeFromMeaning("IO"), "Asset archive \"" + archivePath + "\" is truncated!")
+		archive->entries = reinterpret_cast<const ArchiveEntry*>(data + header.indexOffset);
+		archive->entryCount = header.entryCount;
+		archive->paths = reinterpret_cast<const char*>(data + header.pathsOffset);
+
+		//Check every entry up front so lookups can trust them
+		for(uint32_t i = 0; i < archive->entryCount; i++) {
+			const ArchiveEntry& entry = archive->entries[i];
+			CheckException(i == 0 || archive->entries[i - 1].pathHash <= entry.pathHash, Exception::GetExceptionCodeFromMeaning("IO"), "Asset archive \"" + archivePath + "\" has an unsorted index!")
+			CheckException(entry.pathOffset <= size - header.pathsOffset && entry.pathLength <= size - header.pathsOffset - entry.pathOffset && entry.dataOffset <= size && entry.storedSize <= size - entry.dataOffset,
+				Exception::GetExceptionCodeFromMeaning("IO"), "Asset archive \"" + archivePath + "\" has a file outside of the archive!")
+			CheckException(entry.compression == Zlib || (entry.compression == Stored && entry.size == entry.storedSize), Exception::GetExceptionCodeFromMeaning("IO"), "Asset archive \"" + archivePath + "\" has a file with an unsupported compression method!")
+		}
+
+		std::unique_lock lk(mtx);
+		archives.push_back(archive);
+		Logging::EngineLog("Mounted asset archive \"" + archivePath + "\" (" + std::to_string(archive->entryCount) + " files)");
+	}
+
+	void VFS::UnmountAll() {
+		std::unique_lock lk(mtx);
+		archives.clear();
+	}
+
+	bool VFS::IsArchived(const std::string& path) {
+		std::string normalized = NormalizePath(path);
+		if(normalized.empty()) return false;
+
+		std::shared_lock lk(mtx);
+		for(const std::shared_ptr<Archive>& archive : archives) {
+			if(archive->Find(normalized)) return true;
+		}
+		return false;
+	}
+
+	bool VFS::Exists(const std::string& path) {
+		return IsArchived(path) || std::filesystem::exists(path);
+	}
+
+	std::shared_ptr<MappedFile> VFS::Open(const std::string& path) {
+		std::string normalized = NormalizePath(path);
+		if(!normalized.empty()) {
+			//Later archives override earlier ones
+			std::shared_lock lk(mtx);
+			for(auto it = archives.rbegin(); it != archives.rend(); it++) {
+				const Archive& archive = **it;
+				const ArchiveEntry* entry = archive.Find(normalized);
+				if(!entry) continue;
+
+				if(entry->compression == Stored) return std::make_shared<MappedFile>(archive.file, entry->dataOffset, entry->size);
+
+				//Inflate compressed files
+				CheckException(entry->size <= ULONG_MAX && entry->storedSize <= ULONG_MAX, Exception::GetExceptionCodeFromMeaning("IO"), "File \"" + path + "\" in asset archive \"" + archive.path + "\" is too large to inflate!")
+				std::vector<unsigned char> contents(entry->size);
+				uLongf inflatedSize = entry->size;
+				int result = uncompress(contents.data(), &inflatedSize, archive.file->GetData() + entry->dataOffset, entry->storedSize);
+				CheckException(result == Z_OK && inflatedSize == entry->size, Exception::GetExceptionCodeFromMeaning("IO"), "Failed to inflate file \"" + path + "\" in asset archive \"" + archive.path + "\"!")
+				return std::make_shared<MappedFile>(std::move(contents));
+			}
+		}
+
+		//Not archived, so it's a loose file
+		return std::make_shared<MappedFile>(path);
+	}
+
+	std::string VFS::ReadText(const std::string& path) {
+		std::shared_ptr<MappedFile> file = Open(path);
+		return std::string(reinterpret_cast<const char*>(file->GetData()), file->GetSize());
+	}
+}
@@ -0,0 +1,127 @@
+#include "World/ComponentStore.hpp"
+
+#include <map>
+#include <algorithm>
+
+namespace Cacao {
+	uint32_t GetComponentKindID(const std::string& kind) {
+		static std::map<std::string, uint32_t> kindIDs;
+		static std::mutex kindMtx;
+
+		std::lock_guard lk(kindMtx);
+		auto it = kindIDs.find(kind);
+		if(it != kindIDs.end()) return it->second;
+
+		//Hand out the next ID
+		uint32_t id = (uint32_t)kindIDs.size();
+		kindIDs.insert_or_assign(kind, id);
+		return id;
+	}
+
+	//Required static variable initialization
+	std::atomic<uint64_t> ComponentStore::version = 0;
+
+	void ComponentStore::Register(Entity* owner, Component* comp) {
+		std::lock_guard lk(mtx);
+
+		//Make sure there's a pool for this kind
+		if(comp->kindID >= pools.size()) pools.resize(comp->kindID + 1);
+
+		//Append to the pool
+		Pool& pool = pools[comp->kindID];
+		comp->storeSlot = pool.components.size();
+		pool.components.push_back(comp);
+		pool.owners.push_back(owner);
+		BumpVersion();
+	}
+
+	void ComponentStore::Unregister(Component* comp) {
+		std::lock_guard lk(mtx);
+		Pool& pool = pools[comp->kindID];
+		BumpVersion();
+
+		//If a query is running, leave a hole so we don't shuffle things under it
+		if(iterationDepth > 0) {
+			pool.components[comp->storeSlot] = nullptr;
+			pool.owners[comp->storeSlot] = nullptr;
+			pool.hasHoles = true;
+			return;
+		}
+
+		//Otherwise swap the last component into this slot
+		std::size_t slot = comp->storeSlot;
+		pool.components[slot] = pool.components.back();
+		pool.owners[slot] = pool.owners.back();
+		pool.components[slot]->storeSlot = slot;
+		pool.components.pop_back();
+		pool.owners.pop_back();
+	}
+
+	void ComponentStore::QueueTransformUpdate(Entity* e) {
+		std::lock_guard lk(mtx);
+
+		//Check again now that we have the lock, another thread may have queued this entity
+		if(e->transformQueued) return;
+		transformQueue.push_back(e);
+		e->transformQueued = true;
+	}
+
+	void ComponentStore::DequeueTransformUpdate(Entity* e) {
+		std::lock_guard lk(mtx);
+		auto it = std::find(transformQueue.begin(), transformQueue.end(), e);
+		if(it != transformQueue.end()) transformQueue.erase(it);
+		e->transformQueued = false;
+	}
+
+	void ComponentStore::UpdateTransforms() {
+		std::lock_guard lk(mtx);
+
+		//Entities already updated as part of a parent's subtree are clean and get skipped
+		for(Entity* e : transformQueue) {
+			e->transformQueued = false;
+			e->UpdateWorldTransform();
+		}
+		transformQueue.clear();
+	}
+
+	void ComponentStore::Pin() {
+		std::lock_guard lk(mtx);
+		iterationDepth++;
+	}
+
+	void ComponentStore::Unpin() {
+		std::lock_guard lk(mtx);
+		if(--iterationDepth == 0) Settle();
+	}
+
+	bool ComponentStore::Retain(std::shared_ptr<Component> comp) {
+		std::lock_guard lk(mtx);
+		if(iterationDepth == 0) return false;
+		graveyard.push_back(comp);
+		return true;
+	}
+
+	void ComponentStore::Settle() {
+		for(Pool& pool : pools) {
+			if(!pool.hasHoles) continue;
+
+			//Compact the pool, keeping order
+			std::size_t next = 0;
+			for(std::size_t i = 0; i < pool.components.size(); i++) {
+				if(!pool.components[i]) continue;
+				pool.components[next] = pool.components[i];
+				pool.owners[next] = pool.owners[i];
+				pool.components[next]->storeSlot = next;
+				next++;
+			}
+			pool.components.resize(next);
+			pool.owners.resize(next);
+			pool.hasHoles = false;
+		}
+
+		//Components deleted during the query can go now
+		//Swapped out first in case their destructors touch the store
+		std::vector<std::shared_ptr<Component>> released;
+		released.swap(graveyard);
+	}
+}
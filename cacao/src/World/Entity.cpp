@@ -0,0 +1,206 @@
+#include "World/Entity.hpp"
+
+#include "World/Component.hpp"
+#include "World/ComponentStore.hpp"
+
+#include <algorithm>
+
+namespace Cacao {
+	//Lock the store(s) involved in a structural change
+	//Store locks are always taken before the components mutex
+	static void LockStores(std::unique_lock<std::recursive_mutex>& a, std::unique_lock<std::recursive_mutex>& b) {
+		if(a.mutex() && b.mutex()) {
+			std::lock(a, b);
+		} else if(a.mutex()) {
+			a.lock();
+		} else if(b.mutex()) {
+			b.lock();
+		}
+	}
+
+	void Entity::SetActive(bool val) {
+		active = val;
+		UpdateHierarchyActive();
+	}
+
+	void Entity::UpdateHierarchyActive() {
+		std::shared_ptr<Entity> parentLk = parent.lock();
+		hierarchyActive = active && (!parentLk || parentLk == self || parentLk->hierarchyActive);
+		ComponentStore::BumpVersion();
+
+		for(std::shared_ptr<Entity>& child : children) {
+			child->UpdateHierarchyActive();
+		}
+	}
+
+	xg::Guid Entity::AddComponent(std::shared_ptr<Component> comp) {
+		//Resolve the kind once so the store never has to compare strings
+		comp->kindID = GetComponentKindID(comp->GetKind());
+
+		std::unique_lock<std::recursive_mutex> storeLk, unused;
+		if(store) storeLk = std::unique_lock<std::recursive_mutex>(store->mtx, std::defer_lock);
+		LockStores(storeLk, unused);
+		std::lock_guard lk(componentsMtx);
+
+		//Add this component to the list
+		auto mapValue = components.emplace(xg::newGuid(), comp);
+		componentList.push_back(comp.get());
+		if(store) store->Register(this, comp.get());
+
+		//Return the GUID
+		return mapValue.first->first;
+	}
+
+	void Entity::DeleteComponent(xg::Guid guid) {
+		std::unique_lock<std::recursive_mutex> storeLk, unused;
+		if(store) storeLk = std::unique_lock<std::recursive_mutex>(store->mtx, std::defer_lock);
+		LockStores(storeLk, unused);
+		std::lock_guard lk(componentsMtx);
+		CheckException(components.contains(guid), Exception::GetExceptionCodeFromMeaning("ContainerValue"), "No component with the provided GUID exists in this entity!");
+
+		std::shared_ptr<Component> comp = components[guid];
+		componentList.erase(std::find(componentList.begin(), componentList.end(), comp.get()));
+		if(store) {
+			store->Unregister(comp.get());
+
+			//Keep the component alive if a query might be using it right now
+			store->Retain(comp);
+		}
+
+		components.erase(guid);
+	}
+
+	Component* Entity::FindActiveComponentOfKind(uint32_t kindID) {
+		//Only called by the store with its lock held, which also guards the component list
+		for(Component* c : componentList) {
+			if(c->kindID == kindID && c->_GetActiveState()) return c;
+		}
+		return nullptr;
+	}
+
+	void Entity::AppendComponentKinds(std::vector<uint32_t>& kinds) {
+		//Only called with the store lock held, like FindActiveComponentOfKind
+		for(Component* c : componentList) {
+			kinds.push_back(c->kindID);
+		}
+	}
+
+	void Entity::SetStore(ComponentStore* newStore) {
+		if(newStore == store) return;
+
+		{
+			std::unique_lock<std::recursive_mutex> oldLk, newLk;
+			if(store) oldLk = std::unique_lock<std::recursive_mutex>(store->mtx, std::defer_lock);
+			if(newStore) newLk = std::unique_lock<std::recursive_mutex>(newStore->mtx, std::defer_lock);
+			LockStores(oldLk, newLk);
+			std::lock_guard lk(componentsMtx);
+
+			//Our place in the old store's transform queue goes with us
+			if(transformQueued) store->DequeueTransformUpdate(this);
+
+			//Move component registrations
+			for(Component* c : componentList) {
+				if(store) store->Unregister(c);
+				if(newStore) newStore->Register(this, c);
+			}
+			store = newStore;
+		}
+
+		//Children follow their parent
+		for(std::shared_ptr<Entity>& child : children) {
+			child->SetStore(newStore);
+		}
+	}
+
+	void Entity::SetParent(std::shared_ptr<Entity> newParent) {
+		//If we aren't orphaned, remove ourselves from the current parent
+		if(parent.lock() != self) {
+			std::shared_ptr<Entity> parentLk = parent.lock();
+			auto it = std::find(parentLk->children.begin(), parentLk->children.end(), self);
+			if(it != parentLk->children.end()) parentLk->children.erase(it);
+		}
+
+		//Add ourselves as a child to the new parent
+		newParent->children.push_back(self);
+
+		//Set parent pointer
+		parent = newParent;
+
+		//Join the new parent's world (or leave ours if it isn't in one)
+		SetStore(newParent->store);
+		InvalidateWorldTransform();
+		UpdateHierarchyActive();
+	}
+
+	glm::mat4 Entity::GetWorldTransformMatrix() {
+		if(!worldTransformDirty) return worldTransform;
+
+		//Outdated transforms are worked out without filling the cache, since parallel scripts may be asking for the same ones
+		//The cache is filled by the world's transform update on the tick thread
+		return CalculateWorldTransform();
+	}
+
+	glm::mat4 Entity::CalculateWorldTransform() {
+		//Top-level entities (world roots and orphans) don't apply their transform to their children
+		std::shared_ptr<Entity> parentLk = parent.lock();
+		if(!parentLk || parentLk == self || parentLk->parent.lock() == parentLk) return transform.GetTransformationMatrix();
+		return parentLk->GetWorldTransformMatrix() * transform.GetTransformationMatrix();
+	}
+
+	void Entity::InvalidateWorldTransform() {
+		//If we're already dirty, so are our children
+		if(!worldTransformDirty.exchange(true)) InvalidateChildTransforms();
+
+		//Make sure the next transform update reaches us
+		if(store && !transformQueued) store->QueueTransformUpdate(this);
+	}
+
+	void Entity::InvalidateChildTransforms() {
+		for(std::shared_ptr<Entity>& child : children) {
+			if(child->worldTransformDirty.exchange(true)) continue;
+			child->InvalidateChildTransforms();
+		}
+	}
+
+	void Entity::UpdateWorldTransform() {
+		if(!worldTransformDirty) return;
+		worldTransform = CalculateWorldTransform();
+		worldTransformDirty = false;
+
+		//Children of a dirty entity are always dirty
+		for(std::shared_ptr<Entity>& child : children) {
+			child->UpdateWorldTransform();
+		}
+	}
+
+	Entity::~Entity() {
+		//Remove ourselves from our parent so it doesn't keep a dangling reference
+		std::shared_ptr<Entity> parentLk = parent.lock();
+		if(parentLk && parentLk != self) {
+			auto it = std::find(parentLk->children.begin(), parentLk->children.end(), self);
+			if(it != parentLk->children.end()) parentLk->children.erase(it);
+		}
+
+		//Leave the world, keeping components alive if a query is using them
+		if(store) {
+			std::lock_guard storeLk(store->mtx);
+			for(auto& comp : components) {
+				store->Retain(comp.second);
+			}
+			SetStore(nullptr);
+		}
+
+		//Release ownership of all components
+		{
+			std::lock_guard lk(componentsMtx);
+			for(auto comp : components) {
+				comp.second.reset();
+			}
+		}
+
+		//Release ownership of all children
+		for(auto child : children) {
+			child.reset();
+		}
+	}
+}
@@ -224,7 +224,10 @@ class SussyScript final : public Cacao::Script {
 class PingPong : public Cacao::Script {
   public:
 	PingPong(glm::vec3 point1, glm::vec3 point2)
-	  : p1(point1), p2(point2), direction(point2 - point1), current(point1), currentDistance(0.0f), totalDistance(glm::length(direction)) {}
+	  : p1(point1), p2(point2), direction(point2 - point1), current(point1), currentDistance(0.0f), totalDistance(glm::length(direction)) {
+		//Only touches its own entity, so it can run alongside other scripts
+		SetParallel(true);
+	}
 
 	void OnActivate() override {
 		forward = true;
@@ -267,6 +270,10 @@ class PingPong : public Cacao::Script {
 
 class Spinner : public Cacao::Script {
   public:
+	Spinner() {
+		SetParallel(true);
+	}
+
 	void OnTick(double timestep) {
 		glm::vec3 rot = GetOwner().lock()->GetLocalTransform().GetRotation();
 		rot.y += 50.0f * timestep;
@@ -319,14 +326,9 @@ void PlaygroundApp::Launch() {
 	img = imgFuture.get();
 
 	//Create materials
-	icoMat = std::make_shared<Cacao::Material>();
-	icoMat->shader = icoShader;
-	prisMat = std::make_shared<Cacao::Material>();
-	prisMat->shader = prisShader;
-	Cacao::ShaderUploadItem prismData_Tex;
-	prismData_Tex.target = "texSample";
-	prismData_Tex.data = prisTex.GetManagedAsset().get();
-	prisMat->data.push_back(prismData_Tex);
+	icoMat = std::make_shared<Cacao::Material>(icoShader);
+	prisMat = std::make_shared<Cacao::Material>(prisShader);
+	prisMat->SetTexture("texSample", prisTex);
 
 	//Create camera manager
 	cameraManager = std::make_shared<Cacao::Entity>("Camera Manager");
@@ -1,21 +1,18 @@
 #version 450 core
 
 layout(location = 0) in vec3 position;
+layout(location = 5) in mat4 instanceTransform;
 
 layout(std140,binding=0) uniform CacaoGlobals {
     mat4 projection;
     mat4 view;
 } globals;
 
-layout(std140,binding=1) uniform CacaoLocals {
-    mat4 transform;
-} locals;
-
 layout(location = 0) out Vertex2Fragment {
 	vec4 pos;
 } V2F;
 
 void main() {
-	gl_Position = globals.projection * globals.view * locals.transform * vec4(position, 1.0);
+	gl_Position = globals.projection * globals.view * instanceTransform * vec4(position, 1.0);
 	V2F.pos = gl_Position;
 }
\ No newline at end of file
@@ -29,5 +29,14 @@ shutil.copy2(buildroot / 'playground' / ('launch' + so_suffix), bundleroot)
 for file in (buildroot / 'playground' / ('launch' + so_suffix + '.p')).rglob('*.spv'):
 	shutil.copy2(file, bundleroot / 'assets' / 'shaders')
 
+# Pack the assets into an archive if asked to
+if '--pack' in sys.argv:
+	sys.path.insert(0, str(pathlib.Path(__file__).resolve().parent))
+	import pack as packer
+	packer.pack(bundleroot / 'assets.cpak', bundleroot, [bundleroot / 'assets'])
+	shutil.rmtree(bundleroot / 'assets')
+	with open(bundleroot / 'launchconfig.cacao.yml', 'a') as launchconfig:
+		launchconfig.write('\n# Asset archives to mount (relative to the working directory)\narchives:\n  - assets.cpak\n')
+
 def get_engine_path():
 	return (bundleroot / ('cacaoengine' + exe_suffix))
\ No newline at end of file
@@ -0,0 +1,116 @@
+#!/usr/bin/env python
+
+# Packs asset files into an asset archive that the engine can mount (see the page "Bundles" in the manual)
+# Usage: pack.py <output archive> <root> <file or directory>...
+# Files are stored under their paths relative to <root>, which should be the working directory the engine loads assets from
+
+import pathlib
+import struct
+import sys
+import zlib
+
+# Must match src/Utilities/VFS.cpp
+MAGIC = b'CPAK'
+VERSION = 1
+ALIGNMENT = 16
+HEADER = struct.Struct('<4sIIIQQ')
+ENTRY = struct.Struct('<QIIQQQII')
+STORED = 0
+ZLIB = 1
+
+# Files that are already compressed or are meant to be mapped as-is are never compressed
+UNCOMPRESSED_SUFFIXES = {'.ctex', '.cmesh', '.png', '.jpg', '.jpeg', '.ogg', '.mp3', '.opus'}
+
+# Compressed files must be at least this much smaller to be worth inflating at load time
+MIN_SAVINGS = 0.1
+
+# Suffixes of cooked files, which are named after their source files
+COOKED_SUFFIXES = ('.ctex', '.cmesh')
+
+def hash_path(path):
+	h = 0xcbf29ce484222325
+	for byte in path.encode('utf-8'):
+		h ^= byte
+		h = (h * 0x100000001b3) & 0xffffffffffffffff
+	return h
+
+def is_stale_cook(file):
+	if file.suffix not in COOKED_SUFFIXES:
+		return False
+	source = file.with_suffix('')
+	return source.exists() and source.stat().st_mtime >= file.stat().st_mtime
+
+def collect(root, targets):
+	files = {}
+	for target in targets:
+		target = pathlib.Path(target)
+		for file in ([target] if target.is_file() else sorted(target.rglob('*'))):
+			if not file.is_file():
+				continue
+
+			# Stale cooks would be loaded over their source files, so leave them out
+			if is_stale_cook(file):
+				print(f'Warning: Skipping "{file}" since it is older than its source file (cook it again to include it)', file=sys.stderr)
+				continue
+			files[file.resolve().relative_to(root).as_posix()] = file
+	return files
+
+def align(offset):
+	return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1)
+
+def pack(output, root, targets):
+	root = pathlib.Path(root).resolve()
+	files = collect(root, targets)
+
+	# Sort by hash so the engine can binary search the index
+	names = sorted(files.keys(), key=lambda name: (hash_path(name), name))
+
+	# Lay out the paths
+	paths = bytearray()
+	path_spans = []
+	for name in names:
+		encoded = name.encode('utf-8')
+		path_spans.append((len(paths), len(encoded)))
+		paths += encoded
+
+	index_offset = HEADER.size
+	paths_offset = index_offset + len(names) * ENTRY.size
+	offset = paths_offset + len(paths)
+
+	# Compress what's worth compressing and lay out the data
+	entries = []
+	blobs = []
+	for name, (path_offset, path_length) in zip(names, path_spans):
+		data = files[name].read_bytes()
+		stored = data
+		compression = STORED
+		if files[name].suffix.lower() not in UNCOMPRESSED_SUFFIXES and len(data) > 0:
+			compressed = zlib.compress(data, 9)
+			if len(compressed) <= len(data) * (1 - MIN_SAVINGS):
+				stored = compressed
+				compression = ZLIB
+		offset = align(offset)
+		entries.append(ENTRY.pack(hash_path(name), path_offset, path_length, offset, len(stored), len(data), compression, 0))
+		blobs.append((offset, stored))
+		offset += len(stored)
+
+	# Write to a temporary file so the engine never mounts a half-written one
+	output = pathlib.Path(output)
+	temp = output.with_name(output.name + '.tmp')
+	with open(temp, 'wb') as out:
+		out.write(HEADER.pack(MAGIC, VERSION, len(names), ALIGNMENT, index_offset, paths_offset))
+		for entry in entries:
+			out.write(entry)
+		out.write(paths)
+		for blob_offset, blob in blobs:
+			out.write(b'\0' * (blob_offset - out.tell()))
+			out.write(blob)
+	temp.replace(output)
+	return len(names)
+
+if __name__ == '__main__':
+	if len(sys.argv) < 4:
+		print('Usage: pack.py <output archive> <root> <file or directory>...', file=sys.stderr)
+		sys.exit(1)
+	count = pack(sys.argv[1], sys.argv[2], sys.argv[3:])
+	print(f'Packed {count} files into "{sys.argv[1]}"')